@@ -63,6 +63,8 @@
 #include <86box/device.h>
 #include <86box/pit.h>
 #include <86box/random.h>
+#include <86box/prof.h>
+#include <86box/replay.h>
 #include <86box/nvr.h>
 #include <86box/machine.h>
 #include <86box/bugger.h>
@@ -129,6 +131,8 @@ int tracing_on = 0;
 /* Commandline options. */
 int dump_on_exit        = 0; /* (O) dump regs on exit */
 int start_in_fullscreen = 0; /* (O) start in fullscreen */
+int headless            = 0; /* (O) no window and no audio output */
+int turbo_mode          = 0; /* (O) run as fast as the host allows */
 #ifdef _WIN32
 int force_debug = 0; /* (O) force debug output */
 #endif
@@ -194,7 +198,22 @@ int      da2_standalone_enabled                 = 0;              /* (C) video o
 uint32_t mem_size                               = 0;              /* (C) memory size (Installed on
                                                                          system board)*/
 uint32_t isa_mem_size                           = 0;              /* (C) memory size (ISA Memory Cards) */
+int      mem_hugepages                          = 0;              /* (C) back the RAM with transparent (1)
+                                                                     or explicit (2) huge pages */
+int      mem_numa                               = 0;              /* (C) place the RAM on the NUMA node
+                                                                     of the emulation thread */
 int      cpu_use_dynarec                        = 0;              /* (C) cpu uses/needs Dyna */
+int      cpu_dynarec_trace                      = 0;              /* (C) dynarec compiles hot blocks as
+                                                                     traces */
+int      cpu_dynarec_cache                      = 0;              /* (C) dynarec keeps block hints in
+                                                                     the VM directory */
+int      cpu_dynarec_compile_threshold          = 0;              /* (C) dynarec interprets a marked
+                                                                     block this many more times before
+                                                                     compiling it */
+int      cpu_dynarec_compile_thread             = 0;              /* (C) dynarec generates host code on
+                                                                     a worker thread */
+int      cpu_idle_skip                          = 1;              /* (C) skip to the next timer on HLT
+                                                                     (1), and in polling loops (2) */
 int      cpu                                    = 0;              /* (C) cpu type */
 int      fpu_type                               = 0;              /* (C) fpu type */
 int      fpu_softfloat                          = 0;              /* (C) fpu uses softfloat */
@@ -202,6 +221,8 @@ int      time_sync                              = 0;              /* (C) enable
 int      confirm_reset                          = 1;              /* (C) enable reset confirmation */
 int      confirm_exit                           = 1;              /* (C) enable exit confirmation */
 int      confirm_save                           = 1;              /* (C) enable save confirmation */
+int      density_mode                           = 0;              /* (C) share ROMs and media with other
+                                                                     instances, let the host merge RAM */
 int      enable_discord                         = 0;              /* (C) enable Discord integration */
 int      pit_mode                               = -1;             /* (C) force setting PIT mode */
 int      fm_driver                              = 0;              /* (C) select FM sound driver */
@@ -261,6 +282,7 @@ extern int writelnum;
 /* emulator % */
 int fps;
 int framecount;
+int cpu_idle_percent; /* share of the last second the guest CPU was halted or polling */
 
 extern int CPUID;
 extern int output;
@@ -409,6 +431,8 @@ fatal(const char *fmt, ...)
 
     config_save();
 
+    replay_stop();
+
 #ifdef ENABLE_808X_LOG
     dumpregs(1);
 #endif
@@ -615,13 +639,17 @@ pc_show_usage(char *s)
             "-L or --logfile pat\t\t- set 'path' to be the logfile\n"
             "-M or --missing\t\t- dump missing machines and video cards\n"
             "-N or --noconfirm\t\t- do not ask for confirmation on quit\n"
+            "-O or --headless\t\t- run without a window or audio output\n"
             "-P or --vmpath path\t\t- set 'path' to be root for vm\n"
+            "-Q or --record log\t\t- record the inputs of this run to 'log'\n"
+            "-K or --replay log\t\t- replay the inputs recorded in 'log'\n"
             "-R or --rompath path\t\t- set 'path' to be ROM path\n"
 #ifndef USE_SDL_UI
             "-S or --settings\t\t\t- show only the settings dialog\n"
 #endif
             "-T or --testmode\t\t- test mode: execute the test mode entry\n"
             "\t\t\t\t   point on init/hard reset\n"
+            "-U or --turbo\t\t\t- run the emulation as fast as the host allows\n"
             "-V or --vmname name\t\t- overrides the name of the running VM\n"
             "-W or --nohook\t\t- disables keyboard hook\n"
             "\t\t\t\t   (compatibility-only outside Windows)\n"
@@ -666,6 +694,8 @@ pc_init(int argc, char *argv[])
     int              c;
     int              lvmp = 0;
     int              deprecated = 1;
+    char            *record_fn = NULL;
+    char            *replay_fn = NULL;
 #ifdef ENABLE_NG
     int ng = 0;
 #endif
@@ -740,6 +770,20 @@ usage:
 #endif
         } else if (!strcasecmp(argv[c], "--fullscreen") || !strcasecmp(argv[c], "-F")) {
             start_in_fullscreen = 1;
+        } else if (!strcasecmp(argv[c], "--headless") || !strcasecmp(argv[c], "-O")) {
+            headless = 1;
+        } else if (!strcasecmp(argv[c], "--turbo") || !strcasecmp(argv[c], "-U")) {
+            turbo_mode = 1;
+        } else if (!strcasecmp(argv[c], "--record") || !strcasecmp(argv[c], "-Q")) {
+            if ((c + 1) == argc)
+                goto usage;
+
+            record_fn = argv[++c];
+        } else if (!strcasecmp(argv[c], "--replay") || !strcasecmp(argv[c], "-K")) {
+            if ((c + 1) == argc)
+                goto usage;
+
+            replay_fn = argv[++c];
         } else if (!strcasecmp(argv[c], "--logfile") || !strcasecmp(argv[c], "-L")) {
             if ((c + 1) == argc)
                 goto usage;
@@ -1066,6 +1110,12 @@ usage:
 
     gdbstub_init();
 
+    /* Replay logs given on the command line start at the first hard reset. */
+    if (record_fn && replay_record(record_fn, NULL))
+        return 0;
+    if (replay_fn && replay_play(replay_fn))
+        return 0;
+
     /* All good! */
     return 1;
 }
@@ -1200,6 +1250,9 @@ pc_init_modules(void)
     }
 #    endif
     codegen_init();
+#    ifdef USE_NEW_DYNAREC
+    codegen_cache_load();
+#    endif
 #    if defined(__APPLE__) && defined(__aarch64__)
     if (__builtin_available(macOS 11.0, *)) {
         pthread_jit_write_protect_np(1);
@@ -1333,6 +1386,8 @@ pc_reset_hard_close(void)
 
     scsi_disk_close();
 
+    sound_out_thread_end();
+
     closeal();
 
     video_reset_close();
@@ -1348,6 +1403,19 @@ pc_reset_hard_close(void)
  * somewhat important here. Functions here should be named _reset
  * really, as that is what they do.
  */
+/* Log the host memory used by this instance, to compare the footprint of
+   instances with and without density mode. */
+void
+pc_mem_usage_log(void)
+{
+    uint64_t resident;
+    uint64_t shared;
+
+    if (plat_mem_usage(&resident, &shared) == 0)
+        pclog("Host memory: %" PRIu64 " KB resident, %" PRIu64 " KB of it shared%s\n",
+              resident >> 10, shared >> 10, density_mode ? " (density mode)" : "");
+}
+
 void
 pc_reset_hard_init(void)
 {
@@ -1371,6 +1439,9 @@ pc_reset_hard_init(void)
     /* Turn on and (re)initialize timer processing. */
     timer_init();
 
+    /* The TSC is now reset, which is where a replay log synchronizes. */
+    replay_reset();
+
     device_init();
 
     sound_reset();
@@ -1496,6 +1567,8 @@ pc_reset_hard_init(void)
 
     update_mouse_msg();
 
+    pc_mem_usage_log();
+
     if (test_mode)
         pc_test_mode_entry_point();
 
@@ -1522,19 +1595,19 @@ update_mouse_msg(void)
         *(wcp - 1) = L'\0';
     mbstowcs(wcpu, cpu_s->name, strlen(cpu_s->name) + 1);
 #ifdef _WIN32
-    swprintf(mouse_msg[0], sizeof_w(mouse_msg[0]), L"%%i%%%% - %ls",
+    swprintf(mouse_msg[0], sizeof_w(mouse_msg[0]), L"%%i%%%% (%%i%%%% idle) - %ls",
              plat_get_string(STRING_MOUSE_CAPTURE));
-    swprintf(mouse_msg[1], sizeof_w(mouse_msg[1]), L"%%i%%%% - %ls",
+    swprintf(mouse_msg[1], sizeof_w(mouse_msg[1]), L"%%i%%%% (%%i%%%% idle) - %ls",
              (mouse_get_buttons() > 2) ? plat_get_string(STRING_MOUSE_RELEASE) : plat_get_string(STRING_MOUSE_RELEASE_MMB));
-    wcsncpy(mouse_msg[2], L"%i%%", sizeof_w(mouse_msg[2]));
+    wcsncpy(mouse_msg[2], L"%i%% (%i%% idle)", sizeof_w(mouse_msg[2]));
 #else
-    swprintf(mouse_msg[0], sizeof_w(mouse_msg[0]), L"%ls v%ls - %%i%%%% - %ls - %ls/%ls - %ls",
+    swprintf(mouse_msg[0], sizeof_w(mouse_msg[0]), L"%ls v%ls - %%i%%%% (%%i%%%% idle) - %ls - %ls/%ls - %ls",
              EMU_NAME_W, EMU_VERSION_FULL_W, wmachine, wcpufamily, wcpu,
              plat_get_string(STRING_MOUSE_CAPTURE));
-    swprintf(mouse_msg[1], sizeof_w(mouse_msg[1]), L"%ls v%ls - %%i%%%% - %ls - %ls/%ls - %ls",
+    swprintf(mouse_msg[1], sizeof_w(mouse_msg[1]), L"%ls v%ls - %%i%%%% (%%i%%%% idle) - %ls - %ls/%ls - %ls",
              EMU_NAME_W, EMU_VERSION_FULL_W, wmachine, wcpufamily, wcpu,
              (mouse_get_buttons() > 2) ? plat_get_string(STRING_MOUSE_RELEASE) : plat_get_string(STRING_MOUSE_RELEASE_MMB));
-    swprintf(mouse_msg[2], sizeof_w(mouse_msg[2]), L"%ls v%ls - %%i%%%% - %ls - %ls/%ls",
+    swprintf(mouse_msg[2], sizeof_w(mouse_msg[2]), L"%ls v%ls - %%i%%%% (%%i%%%% idle) - %ls - %ls/%ls",
              EMU_NAME_W, EMU_VERSION_FULL_W, wmachine, wcpufamily, wcpu);
 #endif
 }
@@ -1561,8 +1634,15 @@ pc_close(UNUSED(thread_t *ptr))
 
     config_save();
 
+    replay_stop();
+
     plat_mouse_capture(0);
 
+#ifdef USE_NEW_DYNAREC
+    /* Needs guest RAM to hash the cached blocks. */
+    codegen_cache_save();
+#endif
+
     /* Close all the memory mappings. */
     mem_close();
 
@@ -1579,6 +1659,10 @@ pc_close(UNUSED(thread_t *ptr))
         dumpregs(0);
 #endif
 
+#if defined(USE_NEW_DYNAREC) && defined(USE_DYNAREC_STATS)
+    codegen_stats_dump();
+#endif
+
     video_close();
 
     device_close_all();
@@ -1593,6 +1677,8 @@ pc_close(UNUSED(thread_t *ptr))
 
     sound_cd_thread_end();
 
+    sound_out_thread_end();
+
     cdrom_close();
 
     zip_close();
@@ -1640,7 +1726,15 @@ pc_run(void)
 
     /* Run a block of code. */
     startblit();
+#ifdef USE_PROFILER
+    prof_frame_begin();
+#endif
+    if (replay_mode)
+        replay_frame();
+    mem_numa_update();
+    PROF_ENTER(&prof_cpu);
     cpu_exec((int32_t) cpu_s->rspeed / 100);
+    PROF_LEAVE();
     ack_pause();
 #ifdef USE_GDBSTUB /* avoid a KBC FIFO overflow when CPU emulation is stalled */
     if (gdbstub_step == GDBSTUB_EXEC) {
@@ -1651,6 +1745,9 @@ pc_run(void)
     }
 #endif
     joystick_process();
+#ifdef USE_PROFILER
+    prof_frame_end();
+#endif
     endblit();
 
     /* Done with this frame, update statistics. */
@@ -1662,7 +1759,7 @@ pc_run(void)
 
     if (title_update) {
         mouse_msg_idx = ((mouse_type == MOUSE_TYPE_NONE) || (mouse_input_mode >= 1)) ? 2 : !!mouse_capture;
-        swprintf(temp, sizeof_w(temp), mouse_msg[mouse_msg_idx], fps);
+        swprintf(temp, sizeof_w(temp), mouse_msg[mouse_msg_idx], fps, cpu_idle_percent);
 #ifdef __APPLE__
         /* Needed due to modifying the UI on the non-main thread is a big no-no. */
         dispatch_async_f(dispatch_get_main_queue(), wcsdup((const wchar_t *) temp), _ui_window_title);
@@ -1677,9 +1774,24 @@ pc_run(void)
 void
 pc_onesec(void)
 {
+    static uint64_t last_tsc;
+    static uint64_t last_idle_tsc;
+    uint64_t        now      = tsc;
+    uint64_t        now_idle = cpu_idle_tsc;
+
     fps        = framecount;
     framecount = 0;
 
+    /* The TSC goes back to 0 on a hard reset. */
+    if ((now > last_tsc) && (now_idle >= last_idle_tsc)) {
+        cpu_idle_percent = (int) (((now_idle - last_idle_tsc) * 100) / (now - last_tsc));
+        if (cpu_idle_percent > 100)
+            cpu_idle_percent = 100;
+    } else
+        cpu_idle_percent = 0;
+    last_tsc      = now;
+    last_idle_tsc = now_idle;
+
     title_update = 1;
 }
 
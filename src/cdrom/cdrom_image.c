@@ -230,13 +230,19 @@ bin_read(void *priv, uint8_t *buffer, const uint64_t seek, const size_t count)
     image_log(tf->log, "binary_read(%08lx, pos=%" PRIu64 " count=%lu)\n",
                     tf->fp, seek, count);
 
-    if (fseeko64(tf->fp, seek, SEEK_SET) == -1) {
+    if (tf->map != NULL) {
+        if ((seek > tf->map_size) || (count > (tf->map_size - seek))) {
+            image_log(tf->log, "binary_read failed during read!\n");
+
+            return -1;
+        }
+
+        memcpy(buffer, tf->map + seek, count);
+    } else if (fseeko64(tf->fp, seek, SEEK_SET) == -1) {
         image_log(tf->log, "binary_read failed during seek!\n");
 
         return -1;
-    }
-
-    if (fread(buffer, count, 1, tf->fp) != 1) {
+    } else if (fread(buffer, count, 1, tf->fp) != 1) {
         image_log(tf->log, "binary_read failed during read!\n");
 
         return -1;
@@ -277,6 +283,11 @@ bin_close(void *priv)
     if (tf == NULL)
         return;
 
+    if (tf->map != NULL) {
+        plat_munmap_file(tf->map, tf->map_size);
+        tf->map = NULL;
+    }
+
     if (tf->fp != NULL) {
         fclose(tf->fp);
         tf->fp = NULL;
@@ -315,6 +326,14 @@ bin_init(const uint8_t id, const char *filename, int *error)
         tf->get_length = bin_get_length;
         tf->close      = bin_close;
 
+        /* In density mode, share the image with the other instances using it,
+           on hosts with the address space to map it whole. */
+        if (density_mode && (sizeof(void *) >= 8) && (stats.st_size > 0)) {
+            tf->map = (uint8_t *) plat_mmap_file(tf->fp, 0, stats.st_size, 0);
+            if (tf->map != NULL)
+                tf->map_size = stats.st_size;
+        }
+
         char n[1024]        = { 0 };
 
         sprintf(n, "CD-ROM %i Bin  ", id + 1);
@@ -18,6 +18,7 @@
 #include "codegen_ir.h"
 #include "codegen_ops.h"
 #include "codegen_ops_helpers.h"
+#include "codegen_stats.h"
 
 #define MAX_INSTRUCTION_COUNT 50
 
@@ -31,6 +32,10 @@ static struct {
     int      TOP;
 } codegen_instructions[MAX_INSTRUCTION_COUNT];
 
+/*Linear address of the pending trace jump target, or BLOCK_PC_INVALID*/
+static uint32_t codegen_trace_dest = BLOCK_PC_INVALID;
+static int      codegen_trace_jumps;
+
 int
 codegen_get_instruction_uop(codeblock_t *block, uint32_t pc, int *first_instruction, int *TOP)
 {
@@ -46,6 +51,63 @@ codegen_get_instruction_uop(codeblock_t *block, uint32_t pc, int *first_instruct
     return -1;
 }
 
+void
+codegen_trace_jump(codeblock_t *block, uint32_t dest_addr)
+{
+    int first_instruction;
+    int TOP = -1;
+
+    codegen_trace_dest = BLOCK_PC_INVALID;
+
+    if ((block->flags & (CODEBLOCK_TRACE | CODEBLOCK_BYTE_MASK)) != CODEBLOCK_TRACE)
+        return;
+    if (codegen_trace_jumps >= CODEGEN_TRACE_MAX_JUMPS)
+        return;
+    /*Once the block has spilled into its second page, codegen_endpc is used to
+      locate that page, so the block must not jump back*/
+    if (block->page_mask2)
+        return;
+    if (((cs + dest_addr) ^ block->pc) & ~0xfff)
+        return;
+    /*Nor may the code at the target run into the next page*/
+    if (((cs + dest_addr + CODEGEN_TRACE_PAGE_MARGIN) ^ block->pc) & ~0xfff)
+        return;
+    /*Jumps back into the block are loops, leave those to the unroller*/
+    if ((dest_addr == cpu_state.oldpc) || (codegen_get_instruction_uop(block, dest_addr, &first_instruction, &TOP) != -1))
+        return;
+    if (block->ins >= (MAX_INSTRUCTION_COUNT - 2))
+        return;
+
+    codegen_trace_dest = cs + dest_addr;
+}
+
+int
+codegen_trace_continue(void)
+{
+    uint32_t dest = codegen_trace_dest;
+
+    codegen_trace_dest = BLOCK_PC_INVALID;
+
+    if ((dest == BLOCK_PC_INVALID) || (dest != (cs + cpu_state.pc)))
+        return 0;
+
+    codegen_trace_jumps++;
+    CODEGEN_STAT_INC(trace_jumps);
+    return 1;
+}
+
+/*Once a jump has been followed, the block must stay in its first page, as
+  page_mask2 would be set up from the wrong address otherwise. Return 1 if the
+  next instruction might leave that page.*/
+int
+codegen_trace_page_end(codeblock_t *block)
+{
+    if (!codegen_trace_jumps)
+        return 0;
+
+    return !!(((cs + cpu_state.pc + CODEGEN_TRACE_PAGE_MARGIN) ^ block->pc) & ~0xfff);
+}
+
 void
 codegen_set_loop_start(ir_data_t *ir, int first_instruction)
 {
@@ -92,6 +154,9 @@ codegen_generate_reset(void)
     last_op_ea_seg = NULL;
     last_op_32     = -1;
     has_ea         = 0;
+
+    codegen_trace_dest  = BLOCK_PC_INVALID;
+    codegen_trace_jumps = 0;
 }
 
 void
@@ -409,6 +474,8 @@ codegen_generate_call(uint8_t opcode, OpFn op, uint32_t fetchdat, uint32_t new_p
     op_ea_seg = &cpu_state.seg_ds;
     op_ssegs  = 0;
 
+    codegen_trace_dest = BLOCK_PC_INVALID;
+
     codegen_timing_start();
 
     while (!over) {
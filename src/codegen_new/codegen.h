@@ -30,6 +30,8 @@
   same page).
 */
 
+#define CODEBLOCK_CHAIN_EXITS 4
+
 typedef struct codeblock_t {
     uint32_t pc;
     uint32_t _cs;
@@ -38,6 +40,27 @@ typedef struct codeblock_t {
     uint16_t flags;
     uint8_t  ins;
     uint8_t  TOP;
+    /*Number of executions since compilation, used to pick blocks to be
+      recompiled as traces*/
+    uint16_t trace_hits;
+    /*Number of times this block was dispatched while still uncompiled, see
+      cpu_dynarec_compile_threshold*/
+    uint16_t compile_hits;
+
+    /*Chained exits, see codegen_block_chain_link(). chain_pc is the EIP the
+      exit leaves to, chain_site the host jump patched to enter the linked
+      block chain_nr directly. chain_status and chain_gen are cpu_cur_status
+      and codegen_chain_gen when the link was made, the exit only jumps to
+      the linked block while both still match. chain_next threads the exits
+      linked to the same block, starting at that block's chain_in.*/
+    void    *chain_site[CODEBLOCK_CHAIN_EXITS];
+    uint32_t chain_pc[CODEBLOCK_CHAIN_EXITS];
+    uint32_t chain_gen[CODEBLOCK_CHAIN_EXITS];
+    uint16_t chain_nr[CODEBLOCK_CHAIN_EXITS];
+    uint16_t chain_status[CODEBLOCK_CHAIN_EXITS];
+    uint16_t chain_next[CODEBLOCK_CHAIN_EXITS];
+    uint16_t chain_in;
+    uint8_t  chain_exits;
 
     /*Pointers for codeblock tree, used to search for blocks when hash lookup
       fails.*/
@@ -57,6 +80,17 @@ typedef struct codeblock_t {
     /*First mem_block_t used by this block. Any subsequent mem_block_ts
       will be in the list starting at head_mem_block->next.*/
     struct mem_block_t *head_mem_block;
+
+#ifdef USE_DYNAREC_STATS
+    /*Profiling data for the hot block report, see codegen_stats.h*/
+    uint64_t exec_count;
+    uint32_t eip;
+    uint16_t cs_sel;
+    uint16_t uop_count;
+    uint32_t host_size;
+    uint16_t reg_loads_elided;
+    uint16_t reg_stores_elided;
+#endif
 } codeblock_t;
 
 extern codeblock_t *codeblock;
@@ -81,6 +115,10 @@ extern uint8_t *block_write_data;
 #define CODEBLOCK_IN_DIRTY_LIST 0x40
 /*Code block is not inlining immediate parameters, parameters must be fetched from memory*/
 #define CODEBLOCK_NO_IMMEDIATES 0x80
+/*Code block is hot and is compiled as a trace, following direct jumps within its first page*/
+#define CODEBLOCK_TRACE 0x100
+/*Code block is being compiled by the compile worker and has no host code yet*/
+#define CODEBLOCK_COMPILING 0x200
 
 #define BLOCK_PC_INVALID        0xffffffff
 
@@ -313,6 +351,61 @@ extern int codegen_purge_purgable_list(void);
   will only be called when the allocator is out of memory*/
 extern void codegen_delete_random_block(int required_mem_block);
 
+/*Trace formation. Once a compiled block has been executed CODEGEN_TRACE_THRESHOLD
+  times it is discarded and recompiled with CODEBLOCK_TRACE set. While recompiling
+  a trace, a direct JMP whose target lies in the block's first page and has not
+  already been compiled into the block does not end the block; the target's code
+  is compiled inline instead. All trace members share the block's page mask, so
+  dirtying any of them invalidates the whole trace. For that to hold, a block
+  that has followed a jump must end before it can run into its second page.*/
+#define CODEGEN_TRACE_THRESHOLD 32
+#define CODEGEN_TRACE_MAX_JUMPS 4
+/*Longest instruction, plus the slack codegen_endpc keeps past the last one*/
+#define CODEGEN_TRACE_PAGE_MARGIN (15 + 8)
+
+extern void codegen_block_promote_trace(codeblock_t *block);
+extern void codegen_trace_jump(codeblock_t *block, uint32_t dest_addr);
+extern int  codegen_trace_continue(void);
+extern int  codegen_trace_page_end(codeblock_t *block);
+
+/*Block chaining. A conditional branch that leaves a block for a known EIP
+  exits through a stub that calls exec386_dynarec_chain() and, if that allows
+  it, jumps straight into the block linked to the exit instead of returning to
+  the dispatcher. Exits start out unlinked. The exit number of the last chained
+  exit taken is left in codegen_chain_exit, and when the dispatcher next runs a
+  compiled block at that exit's EIP it links the exit to it, so hot paths link
+  themselves on their second pass.
+
+  Links are dropped when either block is freed, invalidated or recompiled.
+  codegen_flush() bumps codegen_chain_gen on any MMU cache flush, which stops
+  every existing link from being followed until the dispatcher has validated
+  the target again under the new mappings.
+
+  An exit number is (block number << 2) | exit index, 0 is never a valid exit
+  as block 0 only holds the backend routines.*/
+extern uint32_t codegen_chain_exit;
+extern uint32_t codegen_chain_gen;
+extern uint32_t codegen_chain_tsc;
+
+extern int  codegen_block_chain_exit_add(codeblock_t *block, uint32_t pc);
+extern void codegen_block_chain_link(uint32_t exit_nr, codeblock_t *dest);
+extern void codegen_block_chain_clear(codeblock_t *block);
+extern int  exec386_dynarec_chain(uint32_t exit_nr);
+
+/*Compile worker, enabled by cpu_dynarec_compile_thread. The IR is still built
+  on the CPU thread while the block is interpreted, as that reads live CPU
+  state, but codegen_ir_compile() - register allocation and host code
+  generation - runs on the worker. The IR and register allocator are
+  singletons, so only one block is in flight at a time; it is flagged
+  CODEBLOCK_COMPILING and the dispatcher interprets it, and any other block
+  due to be compiled, until codegen_compile_poll() sees the worker finish and
+  installs the code by setting CODEBLOCK_WAS_RECOMPILED. Anything that frees
+  the block's code in the meantime waits for the worker and drops the result.
+  The worker is not used once replay_started is set, as its timing would make
+  a replay diverge from the recording.*/
+extern void codegen_compile_poll(void);
+extern int  codegen_compile_busy(void);
+
 extern int      cpu_block_end;
 extern uint32_t codegen_endpc;
 
@@ -15,9 +15,11 @@
 #include <86box/mem.h>
 #include <86box/plat.h>
 #include <86box/plat_unused.h>
+#include <86box/thread.h>
 
 #include "codegen.h"
 #include "codegen_allocator.h"
+#include "codegen_stats.h"
 
 typedef struct mem_block_t {
     uint32_t offset; /*Offset into mem_block_alloc*/
@@ -27,7 +29,11 @@ typedef struct mem_block_t {
 
 static mem_block_t mem_blocks[MEM_BLOCK_NR];
 static uint32_t    mem_block_free_list;
+static int         mem_block_free_count;
+static int         mem_block_reserved;
 static uint8_t    *mem_block_alloc = NULL;
+/*The free list is shared with the compile worker, see codegen_allocator_reserve()*/
+static mutex_t *mem_block_mutex;
 
 int codegen_allocator_usage = 0;
 
@@ -44,7 +50,25 @@ codegen_allocator_init(void)
         else
             mem_blocks[c].next = 0;
     }
-    mem_block_free_list = 1;
+    mem_block_free_list  = 1;
+    mem_block_free_count = MEM_BLOCK_NR;
+    mem_block_reserved   = 0;
+
+    if (!mem_block_mutex)
+        mem_block_mutex = thread_create_mutex();
+}
+
+static void
+evict_mem_block(int code_block)
+{
+    /*Pick a random memory block and free the owning code block*/
+    uint32_t     block_nr = rand() & MEM_BLOCK_MASK;
+    mem_block_t *block    = &mem_blocks[block_nr];
+
+    if (block->code_block && block->code_block != code_block) {
+        codegen_delete_block(&codeblock[block->code_block]);
+        CODEGEN_STAT_INC(evictions_mem_block);
+    }
 }
 
 mem_block_t *
@@ -53,19 +77,23 @@ codegen_allocator_allocate(mem_block_t *parent, int code_block)
     mem_block_t *block;
     uint32_t     block_nr;
 
-    while (!mem_block_free_list) {
-        /*Pick a random memory block and free the owning code block*/
-        block_nr = rand() & MEM_BLOCK_MASK;
-        block    = &mem_blocks[block_nr];
+    while (1) {
+        thread_wait_mutex(mem_block_mutex);
+        if (mem_block_free_list)
+            break;
+        thread_release_mutex(mem_block_mutex);
 
-        if (block->code_block && block->code_block != code_block)
-            codegen_delete_block(&codeblock[block->code_block]);
+        /*Evicting touches the block lists, which only the CPU thread may do*/
+        if (mem_block_reserved)
+            fatal("codegen_allocator_allocate: compile worker ran out of reserved memory\n");
+        evict_mem_block(code_block);
     }
 
     /*Remove from free list*/
     block_nr            = mem_block_free_list;
     block               = &mem_blocks[block_nr - 1];
     mem_block_free_list = block->next;
+    mem_block_free_count--;
 
     block->code_block = code_block;
     if (parent) {
@@ -76,6 +104,7 @@ codegen_allocator_allocate(mem_block_t *parent, int code_block)
         block->next = 0;
 
     codegen_allocator_usage++;
+    thread_release_mutex(mem_block_mutex);
     return block;
 }
 void
@@ -83,6 +112,7 @@ codegen_allocator_free(mem_block_t *block)
 {
     int block_nr = (((uintptr_t) block - (uintptr_t) mem_blocks) / sizeof(mem_block_t)) + 1;
 
+    thread_wait_mutex(mem_block_mutex);
     while (1) {
         int next_block_nr = block->next;
         codegen_allocator_usage--;
@@ -90,13 +120,43 @@ codegen_allocator_free(mem_block_t *block)
         block->next         = mem_block_free_list;
         block->code_block   = BLOCK_INVALID;
         mem_block_free_list = block_nr;
-        block_nr            = next_block_nr;
+        mem_block_free_count++;
+        block_nr = next_block_nr;
 
         if (block_nr)
             block = &mem_blocks[block_nr - 1];
         else
             break;
     }
+    thread_release_mutex(mem_block_mutex);
+}
+
+void
+codegen_allocator_reserve(int count, int code_block)
+{
+    while (mem_block_free_count < count)
+        evict_mem_block(code_block);
+
+    mem_block_reserved = 1;
+}
+
+void
+codegen_allocator_unreserve(void)
+{
+    mem_block_reserved = 0;
+}
+
+int
+codegen_allocator_get_count(mem_block_t *block)
+{
+    int count = 1;
+
+    while (block->next) {
+        block = &mem_blocks[block->next - 1];
+        count++;
+    }
+
+    return count;
 }
 
 uint8_t *
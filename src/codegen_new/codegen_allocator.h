@@ -29,10 +29,19 @@ void codegen_allocator_init(void);
 struct mem_block_t *codegen_allocator_allocate(struct mem_block_t *parent, int code_block);
 /*Free a mem_block_t, and any subsequent blocks in the list at block->next*/
 void codegen_allocator_free(struct mem_block_t *block);
+/*Get the number of mem_block_ts in the list starting at block*/
+int codegen_allocator_get_count(struct mem_block_t *block);
 /*Get a pointer to the backing memory associated with block*/
 uint8_t *codeblock_allocator_get_ptr(struct mem_block_t *block);
 /*Cache clean memory block list*/
 void codegen_allocator_clean_blocks(struct mem_block_t *block);
+/*Evict code blocks until at least count memory blocks are free, then stop
+  any further evictions until codegen_allocator_unreserve(). Used while the
+  compile worker owns a block, as evicting is only safe on the CPU thread;
+  the CPU thread does not allocate in the meantime, so the free count can
+  only grow. Must be called on the CPU thread*/
+void codegen_allocator_reserve(int count, int code_block);
+void codegen_allocator_unreserve(void);
 
 extern int codegen_allocator_usage;
 
@@ -13,9 +13,21 @@
 #    error Dynamic recompiler not implemented on your platform
 #endif
 
+/*Chained exits skip the checks the dispatcher does between blocks, so they are
+  left out of builds that hook into those*/
+#if defined(CODEGEN_BACKEND_HAS_CHAIN) && !defined(USE_GDBSTUB) && !defined(USE_ACYCS) && !defined(USE_DEBUG_REGS_486)
+#    define CODEGEN_CHAIN
+#endif
+
 void codegen_backend_init(void);
 void codegen_backend_prologue(codeblock_t *block);
 void codegen_backend_epilogue(codeblock_t *block);
+#ifdef CODEGEN_CHAIN
+/*Address a chained exit jumps to when entering block*/
+void *codegen_backend_chain_entry(codeblock_t *block);
+/*Point the jump at site to dest, or back at the dispatcher exit if dest is NULL*/
+void codegen_backend_chain_patch(void *site, void *dest);
+#endif
 
 struct ir_data_t;
 struct uop_t;
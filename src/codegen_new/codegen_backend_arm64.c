@@ -44,6 +44,10 @@ void *codegen_mem_store_double;
 void *codegen_fp_round;
 void *codegen_fp_round_quad;
 
+#    ifdef CODEGEN_CHAIN
+static int chain_entry_offset;
+#    endif
+
 void *codegen_gpf_rout;
 void *codegen_exit_rout;
 
@@ -354,6 +358,10 @@ codegen_backend_prologue(codeblock_t *block)
     host_arm64_STP_PREIDX_X(block, REG_X21, REG_X22, REG_XSP, -16);
     host_arm64_STP_PREIDX_X(block, REG_X19, REG_X20, REG_XSP, -64);
 
+#    ifdef CODEGEN_CHAIN
+    /*Chained exits arrive here with the stack frame of the block they left*/
+    chain_entry_offset = block_pos;
+#    endif
     host_arm64_MOVX_IMM(block, REG_CPUSTATE, (uint64_t) &cpu_state);
 
     if (block->flags & CODEBLOCK_HAS_FPU) {
@@ -377,4 +385,28 @@ codegen_backend_epilogue(codeblock_t *block)
     codegen_allocator_clean_blocks(block->head_mem_block);
 }
 
+#    ifdef CODEGEN_CHAIN
+void *
+codegen_backend_chain_entry(codeblock_t *block)
+{
+    return &block->data[chain_entry_offset];
+}
+
+void
+codegen_backend_chain_patch(void *site, void *dest)
+{
+    uint32_t *opcode = (uint32_t *) site;
+    /*An offset of 4 falls through to the jump to codegen_exit_rout*/
+    int offset = dest ? ((uintptr_t) dest - (uintptr_t) opcode) : 4;
+
+    /*All code memory is a single mapping well inside B's +/- 128 MB range*/
+    *opcode = (*opcode & ~0x03ffffff) | ((offset >> 2) & 0x03ffffff);
+#        ifndef _MSC_VER
+    __clear_cache((char *) opcode, (char *) (opcode + 1));
+#        else
+    FlushInstructionCache(GetCurrentProcess(), opcode, 4);
+#        endif
+}
+#    endif
+
 #endif
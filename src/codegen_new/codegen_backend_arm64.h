@@ -11,6 +11,12 @@
 
 #define BLOCK_MAX   0x3c0
 
+/*Chained exits patch a B in place, which needs the per-thread JIT write
+  protection toggled around it on Apple silicon. Not handled yet*/
+#ifndef __APPLE__
+#    define CODEGEN_BACKEND_HAS_CHAIN
+#endif
+
 void host_arm64_BLR(codeblock_t *block, int addr_reg);
 void host_arm64_CBNZ(codeblock_t *block, int reg, uintptr_t dest);
 void host_arm64_MOVK_IMM(codeblock_t *block, int reg, uint32_t imm_data);
@@ -49,6 +49,7 @@
 #    define OPCODE_BCOND              (0x54 << OPCODE_SHIFT)
 #    define OPCODE_CBNZ               (0xb5 << OPCODE_SHIFT)
 #    define OPCODE_CBZ                (0xb4 << OPCODE_SHIFT)
+#    define OPCODE_CBZ_W              (0x34 << OPCODE_SHIFT)
 #    define OPCODE_CMN_IMM            (0x31 << OPCODE_SHIFT)
 #    define OPCODE_CMNX_IMM           (0xb1 << OPCODE_SHIFT)
 #    define OPCODE_CMP_IMM            (0x71 << OPCODE_SHIFT)
@@ -572,6 +573,17 @@ host_arm64_BVS_(codeblock_t *block)
     codegen_addlong(block, OPCODE_B);
     return (uint32_t *) &block_write_data[block_pos - 4];
 }
+/*Branch taken if the 32-bit reg is non-zero. Unlike the other branches the B
+  is emitted pointing at the next instruction, so it falls through until its
+  offset is patched*/
+uint32_t *
+host_arm64_CBNZ_W_(codeblock_t *block, int reg)
+{
+    codegen_alloc(block, 12);
+    codegen_addlong(block, OPCODE_CBZ_W | OFFSET19(8) | Rt(reg));
+    codegen_addlong(block, OPCODE_B | OFFSET26(4));
+    return (uint32_t *) &block_write_data[block_pos - 4];
+}
 
 void
 host_arm64_branch_set_offset(uint32_t *opcode, void *dest)
@@ -813,6 +813,26 @@ codegen_JMP(codeblock_t *block, uop_t *uop)
     return 0;
 }
 
+static int
+codegen_JMP_CHAIN(codeblock_t *block, uop_t *uop)
+{
+#    ifdef CODEGEN_CHAIN
+    int exit_nr = codegen_block_chain_exit_add(block, uop->imm_data);
+
+    /*Ask exec386_dynarec_chain() whether the linked block can be entered
+      directly. The B is patched by codegen_backend_chain_patch(), and falls
+      through to the exit while unlinked.*/
+    if (exit_nr) {
+        host_arm64_mov_imm(block, REG_ARG0, exit_nr);
+        host_arm64_call(block, exec386_dynarec_chain);
+        block->chain_site[exit_nr & 3] = host_arm64_CBNZ_W_(block, REG_W0);
+    }
+#    endif
+    host_arm64_jump(block, (uintptr_t) codegen_exit_rout);
+
+    return 0;
+}
+
 static int
 codegen_LOAD_FUNC_ARG0(codeblock_t *block, uop_t *uop)
 {
@@ -2922,6 +2942,9 @@ const uOpFn uop_handlers[UOP_MAX] = {
     [UOP_JMP &
         UOP_MASK]
     = codegen_JMP,
+    [UOP_JMP_CHAIN &
+        UOP_MASK]
+    = codegen_JMP_CHAIN,
 
     [UOP_LOAD_SEG &
         UOP_MASK]
@@ -43,6 +43,9 @@ void *codegen_mem_store_double;
 void *codegen_gpf_rout;
 void *codegen_exit_rout;
 
+/*Offset of the chained exit entry point, the same in every block*/
+static int chain_entry_offset;
+
 host_reg_def_t codegen_host_reg_list[CODEGEN_HOST_REGS] = {
   /*Note: while EAX and EDX are normally volatile registers under x86
   calling conventions, the recompiler will explicitly save and restore
@@ -365,6 +368,8 @@ codegen_backend_prologue(codeblock_t *block)
 #else
     host_x86_SUB64_REG_IMM(block, REG_RSP, 0x48);
 #endif
+    /*Chained exits arrive here with the stack frame of the block they left*/
+    chain_entry_offset = block_pos;
     host_x86_MOV64_REG_IMM(block, REG_RBP, ((uintptr_t) &cpu_state) + 128);
     if (block->flags & CODEBLOCK_HAS_FPU) {
         host_x86_MOV32_REG_ABS(block, REG_EAX, &cpu_state.TOP);
@@ -395,4 +400,24 @@ codegen_backend_epilogue(codeblock_t *block)
     host_x86_POP(block, REG_RBX);
     host_x86_RET(block);
 }
+
+#    ifdef CODEGEN_CHAIN
+void *
+codegen_backend_chain_entry(codeblock_t *block)
+{
+    return &block->data[chain_entry_offset];
+}
+
+void
+codegen_backend_chain_patch(void *site, void *dest)
+{
+    uint32_t *branch_offset = (uint32_t *) site;
+
+    /*A zero offset falls through to the JMP to codegen_exit_rout*/
+    if (dest)
+        *branch_offset = (uintptr_t) dest - ((uintptr_t) branch_offset + 4);
+    else
+        *branch_offset = 0;
+}
+#    endif
 #endif
@@ -851,6 +851,34 @@ codegen_JMP(codeblock_t *block, uop_t *uop)
 
     return 0;
 }
+static int
+codegen_JMP_CHAIN(codeblock_t *block, uop_t *uop)
+{
+#    ifdef CODEGEN_CHAIN
+    int exit_nr = codegen_block_chain_exit_add(block, uop->imm_data);
+
+    /*Ask exec386_dynarec_chain() whether the linked block can be entered
+      directly. The JMP is patched by codegen_backend_chain_patch(), and
+      falls through to the exit while unlinked.*/
+    if (exit_nr) {
+        uint32_t *branch_offset;
+
+#        if _WIN64
+        host_x86_MOV32_REG_IMM(block, REG_ECX, exit_nr);
+#        else
+        host_x86_MOV32_REG_IMM(block, REG_EDI, exit_nr);
+#        endif
+        host_x86_CALL(block, exec386_dynarec_chain);
+        host_x86_TEST32_REG(block, REG_EAX, REG_EAX);
+        branch_offset = host_x86_JZ_long(block);
+        block->chain_site[exit_nr & 3] = host_x86_JMP_long(block);
+        *branch_offset = (uint32_t) ((uintptr_t) &block_write_data[block_pos] - (uintptr_t) branch_offset) - 4;
+    }
+#    endif
+    host_x86_JMP(block, codegen_exit_rout);
+
+    return 0;
+}
 
 static int
 codegen_LOAD_FUNC_ARG0(codeblock_t *block, uop_t *uop)
@@ -2874,6 +2902,9 @@ const uOpFn uop_handlers[UOP_MAX] = {
     [UOP_JMP &
         UOP_MASK]
     = codegen_JMP,
+    [UOP_JMP_CHAIN &
+        UOP_MASK]
+    = codegen_JMP_CHAIN,
 
     [UOP_LOAD_SEG &
         UOP_MASK]
@@ -850,6 +850,13 @@ codegen_JMP(codeblock_t *block, uop_t *uop)
     return 0;
 }
 static int
+codegen_JMP_CHAIN(codeblock_t *block, UNUSED(uop_t *uop))
+{
+    host_x86_JMP(block, codegen_exit_rout);
+
+    return 0;
+}
+static int
 codegen_JMP_DEST(codeblock_t *block, uop_t *uop)
 {
     uop->p = host_x86_JMP_long(block);
@@ -2880,6 +2887,9 @@ const uOpFn uop_handlers[UOP_MAX] = {
     [UOP_JMP &
         UOP_MASK]
     = codegen_JMP,
+    [UOP_JMP_CHAIN &
+        UOP_MASK]
+    = codegen_JMP_CHAIN,
     [UOP_JMP_DEST &
         UOP_MASK]
     = codegen_JMP_DEST,
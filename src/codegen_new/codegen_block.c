@@ -1,10 +1,16 @@
 #include <inttypes.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(__APPLE__) && defined(__aarch64__)
+#    include <pthread.h>
+#endif
 #include <86box/86box.h>
 #include "cpu.h"
 #include <86box/mem.h>
+#include <86box/replay.h>
+#include <86box/thread.h>
 #include <86box/plat_unused.h>
 
 #include "x86.h"
@@ -21,8 +27,10 @@
 #include "codegen_accumulate.h"
 #include "codegen_allocator.h"
 #include "codegen_backend.h"
+#include "codegen_cache.h"
 #include "codegen_ir.h"
 #include "codegen_reg.h"
+#include "codegen_stats.h"
 
 uint8_t *block_write_data = NULL;
 
@@ -57,9 +65,14 @@ static int      last_ssegs;
 uint32_t instr_counts[256 * 256];
 #endif
 
+uint32_t codegen_chain_exit;
+uint32_t codegen_chain_gen;
+uint32_t codegen_chain_tsc;
+
 static uint16_t block_free_list;
 static void     delete_block(codeblock_t *block);
 static void     delete_dirty_block(codeblock_t *block);
+static void     compile_wait(codeblock_t *block);
 
 /*Temporary list of code blocks that have recently been evicted. This allows for
   some historical state to be kept when a block is the target of self-modifying
@@ -85,6 +98,7 @@ block_free_list_add(codeblock_t *block)
         block->next = 0;
     block_free_list = get_block_nr(block);
     block->flags    = CODEBLOCK_IN_FREE_LIST;
+    codegen_block_chain_clear(block);
 }
 
 static void
@@ -126,6 +140,7 @@ block_dirty_list_add(codeblock_t *block)
         dirty_list_size--;
         evict_block->flags &= ~CODEBLOCK_IN_DIRTY_LIST;
         delete_dirty_block(evict_block);
+        CODEGEN_STAT_INC(evictions_dirty_list);
     }
 }
 
@@ -199,6 +214,7 @@ block_free_list_get(void)
             dirty_list_size--;
             block->flags &= ~CODEBLOCK_IN_DIRTY_LIST;
             delete_dirty_block(block);
+            CODEGEN_STAT_INC(evictions_dirty_list);
             block_free_list = get_block_nr(block);
             break;
         }
@@ -226,6 +242,9 @@ codegen_init(void)
         block_free_list_add(&codeblock[c]);
     block_dirty_list_head = block_dirty_list_tail = 0;
     dirty_list_size                               = 0;
+#ifdef USE_DYNAREC_STATS
+    codegen_stats_reset();
+#endif
 #ifdef DEBUG_EXTRA
     memset(instr_counts, 0, sizeof(instr_counts));
 #endif
@@ -236,6 +255,8 @@ codegen_reset(void)
 {
     int c;
 
+    compile_wait(NULL);
+
     for (c = 1; c < BLOCK_SIZE; c++) {
         codeblock_t *block = &codeblock[c];
 
@@ -249,6 +270,7 @@ codegen_reset(void)
     memset(codeblock, 0, BLOCK_SIZE * sizeof(codeblock_t));
     memset(codeblock_hash, 0, HASH_SIZE * sizeof(uint16_t));
     mem_reset_page_blocks();
+    codegen_chain_exit = 0;
 
     block_free_list = 0;
     for (c = 0; c < BLOCK_SIZE; c++) {
@@ -377,8 +399,16 @@ invalidate_block(codeblock_t *block)
     if (block->pc == BLOCK_PC_INVALID)
         fatal("Invalidating deleted block\n");
 #endif
+#ifdef USE_DYNAREC_STATS
+    if (block->flags & CODEBLOCK_BYTE_MASK)
+        CODEGEN_STAT_INC(invalidations_byte_mask);
+    else
+        CODEGEN_STAT_INC(invalidations_page_mask);
+#endif
+    compile_wait(block);
     remove_from_block_list(block, old_pc);
     block_dirty_list_add(block);
+    codegen_block_chain_clear(block);
     if (block->head_mem_block)
         codegen_allocator_free(block->head_mem_block);
     block->head_mem_block = NULL;
@@ -389,6 +419,7 @@ delete_block(codeblock_t *block)
 {
     uint32_t old_pc = block->pc;
 
+    compile_wait(block);
     if (block == &codeblock[codeblock_hash[HASH(block->phys)]])
         codeblock_hash[HASH(block->phys)] = BLOCK_INVALID;
 
@@ -403,6 +434,7 @@ delete_block(codeblock_t *block)
         block_dirty_list_remove(block);
     else
         remove_from_block_list(block, old_pc);
+    codegen_block_chain_clear(block);
     if (block->head_mem_block)
         codegen_allocator_free(block->head_mem_block);
     block->head_mem_block = NULL;
@@ -443,6 +475,7 @@ codegen_delete_random_block(int required_mem_block)
 
             if (block->pc != BLOCK_PC_INVALID && (!required_mem_block || block->head_mem_block)) {
                 delete_block(block);
+                CODEGEN_STAT_INC(evictions_random);
                 return;
             }
         }
@@ -450,6 +483,22 @@ codegen_delete_random_block(int required_mem_block)
     }
 }
 
+void
+codegen_block_promote_trace(codeblock_t *block)
+{
+    /*Drop the existing host code, the next dispatch of this block will
+      recompile it as a trace*/
+    codegen_block_chain_clear(block);
+    if (block->head_mem_block)
+        codegen_allocator_free(block->head_mem_block);
+    block->head_mem_block = NULL;
+
+    block->flags &= ~CODEBLOCK_WAS_RECOMPILED;
+    block->flags |= CODEBLOCK_TRACE;
+
+    CODEGEN_STAT_INC(traces);
+}
+
 void
 codegen_check_flush(page_t *page, UNUSED(uint64_t mask), UNUSED(uint32_t phys_addr))
 {
@@ -530,9 +579,15 @@ codegen_block_init(uint32_t phys_addr)
     block->page_mask = block->page_mask2 = 0;
     block->flags                         = CODEBLOCK_STATIC_TOP;
     block->status                        = cpu_cur_status;
+    block->trace_hits                    = 0;
+    block->compile_hits                  = 0;
+    codegen_block_chain_clear(block);
+    codegen_cache_apply(block);
 
     recomp_page = block->phys & ~0xfff;
     codeblock_tree_add(block);
+
+    CODEGEN_STAT_INC(marks);
 }
 
 static ir_data_t *ir_data;
@@ -566,6 +621,17 @@ codegen_block_start_recompile(codeblock_t *block)
 
     block->page_mask = block->page_mask2 = 0;
     block->ins                           = 0;
+    block->trace_hits                    = 0;
+    codegen_block_chain_clear(block);
+
+#ifdef USE_DYNAREC_STATS
+    block->exec_count        = 0;
+    block->eip               = cpu_state.pc;
+    block->cs_sel            = CS;
+    block->reg_loads_elided  = 0;
+    block->reg_stores_elided = 0;
+    CODEGEN_STAT_INC(compiles);
+#endif
 
     cpu_block_end = 0;
 
@@ -757,6 +823,104 @@ codegen_block_end(void)
     add_to_block_list(block);
 }
 
+/*Memory blocks kept free for the worker, so it never has to evict. Host code
+  size is bounded by the uOP count, and no uOP comes near 256 bytes*/
+#define COMPILE_RESERVE (((UOP_NR_MAX * 256) / MEM_BLOCK_SIZE) + 2)
+
+static thread_t    *compile_thread = NULL;
+static event_t     *compile_start_event;
+static event_t     *compile_done_event;
+static codeblock_t *compile_block = NULL; /*Block owned by the worker, NULL if idle*/
+static atomic_int   compile_done;
+
+static void
+compile_thread_func(UNUSED(void *param))
+{
+#if defined(__APPLE__) && defined(__aarch64__)
+    if (__builtin_available(macOS 11.0, *)) {
+        pthread_jit_write_protect_np(0);
+    }
+#endif
+    while (1) {
+        thread_wait_event(compile_start_event, -1);
+        thread_reset_event(compile_start_event);
+
+        codegen_ir_compile(ir_data, compile_block);
+
+        atomic_store(&compile_done, 1);
+        thread_set_event(compile_done_event);
+    }
+}
+
+static void
+compile_post(codeblock_t *block)
+{
+    if (!compile_thread) {
+        compile_start_event = thread_create_event();
+        compile_done_event  = thread_create_event();
+        compile_thread      = thread_create(compile_thread_func, NULL);
+    }
+
+    codegen_allocator_reserve(COMPILE_RESERVE, get_block_nr(block));
+
+    block->flags &= ~CODEBLOCK_WAS_RECOMPILED;
+    block->flags |= CODEBLOCK_COMPILING;
+    compile_block = block;
+
+    atomic_store(&compile_done, 0);
+    thread_reset_event(compile_done_event);
+    thread_set_event(compile_start_event);
+    CODEGEN_STAT_INC(compiles_offloaded);
+}
+
+static void
+compile_finish(int install)
+{
+    codeblock_t *block = compile_block;
+
+    compile_block = NULL;
+    codegen_allocator_unreserve();
+
+    block->flags &= ~CODEBLOCK_COMPILING;
+    if (install)
+        block->flags |= CODEBLOCK_WAS_RECOMPILED;
+}
+
+/*Wait for the worker if it owns block (or any block, if block is NULL). The
+  caller is about to free the block's code, so the result is dropped*/
+static void
+compile_wait(codeblock_t *block)
+{
+    if (!compile_block || (block && block != compile_block))
+        return;
+
+    thread_wait_event(compile_done_event, -1);
+    compile_finish(0);
+    CODEGEN_STAT_INC(compile_waits);
+}
+
+void
+codegen_compile_poll(void)
+{
+    if (!compile_block)
+        return;
+
+    /*A block handed over before a replay started is installed right away, as
+      the replay has to see the same blocks compiled at the same point*/
+    if (replay_started)
+        thread_wait_event(compile_done_event, -1);
+    else if (!atomic_load(&compile_done))
+        return;
+
+    compile_finish(1);
+}
+
+int
+codegen_compile_busy(void)
+{
+    return compile_block != NULL;
+}
+
 void
 codegen_block_end_recompile(codeblock_t *block)
 {
@@ -776,13 +940,119 @@ codegen_block_end_recompile(codeblock_t *block)
         block->flags &= ~CODEBLOCK_STATIC_TOP;
 
     codegen_accumulate_flush(ir_data);
-    codegen_ir_compile(ir_data, block);
+    /*When the worker finishes decides whether a block runs interpreted or
+      compiled, and so how cycles are spent; replays compile synchronously*/
+    if (cpu_dynarec_compile_thread && !replay_started)
+        compile_post(block);
+    else
+        codegen_ir_compile(ir_data, block);
 }
 
 void
 codegen_flush(void)
 {
-    return;
+    /*Linear to physical mappings may have changed, don't follow any existing
+      chained exit until the dispatcher has checked its target again*/
+    codegen_chain_gen++;
+}
+
+#ifdef CODEGEN_CHAIN
+int
+codegen_block_chain_exit_add(codeblock_t *block, uint32_t pc)
+{
+    int idx = block->chain_exits;
+
+    if (idx >= CODEBLOCK_CHAIN_EXITS)
+        return 0;
+
+    block->chain_pc[idx] = pc;
+    block->chain_nr[idx] = BLOCK_INVALID;
+    block->chain_exits++;
+
+    return (get_block_nr(block) << 2) | idx;
+}
+
+/*Remove exit_nr from the list of exits linked to dest*/
+static void
+chain_in_remove(codeblock_t *dest, uint32_t exit_nr)
+{
+    uint16_t *link = &dest->chain_in;
+
+    while (*link) {
+        codeblock_t *block = &codeblock[*link >> 2];
+        int          idx   = *link & 3;
+
+        if (*link == exit_nr) {
+            *link = block->chain_next[idx];
+            return;
+        }
+        link = &block->chain_next[idx];
+    }
+}
+
+/*Called by the dispatcher before running dest, when the last block left
+  through chained exit exit_nr. dest has just been validated against the
+  current CPU state, so the exit can jump to it for as long as
+  cpu_cur_status and the MMU mappings stay the same.*/
+void
+codegen_block_chain_link(uint32_t exit_nr, codeblock_t *dest)
+{
+    codeblock_t *block   = &codeblock[exit_nr >> 2];
+    int          idx     = exit_nr & 3;
+    uint16_t     dest_nr = get_block_nr(dest);
+
+    if (idx >= block->chain_exits || !(block->flags & CODEBLOCK_WAS_RECOMPILED))
+        return;
+    if ((block->_cs != dest->_cs) || ((block->_cs + block->chain_pc[idx]) != dest->pc))
+        return;
+    /*Entering these needs the dispatcher, for the FPU top-of-stack check and
+      to count towards trace promotion*/
+    if (dest->flags & CODEBLOCK_STATIC_TOP)
+        return;
+    if (cpu_dynarec_trace && !(dest->flags & (CODEBLOCK_TRACE | CODEBLOCK_BYTE_MASK)))
+        return;
+
+    if (block->chain_nr[idx] != dest_nr) {
+        if (block->chain_nr[idx] != BLOCK_INVALID)
+            chain_in_remove(&codeblock[block->chain_nr[idx]], exit_nr);
+        block->chain_nr[idx]   = dest_nr;
+        block->chain_next[idx] = dest->chain_in;
+        dest->chain_in         = exit_nr;
+        codegen_backend_chain_patch(block->chain_site[idx], codegen_backend_chain_entry(dest));
+        CODEGEN_STAT_INC(chain_links);
+    }
+    block->chain_status[idx] = cpu_cur_status;
+    block->chain_gen[idx]    = codegen_chain_gen;
+}
+#endif
+
+/*Drop all links to and from block. Must be called before the host code of
+  block is freed or overwritten.*/
+void
+codegen_block_chain_clear(codeblock_t *block)
+{
+#ifdef CODEGEN_CHAIN
+    uint16_t exit_nr;
+
+    for (int c = 0; c < block->chain_exits; c++) {
+        if (block->chain_nr[c] != BLOCK_INVALID)
+            chain_in_remove(&codeblock[block->chain_nr[c]], (get_block_nr(block) << 2) | c);
+        block->chain_nr[c] = BLOCK_INVALID;
+    }
+
+    /*Point every exit linked to this block back at the dispatcher*/
+    exit_nr = block->chain_in;
+    while (exit_nr) {
+        codeblock_t *src = &codeblock[exit_nr >> 2];
+        int          idx = exit_nr & 3;
+
+        codegen_backend_chain_patch(src->chain_site[idx], NULL);
+        src->chain_nr[idx] = BLOCK_INVALID;
+        exit_nr            = src->chain_next[idx];
+    }
+#endif
+    block->chain_exits = 0;
+    block->chain_in    = 0;
 }
 
 void
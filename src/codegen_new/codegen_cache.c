@@ -0,0 +1,235 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <86box/86box.h>
+#include "cpu.h"
+#include <86box/mem.h>
+#include <86box/path.h>
+#include <86box/plat.h>
+#include <86box/replay.h>
+
+#include "codegen.h"
+#include "codegen_backend.h"
+#include "codegen_cache.h"
+#include "codegen_public.h"
+#include "codegen_stats.h"
+
+#define CODEGEN_CACHE_FILE    "dynarec.cache"
+#define CODEGEN_CACHE_MAGIC   "86DYNHC"
+#define CODEGEN_CACHE_VERSION 2
+#define CODEGEN_CACHE_MAX     65536
+
+typedef struct codegen_cache_header_t {
+    char     magic[8];
+    uint32_t version;
+    uint32_t entry_size;
+    uint32_t nr_entries;
+} codegen_cache_header_t;
+
+typedef struct codegen_cache_entry_t {
+    uint32_t phys;
+    uint32_t cs_base;
+    uint64_t page_mask;
+    uint32_t hash;
+    uint32_t cpu_type;
+    uint32_t status;
+    uint32_t flags;
+} codegen_cache_entry_t;
+
+/*Entries loaded at startup, sorted by key*/
+static codegen_cache_entry_t *cache_entries;
+static int                    cache_nr_entries;
+
+static int
+codegen_cache_compare(const void *a, const void *b)
+{
+    const codegen_cache_entry_t *entry_a = (const codegen_cache_entry_t *) a;
+    const codegen_cache_entry_t *entry_b = (const codegen_cache_entry_t *) b;
+
+    if (entry_a->phys != entry_b->phys)
+        return (entry_a->phys < entry_b->phys) ? -1 : 1;
+    if (entry_a->cs_base != entry_b->cs_base)
+        return (entry_a->cs_base < entry_b->cs_base) ? -1 : 1;
+    if (entry_a->status != entry_b->status)
+        return (entry_a->status < entry_b->status) ? -1 : 1;
+    if (entry_a->cpu_type != entry_b->cpu_type)
+        return (entry_a->cpu_type < entry_b->cpu_type) ? -1 : 1;
+    return 0;
+}
+
+/*FNV-1a over the guest code covered by mask. For byte mask blocks each bit is
+  one byte of the 64 byte region containing phys, otherwise each bit is a 64
+  byte region of the page. Returns 0 if the page is not backed by memory.*/
+static uint32_t
+codegen_cache_hash(uint32_t phys, uint64_t mask, int byte_mask)
+{
+    const page_t *page = &pages[phys >> 12];
+    uint32_t      hash = 2166136261u;
+
+    if (!page->mem || (page->mem == page_ff))
+        return 0;
+
+    for (int c = 0; c < 64; c++) {
+        if (!(mask & ((uint64_t) 1 << c)))
+            continue;
+
+        if (byte_mask)
+            hash = (hash ^ page->mem[(phys & 0xfc0) + c]) * 16777619u;
+        else {
+            for (int d = 0; d < 64; d++)
+                hash = (hash ^ page->mem[(c << 6) + d]) * 16777619u;
+        }
+    }
+
+    return hash ? hash : 1;
+}
+
+static void
+codegen_cache_path(char *path)
+{
+    path_append_filename(path, usr_path, CODEGEN_CACHE_FILE);
+}
+
+void
+codegen_cache_load(void)
+{
+    codegen_cache_header_t header;
+    char                   path[1024];
+    FILE                  *fp;
+
+    free(cache_entries);
+    cache_entries    = NULL;
+    cache_nr_entries = 0;
+
+    if (!cpu_dynarec_cache)
+        return;
+
+    codegen_cache_path(path);
+    fp = plat_fopen(path, "rb");
+    if (!fp)
+        return;
+
+    if ((fread(&header, sizeof(header), 1, fp) != 1) || memcmp(header.magic, CODEGEN_CACHE_MAGIC, sizeof(header.magic)) ||
+        (header.version != CODEGEN_CACHE_VERSION) || (header.entry_size != sizeof(codegen_cache_entry_t)) ||
+        !header.nr_entries || (header.nr_entries > CODEGEN_CACHE_MAX)) {
+        pclog("codegen_cache_load: ignoring invalid %s\n", path);
+        fclose(fp);
+        return;
+    }
+
+    cache_entries = malloc(header.nr_entries * sizeof(codegen_cache_entry_t));
+    if (cache_entries && (fread(cache_entries, sizeof(codegen_cache_entry_t), header.nr_entries, fp) == header.nr_entries)) {
+        cache_nr_entries = header.nr_entries;
+        qsort(cache_entries, cache_nr_entries, sizeof(codegen_cache_entry_t), codegen_cache_compare);
+    } else {
+        free(cache_entries);
+        cache_entries = NULL;
+    }
+    fclose(fp);
+
+    pclog("codegen_cache_load: %i block hints loaded\n", cache_nr_entries);
+}
+
+void
+codegen_cache_apply(codeblock_t *block)
+{
+    codegen_cache_entry_t  key;
+    codegen_cache_entry_t *entry;
+    uint32_t               flags;
+
+    /*Hints change where blocks end, and so when timers run; a replay must
+      compile exactly as its recording did*/
+    if (!cache_nr_entries || replay_started)
+        return;
+
+    key.phys     = block->phys;
+    key.cs_base  = block->_cs;
+    key.status   = block->status;
+    key.cpu_type = cpu_s->cpu_type;
+    entry        = bsearch(&key, cache_entries, cache_nr_entries, sizeof(codegen_cache_entry_t), codegen_cache_compare);
+    if (!entry)
+        return;
+
+    if (codegen_cache_hash(entry->phys, entry->page_mask, entry->flags & CODEBLOCK_BYTE_MASK) != entry->hash)
+        return;
+
+    flags = entry->flags & CODEGEN_CACHE_FLAGS;
+    if (!cpu_dynarec_trace)
+        flags &= ~CODEBLOCK_TRACE;
+    if (flags & ~block->flags)
+        CODEGEN_STAT_INC(cache_hints_applied);
+    block->flags |= flags;
+
+    /*The block was compiled last run, so it is already known to be warm*/
+    if ((entry->flags & CODEBLOCK_WAS_RECOMPILED) && (block->compile_hits < cpu_dynarec_compile_threshold)) {
+        block->compile_hits = cpu_dynarec_compile_threshold;
+        CODEGEN_STAT_INC(cache_warm_applied);
+    }
+}
+
+void
+codegen_cache_save(void)
+{
+    codegen_cache_header_t header;
+    codegen_cache_entry_t *entries;
+    int                    nr_entries = 0;
+    int                    nr_resident;
+    char                   path[1024];
+    FILE                  *fp;
+
+    if (!cpu_dynarec_cache || !codeblock)
+        return;
+
+    entries = malloc(CODEGEN_CACHE_MAX * sizeof(codegen_cache_entry_t));
+    if (!entries)
+        return;
+
+    for (int c = 1; (c < BLOCK_SIZE) && (nr_entries < CODEGEN_CACHE_MAX); c++) {
+        const codeblock_t     *block = &codeblock[c];
+        codegen_cache_entry_t *entry = &entries[nr_entries];
+
+        if ((block->pc == BLOCK_PC_INVALID) || !(block->flags & (CODEGEN_CACHE_FLAGS | CODEBLOCK_WAS_RECOMPILED)) || !block->page_mask)
+            continue;
+
+        entry->phys      = block->phys;
+        entry->cs_base   = block->_cs;
+        entry->page_mask = block->page_mask;
+        entry->status    = block->status;
+        entry->cpu_type  = cpu_s->cpu_type;
+        entry->flags     = block->flags & (CODEGEN_CACHE_FLAGS | CODEBLOCK_WAS_RECOMPILED);
+        entry->hash      = codegen_cache_hash(block->phys, block->page_mask, block->flags & CODEBLOCK_BYTE_MASK);
+        if (entry->hash)
+            nr_entries++;
+    }
+
+    /*Keep hints for blocks that were not reached this run*/
+    nr_resident = nr_entries;
+    qsort(entries, nr_resident, sizeof(codegen_cache_entry_t), codegen_cache_compare);
+    for (int c = 0; (c < cache_nr_entries) && (nr_entries < CODEGEN_CACHE_MAX); c++) {
+        if (!bsearch(&cache_entries[c], entries, nr_resident, sizeof(codegen_cache_entry_t), codegen_cache_compare))
+            entries[nr_entries++] = cache_entries[c];
+    }
+
+    codegen_cache_path(path);
+    if (!nr_entries) {
+        remove(path);
+        free(entries);
+        return;
+    }
+
+    fp = plat_fopen(path, "wb");
+    if (fp) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CODEGEN_CACHE_MAGIC, sizeof(CODEGEN_CACHE_MAGIC));
+        header.version    = CODEGEN_CACHE_VERSION;
+        header.entry_size = sizeof(codegen_cache_entry_t);
+        header.nr_entries = nr_entries;
+
+        if ((fwrite(&header, sizeof(header), 1, fp) != 1) || (fwrite(entries, sizeof(codegen_cache_entry_t), nr_entries, fp) != (size_t) nr_entries))
+            pclog("codegen_cache_save: error writing %s\n", path);
+        fclose(fp);
+    }
+
+    free(entries);
+}
@@ -0,0 +1,30 @@
+#ifndef _CODEGEN_CACHE_H_
+#define _CODEGEN_CACHE_H_
+
+/*Persistent block hint cache, enabled by cpu_dynarec_cache.
+
+  Neither host code nor IR is kept across runs - host code embeds absolute
+  host addresses, and both are generated while the block is being
+  interpreted, from live CPU state. Every block is still compiled once per
+  run. What is kept is what the dynarec learnt about each block: that it was
+  compiled at all, whether it became a trace, and whether self-modifying code
+  forced it to byte mask or no-immediates mode. Reaching those states again
+  otherwise costs the compile threshold's worth of interpreted runs and
+  several recompiles per block on every boot.
+
+  On exit, compiled blocks are written to dynarec.cache in the VM directory,
+  together with the loaded entries that were not seen this run. Each entry is
+  keyed by physical address, CS base, the full CPU status word and CPU type,
+  and records a hash of the guest code bytes covered by the block's page mask.
+  When a block with a matching key is created and the hash of the current
+  guest bytes still matches, the flags are applied, and a block that was
+  compiled before skips cpu_dynarec_compile_threshold.
+
+  Entries are only hints, and the code is always compiled from the current
+  guest bytes, so a stale entry can cost performance but never correctness.*/
+
+#define CODEGEN_CACHE_FLAGS (CODEBLOCK_TRACE | CODEBLOCK_BYTE_MASK | CODEBLOCK_NO_IMMEDIATES)
+
+extern void codegen_cache_apply(codeblock_t *block);
+
+#endif
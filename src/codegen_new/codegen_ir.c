@@ -4,11 +4,14 @@
 #include <86box/mem.h>
 #include <86box/plat_unused.h>
 
+#include "x86.h"
+#include "x86_flags.h"
 #include "codegen.h"
 #include "codegen_allocator.h"
 #include "codegen_backend.h"
 #include "codegen_ir.h"
 #include "codegen_reg.h"
+#include "codegen_stats.h"
 
 extern int       has_ea;
 static ir_data_t ir_block;
@@ -59,6 +62,110 @@ duplicate_uop(ir_data_t *ir, uop_t *uop, int offset)
     }
 }
 
+static int
+uop_reads_reg(const uop_t *uop, int reg)
+{
+    return IREG_GET_REG(uop->src_reg_a.reg) == reg || IREG_GET_REG(uop->src_reg_b.reg) == reg || IREG_GET_REG(uop->src_reg_c.reg) == reg;
+}
+
+static void
+kill_flags_version(int reg, int version)
+{
+    reg_version_t *regv = &reg_version[reg][version];
+
+    /*Versions that were never marked required have already been put on the
+      dead list by codegen_reg_write()*/
+    if (regv->refcount || !(regv->flags & REG_FLAGS_REQUIRED))
+        return;
+
+    regv->flags &= ~REG_FLAGS_REQUIRED;
+    add_to_dead_list(regv, reg, version);
+    CODEGEN_STAT_INC(flags_stores_elided);
+}
+
+/*Dead flags elimination.
+
+  Every barrier marks the current version of each permanent register as
+  required, so flag state is always written back before anything outside the
+  block can see it. flags_op1 and flags_op2 however are never consulted while
+  flags_op is one of the FLAGS_ZN* operations, which logical ops use. A version
+  of flags_op1/flags_op2 that is not read by any uOP, and that is only live
+  across barriers and the block end while flags_op is known to be FLAGS_ZN*, is
+  therefore never observed and the uOP producing it can be dropped. The normal
+  dead register processing then removes the uOP and releases its sources.
+
+  flags_op is only known within straight-line code; it becomes unknown after
+  helper calls and inside the range covered by a forward jump. Blocks with
+  backward jumps are left alone.*/
+static void
+codegen_ir_eliminate_dead_flags(ir_data_t *ir)
+{
+    static const int flags_regs[2] = { IREG_flags_op1, IREG_flags_op2 };
+    int              pending[2]    = { -1, -1 };
+    int              flags_op_zn   = 0;
+    int              jump_end      = -1;
+    int              c;
+
+    for (c = 0; c < ir->wr_pos; c++) {
+        const uop_t *uop = &ir->uops[c];
+
+        if ((uop->type & UOP_TYPE_JUMP) && uop->jump_dest_uop <= c)
+            return;
+    }
+
+    for (c = 0; c < ir->wr_pos; c++) {
+        const uop_t *uop = &ir->uops[c];
+
+        if ((uop->type & UOP_MASK) == UOP_INVALID)
+            continue;
+
+        if (uop->type & UOP_TYPE_JUMP) {
+            if (uop->jump_dest_uop > jump_end)
+                jump_end = uop->jump_dest_uop;
+        }
+        if (c <= jump_end)
+            flags_op_zn = 0;
+
+        for (int r = 0; r < 2; r++) {
+            if (pending[r] == -1)
+                continue;
+            if (uop_reads_reg(uop, flags_regs[r]))
+                pending[r] = -1;
+            else if ((uop->type & (UOP_TYPE_BARRIER | UOP_TYPE_ORDER_BARRIER)) && !flags_op_zn)
+                pending[r] = -1;
+        }
+
+        if (uop->type & UOP_TYPE_BARRIER)
+            flags_op_zn = 0;
+
+        if (ir_reg_is_invalid(uop->dest_reg_a))
+            continue;
+
+        for (int r = 0; r < 2; r++) {
+            if (IREG_GET_REG(uop->dest_reg_a.reg) != flags_regs[r])
+                continue;
+
+            /*A partial write merges with the previous version, so that
+              version is observed*/
+            if (pending[r] != -1 && reg_is_native_size(uop->dest_reg_a))
+                kill_flags_version(flags_regs[r], pending[r]);
+            pending[r] = uop->dest_reg_a.version;
+        }
+
+        if (IREG_GET_REG(uop->dest_reg_a.reg) == IREG_flags_op) {
+            flags_op_zn = ((uop->type & UOP_MASK) == (UOP_MOV_IMM & UOP_MASK)) && reg_is_native_size(uop->dest_reg_a) &&
+                          (uop->imm_data == FLAGS_ZN8 || uop->imm_data == FLAGS_ZN16 || uop->imm_data == FLAGS_ZN32) && (c > jump_end);
+        }
+    }
+
+    if (flags_op_zn) {
+        for (int r = 0; r < 2; r++) {
+            if (pending[r] != -1)
+                kill_flags_version(flags_regs[r], pending[r]);
+        }
+    }
+}
+
 void
 codegen_ir_compile(ir_data_t *ir, codeblock_t *block)
 {
@@ -82,6 +189,7 @@ codegen_ir_compile(ir_data_t *ir, codeblock_t *block)
     }
 
     codegen_reg_mark_as_required();
+    codegen_ir_eliminate_dead_flags(ir);
     codegen_reg_process_dead_list(ir);
     block_write_data = codeblock_allocator_get_ptr(block->head_mem_block);
     block_pos        = 0;
@@ -90,6 +198,8 @@ codegen_ir_compile(ir_data_t *ir, codeblock_t *block)
     for (c = 0; c < ir->wr_pos; c++) {
         uop_t *uop = &ir->uops[c];
 
+        codegen_reg_set_uop(ir, c);
+
         //                pclog("uOP %i : %08x\n", c, uop->type);
 
         if (uop->type & UOP_TYPE_BARRIER)
@@ -189,6 +299,10 @@ codegen_ir_compile(ir_data_t *ir, codeblock_t *block)
     }
 
     codegen_backend_epilogue(block);
+#ifdef USE_DYNAREC_STATS
+    block->uop_count = ir->wr_pos;
+    block->host_size = ((codegen_allocator_get_count(block->head_mem_block) - 1) * MEM_BLOCK_SIZE) + block_pos;
+#endif
     block_write_data = NULL;
 #if 0
     if (has_ea)
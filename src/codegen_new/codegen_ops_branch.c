@@ -61,7 +61,7 @@ ropJO_common(UNUSED(codeblock_t *block), ir_data_t *ir, uint32_t dest_addr, UNUS
             break;
     }
     uop_MOV_IMM(ir, IREG_pc, dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return 0;
 }
@@ -76,7 +76,7 @@ ropJNO_common(UNUSED(codeblock_t *block), ir_data_t *ir, uint32_t dest_addr, UNU
         case FLAGS_ZN32:
             /*Overflow is always zero*/
             uop_MOV_IMM(ir, IREG_pc, dest_addr);
-            uop_JMP(ir, codegen_exit_rout);
+            uop_JMP_CHAIN(ir, dest_addr);
             return 0;
 
         case FLAGS_SUB8:
@@ -101,7 +101,7 @@ ropJNO_common(UNUSED(codeblock_t *block), ir_data_t *ir, uint32_t dest_addr, UNU
             break;
     }
     uop_MOV_IMM(ir, IREG_pc, dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return 0;
 }
@@ -150,7 +150,7 @@ ropJB_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t nex
             break;
     }
     uop_MOV_IMM(ir, IREG_pc, do_unroll ? next_pc : dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, do_unroll ? next_pc : dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return do_unroll ? 1 : 0;
 }
@@ -166,7 +166,7 @@ ropJNB_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
         case FLAGS_ZN32:
             /*Carry is always zero*/
             uop_MOV_IMM(ir, IREG_pc, dest_addr);
-            uop_JMP(ir, codegen_exit_rout);
+            uop_JMP_CHAIN(ir, dest_addr);
             return 0;
 
         case FLAGS_SUB8:
@@ -200,7 +200,7 @@ ropJNB_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
             break;
     }
     uop_MOV_IMM(ir, IREG_pc, do_unroll ? next_pc : dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, do_unroll ? next_pc : dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return do_unroll ? 1 : 0;
 }
@@ -218,7 +218,7 @@ ropJE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t nex
             jump_uop = uop_CMP_IMM_JZ_DEST(ir, IREG_flags_res, 0);
         }
         uop_MOV_IMM(ir, IREG_pc, next_pc);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, next_pc);
         uop_set_jump_dest(ir, jump_uop);
         return 1;
     } else {
@@ -229,7 +229,7 @@ ropJE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t nex
             jump_uop = uop_CMP_IMM_JNZ_DEST(ir, IREG_flags_res, 0);
         }
         uop_MOV_IMM(ir, IREG_pc, dest_addr);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, dest_addr);
         uop_set_jump_dest(ir, jump_uop);
     }
     return 0;
@@ -247,7 +247,7 @@ ropJNE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
             jump_uop = uop_CMP_IMM_JNZ_DEST(ir, IREG_flags_res, 0);
         }
         uop_MOV_IMM(ir, IREG_pc, next_pc);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, next_pc);
         uop_set_jump_dest(ir, jump_uop);
         return 1;
     } else {
@@ -258,7 +258,7 @@ ropJNE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
             jump_uop = uop_CMP_IMM_JZ_DEST(ir, IREG_flags_res, 0);
         }
         uop_MOV_IMM(ir, IREG_pc, dest_addr);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, dest_addr);
         uop_set_jump_dest(ir, jump_uop);
     }
     return 0;
@@ -318,7 +318,7 @@ ropJBE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
     }
     if (do_unroll) {
         uop_MOV_IMM(ir, IREG_pc, next_pc);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, next_pc);
         uop_set_jump_dest(ir, jump_uop);
         if (jump_uop2 != -1)
             uop_set_jump_dest(ir, jump_uop2);
@@ -327,7 +327,7 @@ ropJBE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
         if (jump_uop2 != -1)
             uop_set_jump_dest(ir, jump_uop2);
         uop_MOV_IMM(ir, IREG_pc, dest_addr);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, dest_addr);
         uop_set_jump_dest(ir, jump_uop);
         return 0;
     }
@@ -388,12 +388,12 @@ ropJNBE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t n
         if (jump_uop2 != -1)
             uop_set_jump_dest(ir, jump_uop2);
         uop_MOV_IMM(ir, IREG_pc, next_pc);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, next_pc);
         uop_set_jump_dest(ir, jump_uop);
         return 1;
     } else {
         uop_MOV_IMM(ir, IREG_pc, dest_addr);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, dest_addr);
         uop_set_jump_dest(ir, jump_uop);
         if (jump_uop2 != -1)
             uop_set_jump_dest(ir, jump_uop2);
@@ -460,7 +460,7 @@ ropJS_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t nex
             break;
     }
     uop_MOV_IMM(ir, IREG_pc, do_unroll ? next_pc : dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, do_unroll ? next_pc : dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return do_unroll ? 1 : 0;
 }
@@ -523,7 +523,7 @@ ropJNS_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
             break;
     }
     uop_MOV_IMM(ir, IREG_pc, do_unroll ? next_pc : dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, do_unroll ? next_pc : dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return do_unroll ? 1 : 0;
 }
@@ -536,7 +536,7 @@ ropJP_common(UNUSED(codeblock_t *block), ir_data_t *ir, uint32_t dest_addr, UNUS
     uop_CALL_FUNC_RESULT(ir, IREG_temp0, PF_SET);
     jump_uop = uop_CMP_IMM_JZ_DEST(ir, IREG_temp0, 0);
     uop_MOV_IMM(ir, IREG_pc, dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return 0;
 }
@@ -548,7 +548,7 @@ ropJNP_common(UNUSED(codeblock_t *block), ir_data_t *ir, uint32_t dest_addr, UNU
     uop_CALL_FUNC_RESULT(ir, IREG_temp0, PF_SET);
     jump_uop = uop_CMP_IMM_JNZ_DEST(ir, IREG_temp0, 0);
     uop_MOV_IMM(ir, IREG_pc, dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return 0;
 }
@@ -616,7 +616,7 @@ ropJL_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t nex
         uop_MOV_IMM(ir, IREG_pc, next_pc);
     else
         uop_MOV_IMM(ir, IREG_pc, dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, do_unroll ? next_pc : dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return do_unroll ? 1 : 0;
 }
@@ -683,7 +683,7 @@ ropJNL_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
         uop_MOV_IMM(ir, IREG_pc, next_pc);
     else
         uop_MOV_IMM(ir, IREG_pc, dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, do_unroll ? next_pc : dest_addr);
     uop_set_jump_dest(ir, jump_uop);
     return do_unroll ? 1 : 0;
 }
@@ -737,7 +737,7 @@ ropJLE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
     }
     if (do_unroll) {
         uop_MOV_IMM(ir, IREG_pc, next_pc);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, next_pc);
         uop_set_jump_dest(ir, jump_uop);
         if (jump_uop2 != -1)
             uop_set_jump_dest(ir, jump_uop2);
@@ -746,7 +746,7 @@ ropJLE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t ne
         if (jump_uop2 != -1)
             uop_set_jump_dest(ir, jump_uop2);
         uop_MOV_IMM(ir, IREG_pc, dest_addr);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, dest_addr);
         uop_set_jump_dest(ir, jump_uop);
         return 0;
     }
@@ -802,12 +802,12 @@ ropJNLE_common(codeblock_t *block, ir_data_t *ir, uint32_t dest_addr, uint32_t n
         if (jump_uop2 != -1)
             uop_set_jump_dest(ir, jump_uop2);
         uop_MOV_IMM(ir, IREG_pc, next_pc);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, next_pc);
         uop_set_jump_dest(ir, jump_uop);
         return 1;
     } else {
         uop_MOV_IMM(ir, IREG_pc, dest_addr);
-        uop_JMP(ir, codegen_exit_rout);
+        uop_JMP_CHAIN(ir, dest_addr);
         uop_set_jump_dest(ir, jump_uop);
         if (jump_uop2 != -1)
             uop_set_jump_dest(ir, jump_uop2);
@@ -901,7 +901,7 @@ ropJCXZ(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), UNUSED(uint32
     else
         jump_uop = uop_CMP_IMM_JNZ_DEST(ir, IREG_CX, 0);
     uop_MOV_IMM(ir, IREG_pc, dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, dest_addr);
     uop_set_jump_dest(ir, jump_uop);
 
     codegen_mark_code_present(block, cs + op_pc, 1);
@@ -914,6 +914,7 @@ ropLOOP(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), UNUSED(uint32
     uint32_t offset    = (int32_t) (int8_t) fastreadb(cs + op_pc);
     uint32_t dest_addr = op_pc + 1 + offset;
     uint32_t ret_addr;
+    uint32_t exit_addr;
     int      jump_uop;
 
     if (!(op_32 & 0x100))
@@ -927,8 +928,8 @@ ropLOOP(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), UNUSED(uint32
             uop_SUB_IMM(ir, IREG_CX, IREG_CX, 1);
             jump_uop = uop_CMP_IMM_JNZ_DEST(ir, IREG_CX, 0);
         }
-        uop_MOV_IMM(ir, IREG_pc, op_pc + 1);
-        ret_addr = dest_addr;
+        exit_addr = op_pc + 1;
+        ret_addr  = dest_addr;
         CPU_BLOCK_END();
     } else {
         if (op_32 & 0x200) {
@@ -938,10 +939,11 @@ ropLOOP(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), UNUSED(uint32
             uop_SUB_IMM(ir, IREG_CX, IREG_CX, 1);
             jump_uop = uop_CMP_IMM_JZ_DEST(ir, IREG_CX, 0);
         }
-        uop_MOV_IMM(ir, IREG_pc, dest_addr);
-        ret_addr = op_pc + 1;
+        exit_addr = dest_addr;
+        ret_addr  = op_pc + 1;
     }
-    uop_JMP(ir, codegen_exit_rout);
+    uop_MOV_IMM(ir, IREG_pc, exit_addr);
+    uop_JMP_CHAIN(ir, exit_addr);
     uop_set_jump_dest(ir, jump_uop);
 
     codegen_mark_code_present(block, cs + op_pc, 1);
@@ -973,7 +975,7 @@ ropLOOPE(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), UNUSED(uint3
         jump_uop2 = uop_CMP_IMM_JNZ_DEST(ir, IREG_flags_res, 0);
     }
     uop_MOV_IMM(ir, IREG_pc, dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, dest_addr);
     uop_NOP_BARRIER(ir);
     uop_set_jump_dest(ir, jump_uop);
     uop_set_jump_dest(ir, jump_uop2);
@@ -1006,7 +1008,7 @@ ropLOOPNE(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), UNUSED(uint
         jump_uop2 = uop_CMP_IMM_JZ_DEST(ir, IREG_flags_res, 0);
     }
     uop_MOV_IMM(ir, IREG_pc, dest_addr);
-    uop_JMP(ir, codegen_exit_rout);
+    uop_JMP_CHAIN(ir, dest_addr);
     uop_NOP_BARRIER(ir);
     uop_set_jump_dest(ir, jump_uop);
     uop_set_jump_dest(ir, jump_uop2);
@@ -26,6 +26,7 @@ ropJMP_r8(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), UNUSED(uint
     if (offset < 0)
         codegen_can_unroll(block, ir, op_pc + 1, dest_addr);
     codegen_mark_code_present(block, cs + op_pc, 1);
+    codegen_trace_jump(block, dest_addr);
     return dest_addr;
 }
 uint32_t
@@ -39,6 +40,7 @@ ropJMP_r16(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), UNUSED(uin
     if (offset < 0)
         codegen_can_unroll(block, ir, op_pc + 1, dest_addr);
     codegen_mark_code_present(block, cs + op_pc, 2);
+    codegen_trace_jump(block, dest_addr);
     return dest_addr;
 }
 uint32_t
@@ -50,6 +52,7 @@ ropJMP_r32(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), UNUSED(uin
     if (offset < 0)
         codegen_can_unroll(block, ir, op_pc + 1, dest_addr);
     codegen_mark_code_present(block, cs + op_pc, 4);
+    codegen_trace_jump(block, dest_addr);
     return dest_addr;
 }
 
@@ -8,6 +8,7 @@
 #include "codegen_backend.h"
 #include "codegen_ir_defs.h"
 #include "codegen_reg.h"
+#include "codegen_stats.h"
 
 int      max_version_refcount;
 uint16_t reg_dead_list = 0;
@@ -34,6 +35,10 @@ typedef struct host_reg_set_t {
 static host_reg_set_t host_reg_set;
 static host_reg_set_t host_fp_reg_set;
 
+/*IR and uOP currently being compiled, see codegen_reg_next_read()*/
+static ir_data_t *reg_ir;
+static int        reg_uop_nr;
+
 enum {
     REG_BYTE,
     REG_WORD,
@@ -273,6 +278,16 @@ codegen_reg_reset(void)
 
     reg_dead_list        = 0;
     max_version_refcount = 0;
+
+    reg_ir     = NULL;
+    reg_uop_nr = 0;
+}
+
+void
+codegen_reg_set_uop(ir_data_t *ir, int uop_nr)
+{
+    reg_ir     = ir;
+    reg_uop_nr = uop_nr;
 }
 
 static inline int
@@ -547,6 +562,64 @@ codegen_reg_write_imm(codeblock_t *block, ir_reg_t ir_reg, uint32_t imm_data)
 }
 #endif
 
+/*Liveness lookahead. Returns the index of the next uOP after the current one
+  that reads the value held in ir_reg, or UOP_NR_MAX if the value is not read
+  again in this block (no pending reads, or overwritten first). A partial write
+  to the register counts as a read, as it merges with the previous value.*/
+static int
+codegen_reg_next_read(ir_reg_t ir_reg)
+{
+    int reg = IREG_GET_REG(ir_reg.reg);
+
+    if (!reg_version[reg][ir_reg.version].refcount || !reg_ir)
+        return UOP_NR_MAX;
+
+    for (int c = reg_uop_nr + 1; c < reg_ir->wr_pos; c++) {
+        const uop_t *uop = &reg_ir->uops[c];
+
+        if ((uop->type & UOP_MASK) == UOP_INVALID)
+            continue;
+        if (IREG_GET_REG(uop->src_reg_a.reg) == reg || IREG_GET_REG(uop->src_reg_b.reg) == reg || IREG_GET_REG(uop->src_reg_c.reg) == reg)
+            return c;
+        if (IREG_GET_REG(uop->dest_reg_a.reg) == reg)
+            return reg_is_native_size(uop->dest_reg_a) ? UOP_NR_MAX : c;
+    }
+
+    return UOP_NR_MAX;
+}
+
+/*Pick a host register to spill. Free registers are used first. Otherwise the
+  unlocked register whose value is next read furthest in the future is chosen,
+  so values that are dead for the rest of the block go before live ones, and
+  clean registers go before dirty ones that would need writing back.*/
+static int
+codegen_reg_pick_victim(host_reg_set_t *reg_set)
+{
+    int victim     = -1;
+    int best_score = -1;
+
+    for (int c = 0; c < reg_set->nr_regs; c++) {
+        int score;
+
+        if (reg_set->locked & (1 << c))
+            continue;
+        if (ir_reg_is_invalid(reg_set->regs[c]))
+            return c;
+
+        score = codegen_reg_next_read(reg_set->regs[c]) * 2 + !reg_set->dirty[c];
+        if (score > best_score) {
+            victim     = c;
+            best_score = score;
+        }
+    }
+#ifndef RELEASE_BUILD
+    if (victim == -1)
+        fatal("codegen_reg_pick_victim - out of registers\n");
+#endif
+
+    return victim;
+}
+
 static void
 alloc_reg(ir_reg_t ir_reg)
 {
@@ -645,27 +718,15 @@ codegen_reg_alloc_read_reg(codeblock_t *block, ir_reg_t ir_reg, int *host_reg_id
     }
 
     if (c == reg_set->nr_regs) {
-        /*No unused registers. Search for an unlocked register with no pending reads*/
-        for (c = 0; c < reg_set->nr_regs; c++) {
-            if (!(reg_set->locked & (1 << c)) && IREG_GET_REG(reg_set->regs[c].reg) != IREG_INVALID && !ir_get_refcount(reg_set->regs[c]))
-                break;
-        }
-        if (c == reg_set->nr_regs) {
-            /*Search for any unlocked register*/
-            for (c = 0; c < reg_set->nr_regs; c++) {
-                if (!(reg_set->locked & (1 << c)))
-                    break;
-            }
-#ifndef RELEASE_BUILD
-            if (c == reg_set->nr_regs)
-                fatal("codegen_reg_alloc_read_reg - out of registers\n");
-#endif
-        }
+        c = codegen_reg_pick_victim(reg_set);
         if (reg_set->dirty[c])
             codegen_reg_writeback(reg_set, block, c, 1);
         codegen_reg_load(reg_set, block, c, ir_reg);
         reg_set->locked |= (1 << c);
         reg_set->dirty[c] = 0;
+    } else if (ireg_data[IREG_GET_REG(ir_reg.reg)].is_volatile == REG_PERMANENT) {
+        /*Only guest registers would otherwise be loaded from cpu_state*/
+        CODEGEN_BLOCK_STAT_INC(block, reg_loads_elided);
     }
 
     reg_version[IREG_GET_REG(reg_set->regs[c].reg)][reg_set->regs[c].version].refcount--;
@@ -716,31 +777,19 @@ codegen_reg_alloc_write_reg(codeblock_t *block, ir_reg_t ir_reg)
                 if (reg_version[IREG_GET_REG(reg_set->regs[c].reg)][reg_set->regs[c].version].refcount != 0)
                     fatal("codegen_reg_alloc_write_reg - previous version refcount != 0\n");
 #endif
+                /*The previous version is overwritten in place, so it never
+                  needs storing to cpu_state*/
+                if (reg_set->dirty[c] && ireg_data[IREG_GET_REG(ir_reg.reg)].is_volatile == REG_PERMANENT)
+                    CODEGEN_BLOCK_STAT_INC(block, reg_stores_elided);
                 break;
             }
         }
     }
 
     if (c == reg_set->nr_regs) {
-        /*Search for unused registers*/
-        for (c = 0; c < reg_set->nr_regs; c++) {
-            if (ir_reg_is_invalid(reg_set->regs[c]))
-                break;
-        }
-
-        if (c == reg_set->nr_regs) {
-            /*No unused registers. Search for an unlocked register*/
-            for (c = 0; c < reg_set->nr_regs; c++) {
-                if (!(reg_set->locked & (1 << c)))
-                    break;
-            }
-#ifndef RELEASE_BUILD
-            if (c == reg_set->nr_regs)
-                fatal("codegen_reg_alloc_write_reg - out of registers\n");
-#endif
-            if (reg_set->dirty[c])
-                codegen_reg_writeback(reg_set, block, c, 1);
-        }
+        c = codegen_reg_pick_victim(reg_set);
+        if (!ir_reg_is_invalid(reg_set->regs[c]) && reg_set->dirty[c])
+            codegen_reg_writeback(reg_set, block, c, 1);
     }
 
     reg_set->regs[c].reg     = ir_reg.reg;
@@ -412,6 +412,10 @@ void codegen_reg_flush(struct ir_data_t *ir, codeblock_t *block);
 /*Write back and evict all registers*/
 void codegen_reg_flush_invalidate(struct ir_data_t *ir, codeblock_t *block);
 
+/*Set the uOP about to be compiled. Used to look ahead in the IR when choosing
+  which host register to spill*/
+void codegen_reg_set_uop(struct ir_data_t *ir, int uop_nr);
+
 /*Register ir_reg usage for this uOP. This ensures that required registers aren't evicted*/
 void codegen_reg_alloc_register(ir_reg_t dest_reg_a, ir_reg_t src_reg_a, ir_reg_t src_reg_b, ir_reg_t src_reg_c);
 
@@ -0,0 +1,99 @@
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <86box/86box.h>
+#include "cpu.h"
+#include <86box/mem.h>
+
+#include "codegen.h"
+#include "codegen_backend.h"
+#include "codegen_public.h"
+#include "codegen_stats.h"
+
+#define HOT_BLOCK_REPORT_SIZE 32
+
+codegen_stats_t codegen_stats;
+
+void
+codegen_stats_reset(void)
+{
+    memset(&codegen_stats, 0, sizeof(codegen_stats_t));
+
+    if (codeblock) {
+        for (int c = 0; c < BLOCK_SIZE; c++)
+            codeblock[c].exec_count = 0;
+    }
+}
+
+static int
+codegen_stats_compare(const void *a, const void *b)
+{
+    const codeblock_t *block_a = &codeblock[*(const uint16_t *) a];
+    const codeblock_t *block_b = &codeblock[*(const uint16_t *) b];
+
+    if (block_a->exec_count > block_b->exec_count)
+        return -1;
+    if (block_a->exec_count < block_b->exec_count)
+        return 1;
+    return 0;
+}
+
+void
+codegen_stats_dump(void)
+{
+    uint16_t *hot_blocks;
+    int       nr_blocks = 0;
+
+    pclog("Dynarec block cache statistics:\n");
+    pclog("  Compiles                  : %" PRIu64 "\n", codegen_stats.compiles);
+    pclog("  Marks (interpreted once)  : %" PRIu64 "\n", codegen_stats.marks);
+    pclog("  Compiled block executions : %" PRIu64 "\n", codegen_stats.executions);
+    pclog("  Interpreter fallbacks     : %" PRIu64 "\n", codegen_stats.interpreter_fallbacks);
+    pclog("  Deferred compiles         : %" PRIu64 "\n", codegen_stats.compiles_deferred);
+    pclog("  Worker compiles           : %" PRIu64 "\n", codegen_stats.compiles_offloaded);
+    pclog("  Worker busy, interpreted  : %" PRIu64 "\n", codegen_stats.compiles_busy);
+    pclog("  Worker results dropped    : %" PRIu64 "\n", codegen_stats.compile_waits);
+    pclog("  Invalidations (page mask) : %" PRIu64 "\n", codegen_stats.invalidations_page_mask);
+    pclog("  Invalidations (byte mask) : %" PRIu64 "\n", codegen_stats.invalidations_byte_mask);
+    pclog("  Evictions (dirty list)    : %" PRIu64 "\n", codegen_stats.evictions_dirty_list);
+    pclog("  Evictions (block pool)    : %" PRIu64 "\n", codegen_stats.evictions_random);
+    pclog("  Evictions (memory pool)   : %" PRIu64 "\n", codegen_stats.evictions_mem_block);
+    pclog("  Trace promotions          : %" PRIu64 "\n", codegen_stats.traces);
+    pclog("  Trace jumps inlined       : %" PRIu64 "\n", codegen_stats.trace_jumps);
+    pclog("  Chained exits linked      : %" PRIu64 "\n", codegen_stats.chain_links);
+    pclog("  Chained block entries     : %" PRIu64 "\n", codegen_stats.chain_jumps);
+    pclog("  Register loads elided     : %" PRIu64 "\n", codegen_stats.reg_loads_elided);
+    pclog("  Register stores elided    : %" PRIu64 "\n", codegen_stats.reg_stores_elided);
+    pclog("  Dead flags writes elided  : %" PRIu64 "\n", codegen_stats.flags_stores_elided);
+    pclog("  Cached block hints applied: %" PRIu64 "\n", codegen_stats.cache_hints_applied);
+    pclog("  Cached warm blocks        : %" PRIu64 "\n", codegen_stats.cache_warm_applied);
+
+    if (!codeblock)
+        return;
+
+    hot_blocks = malloc(BLOCK_SIZE * sizeof(uint16_t));
+    if (!hot_blocks)
+        return;
+
+    for (int c = 1; c < BLOCK_SIZE; c++) {
+        const codeblock_t *block = &codeblock[c];
+
+        if ((block->pc != BLOCK_PC_INVALID) && (block->flags & CODEBLOCK_WAS_RECOMPILED) && block->exec_count)
+            hot_blocks[nr_blocks++] = c;
+    }
+
+    qsort(hot_blocks, nr_blocks, sizeof(uint16_t), codegen_stats_compare);
+
+    pclog("Hot blocks (%i resident with executions):\n", nr_blocks);
+    pclog("  %-14s %-9s %-9s %6s %8s %6s %6s\n", "CS:EIP", "Phys", "Execs", "uOPs", "Host", "LdElim", "StElim");
+    for (int c = 0; (c < nr_blocks) && (c < HOT_BLOCK_REPORT_SIZE); c++) {
+        const codeblock_t *block = &codeblock[hot_blocks[c]];
+
+        pclog("  %04X:%08X %08X %9" PRIu64 " %6i %8i %6i %6i\n", block->cs_sel, block->eip,
+              block->phys, block->exec_count, block->uop_count, block->host_size,
+              block->reg_loads_elided, block->reg_stores_elided);
+    }
+
+    free(hot_blocks);
+}
@@ -0,0 +1,53 @@
+#ifndef _CODEGEN_STATS_H_
+#define _CODEGEN_STATS_H_
+
+/*Block cache statistics, only collected when built with DYNAREC_STATS.
+
+  Counters are global and cumulative since codegen_init() or the last
+  codegen_stats_reset(). Per-block execution counts, uOP counts and host code
+  sizes live in codeblock_t and are lost when a block is deleted, so the hot
+  block report only covers blocks that are still resident.*/
+#ifdef USE_DYNAREC_STATS
+typedef struct codegen_stats_t {
+    uint64_t compiles;                /*Blocks compiled to host code*/
+    uint64_t marks;                   /*Blocks interpreted once to mark code present*/
+    uint64_t executions;              /*Compiled block executions*/
+    uint64_t interpreter_fallbacks;   /*Dispatches to exec386_dynarec_int()*/
+    uint64_t compiles_deferred;       /*Marked blocks interpreted again instead of compiled*/
+    uint64_t compiles_offloaded;      /*Blocks handed to the compile worker*/
+    uint64_t compiles_busy;           /*Blocks interpreted because the compile worker was busy*/
+    uint64_t compile_waits;           /*Blocks freed while the compile worker still had them*/
+    uint64_t invalidations_page_mask; /*Blocks invalidated by the 64-byte page mask*/
+    uint64_t invalidations_byte_mask; /*Blocks invalidated by the byte mask*/
+    uint64_t evictions_dirty_list;    /*Blocks dropped from the dirty list*/
+    uint64_t evictions_random;        /*Blocks deleted to free a codeblock_t*/
+    uint64_t evictions_mem_block;     /*Blocks deleted to free allocator memory*/
+    uint64_t traces;                  /*Hot blocks promoted to traces*/
+    uint64_t trace_jumps;             /*Direct jumps compiled inline into traces*/
+    uint64_t chain_links;             /*Block exits linked to their target block*/
+    uint64_t chain_jumps;             /*Blocks entered through a linked exit, bypassing the dispatcher*/
+    uint64_t reg_loads_elided;        /*Guest register reads satisfied from a host register*/
+    uint64_t reg_stores_elided;       /*Dirty host registers overwritten without a store*/
+    uint64_t flags_stores_elided;     /*flags_op1/op2 writes dropped by dead flags elimination*/
+    uint64_t cache_hints_applied;     /*Blocks given flags from the persistent hint cache*/
+    uint64_t cache_warm_applied;      /*Blocks let past the compile threshold by the hint cache*/
+} codegen_stats_t;
+
+extern codegen_stats_t codegen_stats;
+
+extern void codegen_stats_reset(void);
+extern void codegen_stats_dump(void);
+
+#    define CODEGEN_STAT_INC(x) codegen_stats.x++
+/*Count against both the global totals and the block being compiled*/
+#    define CODEGEN_BLOCK_STAT_INC(block, x) \
+        do {                                 \
+            codegen_stats.x++;               \
+            (block)->x++;                    \
+        } while (0)
+#else
+#    define CODEGEN_STAT_INC(x)
+#    define CODEGEN_BLOCK_STAT_INC(block, x)
+#endif
+
+#endif
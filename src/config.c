@@ -183,6 +183,8 @@ load_general(void)
     confirm_exit  = ini_section_get_int(cat, "confirm_exit", 1);
     confirm_save  = ini_section_get_int(cat, "confirm_save", 1);
 
+    density_mode = !!ini_section_get_int(cat, "density_mode", 0);
+
     p = ini_section_get_string(cat, "language", NULL);
     if (p != NULL)
         lang_id = plat_language_code(p);
@@ -392,7 +394,23 @@ load_machine(void)
     if (mem_size > machine_get_max_ram(machine))
         mem_size = machine_get_max_ram(machine);
 
+    mem_hugepages = ini_section_get_int(cat, "mem_hugepages", 0);
+    if ((mem_hugepages < 0) || (mem_hugepages > 2))
+        mem_hugepages = 0;
+    mem_numa = !!ini_section_get_int(cat, "mem_numa", 0);
+
     cpu_use_dynarec = !!ini_section_get_int(cat, "cpu_use_dynarec", 0);
+    cpu_dynarec_trace = !!ini_section_get_int(cat, "cpu_dynarec_trace", 0);
+    cpu_dynarec_cache = !!ini_section_get_int(cat, "cpu_dynarec_cache", 0);
+    cpu_dynarec_compile_threshold = ini_section_get_int(cat, "cpu_dynarec_compile_threshold", 0);
+    if (cpu_dynarec_compile_threshold < 0)
+        cpu_dynarec_compile_threshold = 0;
+    else if (cpu_dynarec_compile_threshold > 1000)
+        cpu_dynarec_compile_threshold = 1000;
+    cpu_dynarec_compile_thread = !!ini_section_get_int(cat, "cpu_dynarec_compile_thread", 0);
+    cpu_idle_skip = ini_section_get_int(cat, "cpu_idle_skip", 1);
+    if ((cpu_idle_skip < 0) || (cpu_idle_skip > 2))
+        cpu_idle_skip = 1;
     fpu_softfloat = !!ini_section_get_int(cat, "fpu_softfloat", 0);
     if ((fpu_type != FPU_NONE) && machine_has_flags(machine, MACHINE_SOFTFLOAT_ONLY))
         fpu_softfloat = 1;
@@ -2056,6 +2074,11 @@ save_general(void)
     else
         ini_section_delete_var(cat, "confirm_save");
 
+    if (density_mode)
+        ini_section_set_int(cat, "density_mode", density_mode);
+    else
+        ini_section_delete_var(cat, "density_mode");
+
     if (mouse_sensitivity != 1.0)
         ini_section_set_double(cat, "mouse_sensitivity", mouse_sensitivity);
     else
@@ -2178,8 +2201,43 @@ save_machine(void)
        to display it without having the actual machine table. */
     ini_section_set_int(cat, "mem_size", mem_size);
 
+    if (mem_hugepages == 0)
+        ini_section_delete_var(cat, "mem_hugepages");
+    else
+        ini_section_set_int(cat, "mem_hugepages", mem_hugepages);
+
+    if (mem_numa == 0)
+        ini_section_delete_var(cat, "mem_numa");
+    else
+        ini_section_set_int(cat, "mem_numa", mem_numa);
+
     ini_section_set_int(cat, "cpu_use_dynarec", cpu_use_dynarec);
 
+    if (cpu_dynarec_trace == 0)
+        ini_section_delete_var(cat, "cpu_dynarec_trace");
+    else
+        ini_section_set_int(cat, "cpu_dynarec_trace", cpu_dynarec_trace);
+
+    if (cpu_dynarec_cache == 0)
+        ini_section_delete_var(cat, "cpu_dynarec_cache");
+    else
+        ini_section_set_int(cat, "cpu_dynarec_cache", cpu_dynarec_cache);
+
+    if (cpu_dynarec_compile_threshold == 0)
+        ini_section_delete_var(cat, "cpu_dynarec_compile_threshold");
+    else
+        ini_section_set_int(cat, "cpu_dynarec_compile_threshold", cpu_dynarec_compile_threshold);
+
+    if (cpu_dynarec_compile_thread == 0)
+        ini_section_delete_var(cat, "cpu_dynarec_compile_thread");
+    else
+        ini_section_set_int(cat, "cpu_dynarec_compile_thread", cpu_dynarec_compile_thread);
+
+    if (cpu_idle_skip == 1)
+        ini_section_delete_var(cat, "cpu_idle_skip");
+    else
+        ini_section_set_int(cat, "cpu_idle_skip", cpu_idle_skip);
+
     if (fpu_softfloat == 0)
         ini_section_delete_var(cat, "fpu_softfloat");
     else
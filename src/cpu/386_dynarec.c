@@ -25,6 +25,7 @@
 #include <86box/mem.h>
 #include <86box/nmi.h>
 #include <86box/pic.h>
+#include <86box/prof.h>
 #include <86box/random.h>
 #include <86box/timer.h>
 #include <86box/fdd.h>
@@ -37,6 +38,7 @@
 #    include "codegen.h"
 #    ifdef USE_NEW_DYNAREC
 #        include "codegen_backend.h"
+#        include "codegen_stats.h"
 #    endif
 #endif
 
@@ -444,6 +446,45 @@ block_ended:
     cpu_end_block_after_ins = 0;
 }
 
+#ifdef CODEGEN_CHAIN
+/* Called from the chained exits of compiled blocks, see codegen.h. Returns
+   non-zero if the block may jump straight into the block linked to exit_nr,
+   or zero to return to the dispatcher. This has to refuse anything that
+   exec386_dynarec() would act on between two blocks. */
+int
+exec386_dynarec_chain(uint32_t exit_nr)
+{
+    codeblock_t *block = &codeblock[exit_nr >> 2];
+    codeblock_t *dest;
+    int          idx = exit_nr & 3;
+
+    codegen_chain_exit = exit_nr;
+
+    if ((block->chain_nr[idx] == BLOCK_INVALID) || (block->chain_status[idx] != cpu_cur_status) || (block->chain_gen[idx] != codegen_chain_gen))
+        return 0;
+    if ((cycles <= 0) || !CACHE_ON() || cpu_override_dynarec)
+        return 0;
+    /* tsc is only brought up to date after returning to exec386_dynarec(),
+       work out where it would be now. */
+    if (TIMER_VAL_LESS_THAN_VAL(timer_target, codegen_chain_tsc - cycles))
+        return 0;
+    if (cpu_init || new_ne || smi_line || (nmi && nmi_enable && nmi_mask) || ((cpu_state.flags & I_FLAG) && pic.int_pending))
+        return 0;
+
+    /* Self-modifying code, the dispatcher will invalidate dest */
+    dest = &codeblock[block->chain_nr[idx]];
+    if ((dest->page_mask & *dest->dirty_mask) || (dest->page_mask2 && (dest->page_mask2 & *dest->dirty_mask2)))
+        return 0;
+
+#    ifdef USE_DYNAREC_STATS
+    CODEGEN_STAT_INC(chain_jumps);
+    CODEGEN_STAT_INC(executions);
+    dest->exec_count++;
+#    endif
+    return 1;
+}
+#endif
+
 #if defined(__linux__) && !defined(__clang__) && defined(USE_NEW_DYNAREC)
 static inline void __attribute__((optimize("O2")))
 #else
@@ -456,12 +497,19 @@ exec386_dynarec_dyn(void)
     int      hash      = HASH(phys_addr);
 #    ifdef USE_NEW_DYNAREC
     codeblock_t *block = &codeblock[codeblock_hash[hash]];
+#        ifdef CODEGEN_CHAIN
+    uint32_t chain_exit = codegen_chain_exit;
+
+    codegen_chain_exit = 0;
+#        endif
 #    else
     codeblock_t *block = codeblock_hash[hash];
 #    endif
     int valid_block = 0;
 
 #    ifdef USE_NEW_DYNAREC
+    /* Install the compile worker's block, if it has finished */
+    codegen_compile_poll();
     if (!cpu_state.abrt)
 #    else
     if (block && !cpu_state.abrt)
@@ -570,6 +618,28 @@ exec386_dynarec_dyn(void)
     }
 
 #    ifdef USE_NEW_DYNAREC
+    /* Keep interpreting blocks that have been marked but are not yet warm
+       enough to be worth the compile, and any uncompiled block while the
+       compile worker is busy, as the IR can only hold one block at a time.
+       This includes the block the worker is compiling. */
+    if (valid_block && !cpu_state.abrt && !(block->flags & CODEBLOCK_WAS_RECOMPILED)) {
+        if (!(block->flags & (CODEBLOCK_TRACE | CODEBLOCK_IN_DIRTY_LIST)) && (block->compile_hits < cpu_dynarec_compile_threshold)) {
+            block->compile_hits++;
+            CODEGEN_STAT_INC(compiles_deferred);
+            exec386_dynarec_int();
+            return;
+        }
+        if (codegen_compile_busy()) {
+            CODEGEN_STAT_INC(compiles_busy);
+            exec386_dynarec_int();
+            return;
+        }
+    }
+
+    if (valid_block && cpu_dynarec_trace && ((block->flags & (CODEBLOCK_WAS_RECOMPILED | CODEBLOCK_TRACE | CODEBLOCK_BYTE_MASK)) == CODEBLOCK_WAS_RECOMPILED) &&
+        (++block->trace_hits >= CODEGEN_TRACE_THRESHOLD))
+        codegen_block_promote_trace(block);
+
     if (valid_block && (block->flags & CODEBLOCK_WAS_RECOMPILED))
 #    else
     if (valid_block && block->was_recompiled)
@@ -579,6 +649,19 @@ exec386_dynarec_dyn(void)
 
 #    ifndef USE_NEW_DYNAREC
         codeblock_hash[hash] = block;
+#    endif
+#    ifdef USE_NEW_DYNAREC
+#        ifdef CODEGEN_CHAIN
+        /* The previous block left through a chained exit to this one, link
+           them so it can come straight here next time. */
+        if (chain_exit)
+            codegen_block_chain_link(chain_exit, block);
+        codegen_chain_tsc = (uint32_t) tsc + cycles;
+#        endif
+#        ifdef USE_DYNAREC_STATS
+        CODEGEN_STAT_INC(executions);
+        block->exec_count++;
+#        endif
 #    endif
         inrecomp = 1;
         code();
@@ -607,6 +690,7 @@ exec386_dynarec_dyn(void)
             pthread_jit_write_protect_np(0);
         }
 #    endif
+        PROF_ENTER(&prof_compile);
         codegen_block_start_recompile(block);
         codegen_in_recompile = 1;
 
@@ -641,6 +725,14 @@ exec386_dynarec_dyn(void)
 
                 if (x86_was_reset)
                     break;
+
+#    ifdef USE_NEW_DYNAREC
+                /* Direct jump followed into a trace, keep compiling at the target. */
+                if (cpu_block_end && !cpu_state.abrt && codegen_trace_continue()) {
+                    cpu_block_end = 0;
+                    start_pc      = cs + cpu_state.pc;
+                }
+#    endif
             }
 
 #    ifndef USE_NEW_DYNAREC
@@ -659,6 +751,11 @@ exec386_dynarec_dyn(void)
 #    endif
                 CPU_BLOCK_END();
 
+#    ifdef USE_NEW_DYNAREC
+            if (codegen_trace_page_end(block))
+                CPU_BLOCK_END();
+#    endif
+
             if (cpu_init)
                 CPU_BLOCK_END();
 
@@ -695,6 +792,7 @@ exec386_dynarec_dyn(void)
             codegen_reset();
 
         codegen_in_recompile = 0;
+        PROF_LEAVE();
 #    if defined(__APPLE__) && defined(__aarch64__)
         if (__builtin_available(macOS 11.0, *)) {
             pthread_jit_write_protect_np(1);
@@ -841,6 +939,12 @@ exec386_dynarec(int32_t cycs)
             tsc_old          = tsc;
             if ((!CACHE_ON()) || cpu_override_dynarec) /*Interpret block*/
             {
+#    if defined(USE_NEW_DYNAREC) && defined(USE_DYNAREC_STATS)
+                CODEGEN_STAT_INC(interpreter_fallbacks);
+#    endif
+#    ifdef CODEGEN_CHAIN
+                codegen_chain_exit = 0;
+#    endif
                 exec386_dynarec_int();
             } else {
                 exec386_dynarec_dyn();
@@ -52,6 +52,18 @@
 extern void codegen_init(void);
 extern void codegen_flush(void);
 
+#ifdef USE_NEW_DYNAREC
+/*Load and save the persistent block hint cache, see codegen_cache.h*/
+extern void codegen_cache_load(void);
+extern void codegen_cache_save(void);
+#endif
+
+#if defined(USE_NEW_DYNAREC) && defined(USE_DYNAREC_STATS)
+/*Print block cache counters and the hottest resident blocks to the log*/
+extern void codegen_stats_dump(void);
+extern void codegen_stats_reset(void);
+#endif
+
 /*Current physical page of block being recompiled. -1 if no recompilation taking place */
 extern uint32_t recomp_page;
 extern int      codegen_in_recompile;
@@ -284,6 +284,7 @@ uint8_t  _cache[2048];
 
 uint64_t cpu_CR4_mask;
 uint64_t tsc = 0;
+uint64_t cpu_idle_tsc = 0;
 
 double cpu_dmulti;
 double cpu_busspeed;
@@ -371,6 +372,45 @@ cpu_dynamic_switch(int new_cpu)
     cpu = c;
 }
 
+/* Return the number of cycles a halted or polling CPU should burn: at least
+   min, or, with idle skipping enabled, enough to reach the next timer, as
+   nothing the guest can observe changes before that. The cycles still count
+   towards the time of the current cpu_exec() call, so the main loop sleeps
+   through them as it would for any other emulated time. */
+int32_t
+cpu_idle_cycles(int32_t min)
+{
+    int32_t skip  = min;
+    int32_t limit = cycles;
+
+    if (cpu_idle_skip && (cpu_exec != execx86)) {
+#ifdef USE_DYNAREC
+        if (cpu_exec == exec386_dynarec) {
+            /* The dynarec only adds the cycles of a block to the TSC at the
+               end of it, and runs the call in slices. */
+            update_tsc();
+            limit = cycles_main;
+
+            /* That can have run timers that raised an interrupt, which the
+               caller only looks at after we return; do not skip past it. */
+            if (((cpu_state.flags & I_FLAG) && pic.int_pending) || nmi || smi_line) {
+                cpu_idle_tsc += min;
+                return min;
+            }
+        }
+#endif
+        skip = (int32_t) (timer_target - (uint32_t) tsc) + 1;
+        if (skip > limit)
+            skip = limit;
+        if (skip < min)
+            skip = min;
+    }
+
+    cpu_idle_tsc += skip;
+
+    return skip;
+}
+
 void
 cpu_set_edx(void)
 {
@@ -637,6 +637,7 @@ extern uint32_t cpu_cur_status;
 #endif
 extern uint64_t cpu_CR4_mask;
 extern uint64_t tsc;
+extern uint64_t cpu_idle_tsc;
 extern msr_t    msr;
 extern uint8_t  opcode;
 extern int      cpl_override;
@@ -801,6 +802,7 @@ extern int  checkio(uint32_t port, int mask);
 extern void codegen_block_end(void);
 extern void codegen_reset(void);
 extern void cpu_set_edx(void);
+extern int32_t cpu_idle_cycles(int32_t min);
 extern int  divl(uint32_t val);
 extern void execx86(int32_t cycs);
 extern void enter_smm(int in_hlt);
@@ -55,6 +55,7 @@
 #include <86box/mem.h>
 #include <86box/plat.h>
 #include <86box/rom.h>
+#include <86box/savestate.h>
 #include <86box/sound.h>
 #include <86box/ui.h>
 
@@ -357,6 +358,49 @@ device_reset_all(uint32_t match_flags)
 #endif
 }
 
+/* Returns the number of devices that can not be saved, logging their names. */
+int
+device_check_state(void)
+{
+    int ret = 0;
+
+    for (uint16_t c = 0; c < DEVICE_MAX; c++) {
+        if ((devices[c] != NULL) && ((devices[c]->save == NULL) || (devices[c]->load == NULL))) {
+            pclog("Device \"%s\" does not support save states\n", devices[c]->name);
+            ret++;
+        }
+    }
+
+    return ret;
+}
+
+void
+device_save_state(savestate_t *state)
+{
+    for (uint16_t c = 0; c < DEVICE_MAX; c++) {
+        if ((devices[c] != NULL) && (devices[c]->save != NULL)) {
+            savestate_section(state, devices[c]->internal_name);
+            devices[c]->save(device_priv[c], state);
+            savestate_section_end(state);
+        }
+    }
+}
+
+void
+device_load_state(savestate_t *state)
+{
+    for (uint16_t c = 0; c < DEVICE_MAX; c++) {
+        if ((devices[c] != NULL) && (devices[c]->load != NULL)) {
+            if (!savestate_section(state, devices[c]->internal_name)) {
+                pclog("Save state has no state for device \"%s\"\n", devices[c]->name);
+                return;
+            }
+            devices[c]->load(device_priv[c], state);
+            savestate_section_end(state);
+        }
+    }
+}
+
 void *
 device_find_first_priv(uint32_t match_flags)
 {
@@ -387,6 +431,20 @@ device_get_priv(const device_t *dev)
     return (NULL);
 }
 
+const device_t *
+device_get_by_priv(void *priv)
+{
+    if (priv == NULL)
+        return (NULL);
+
+    for (uint16_t c = 0; c < DEVICE_MAX; c++) {
+        if ((devices[c] != NULL) && (device_priv[c] == priv))
+            return (devices[c]);
+    }
+
+    return (NULL);
+}
+
 int
 device_available(const device_t *dev)
 {
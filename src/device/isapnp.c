@@ -17,6 +17,7 @@
  *          Copyright 2021 RichardG.
  */
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -26,6 +27,7 @@
 #include <86box/device.h>
 #include <86box/io.h>
 #include <86box/isapnp.h>
+#include <86box/savestate.h>
 #include <86box/plat_unused.h>
 
 #define CHECK_CURRENT_LD()                                  \
@@ -716,6 +718,76 @@ isapnp_close(void *priv)
     free(dev);
 }
 
+/* Store a card pointer as its position on the list, -1 being none. */
+static void
+isapnp_card_ref_state(isapnp_t *dev, isapnp_card_t **card, savestate_t *state)
+{
+    isapnp_card_t *c   = dev->first_card;
+    int            idx = -1;
+
+    for (int i = 0; c != NULL; i++, c = c->next) {
+        if (c == *card)
+            idx = i;
+    }
+
+    SAVESTATE_VAR(state, idx);
+
+    if (savestate_is_loading(state)) {
+        *card = (idx < 0) ? NULL : dev->first_card;
+        while ((*card != NULL) && (idx-- > 0))
+            *card = (*card)->next;
+    }
+}
+
+/* The isolation state and every logical device's registers; the cards are
+   then told their configuration again, so their resources follow. */
+static void
+isapnp_state(void *priv, savestate_t *state)
+{
+    isapnp_t        *dev  = (isapnp_t *) priv;
+    isapnp_card_t   *card;
+    isapnp_device_t *ld;
+    uint16_t         read_data_addr = dev->read_data_addr;
+    uint8_t          key_pos        = dev->key_pos;
+    int              ldn            = (dev->current_ld != NULL) ? dev->current_ld->number : -1;
+
+    SAVESTATE_VAR(state, dev->in_isolation);
+    SAVESTATE_VAR(state, dev->reg);
+    SAVESTATE_VAR(state, key_pos);
+    SAVESTATE_VAR(state, read_data_addr);
+    SAVESTATE_VAR(state, ldn);
+    isapnp_card_ref_state(dev, &dev->isolated_card, state);
+    isapnp_card_ref_state(dev, &dev->current_ld_card, state);
+
+    for (card = dev->first_card; card != NULL; card = card->next) {
+        savestate_var(state, card, offsetof(isapnp_card_t, rom));
+        SAVESTATE_VAR(state, card->rom_pos);
+        for (ld = card->first_ld; ld != NULL; ld = ld->next)
+            SAVESTATE_VAR(state, ld->regs);
+    }
+
+    if (savestate_is_loading(state)) {
+        dev->key_pos = key_pos;
+        if (read_data_addr != dev->read_data_addr)
+            isapnp_set_read_data(read_data_addr, dev);
+
+        dev->current_ld = NULL;
+        if (dev->current_ld_card != NULL) {
+            for (ld = dev->current_ld_card->first_ld; ld != NULL; ld = ld->next) {
+                if (ld->number == ldn)
+                    dev->current_ld = ld;
+            }
+        }
+
+        for (card = dev->first_card; card != NULL; card = card->next) {
+            if (card->csn_changed)
+                card->csn_changed(card->csn, card->priv);
+            for (ld = card->first_ld; ld != NULL; ld = ld->next)
+                isapnp_device_config_changed(card, ld);
+        }
+    }
+}
+
 void *
 isapnp_add_card(uint8_t *rom, uint16_t rom_size,
                 void (*config_changed)(uint8_t ld, isapnp_device_config_t *config, void *priv),
@@ -1233,5 +1305,7 @@ static const device_t isapnp_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = isapnp_state,
+    .load          = isapnp_state
 };
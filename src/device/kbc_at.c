@@ -17,6 +17,7 @@
  *          Copyright 2023 EngiNerd.
  */
 #include <stdio.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -43,6 +44,7 @@
 #include <86box/snd_speaker.h>
 #include <86box/video.h>
 #include <86box/keyboard.h>
+#include <86box/savestate.h>
 
 #include <86box/dma.h>
 #include <86box/pci.h>
@@ -2256,6 +2258,20 @@ kbc_at_reset(void *priv)
     dev->status = (dev->status & 0x0f) | (dev->p1 & 0xf0);
 }
 
+/* The registers, the controller RAM and the output queue, all of which come
+   before the flags; the ports are saved along with the devices on them. */
+static void
+kbc_at_state(void *priv, savestate_t *state)
+{
+    atkbc_t *dev = (atkbc_t *) priv;
+
+    savestate_var(state, &dev->state, offsetof(atkbc_t, flags) - offsetof(atkbc_t, state));
+    savestate_timer(state, &dev->kbc_poll_timer);
+    savestate_timer(state, &dev->kbc_dev_poll_timer);
+    savestate_timer(state, &dev->pulse_cb);
+    SAVESTATE_VAR(state, fast_reset);
+}
+
 static void
 kbc_at_close(void *priv)
 {
@@ -2438,7 +2454,9 @@ const device_t keyboard_at_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_at_siemens_device = {
@@ -2452,7 +2470,9 @@ const device_t keyboard_at_siemens_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_at_ami_device = {
@@ -2466,7 +2486,9 @@ const device_t keyboard_at_ami_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_at_tg_ami_device = {
@@ -2480,7 +2502,9 @@ const device_t keyboard_at_tg_ami_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_at_toshiba_device = {
@@ -2494,7 +2518,9 @@ const device_t keyboard_at_toshiba_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_at_olivetti_device = {
@@ -2508,7 +2534,9 @@ const device_t keyboard_at_olivetti_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_at_ncr_device = {
@@ -2522,7 +2550,9 @@ const device_t keyboard_at_ncr_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_at_compaq_device = {
@@ -2536,7 +2566,9 @@ const device_t keyboard_at_compaq_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_at_phoenix_device = {
@@ -2550,7 +2582,9 @@ const device_t keyboard_at_phoenix_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_device = {
@@ -2564,7 +2598,9 @@ const device_t keyboard_ps2_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_ps1_device = {
@@ -2578,7 +2614,9 @@ const device_t keyboard_ps2_ps1_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_ps1_pci_device = {
@@ -2592,7 +2630,9 @@ const device_t keyboard_ps2_ps1_pci_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_xi8088_device = {
@@ -2606,7 +2646,9 @@ const device_t keyboard_ps2_xi8088_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_ami_device = {
@@ -2620,7 +2662,9 @@ const device_t keyboard_ps2_ami_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_compaq_device = {
@@ -2634,7 +2678,9 @@ const device_t keyboard_ps2_compaq_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_holtek_device = {
@@ -2648,7 +2694,9 @@ const device_t keyboard_ps2_holtek_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_phoenix_device = {
@@ -2662,7 +2710,9 @@ const device_t keyboard_ps2_phoenix_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_tg_ami_device = {
@@ -2676,7 +2726,9 @@ const device_t keyboard_ps2_tg_ami_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_mca_1_device = {
@@ -2690,7 +2742,9 @@ const device_t keyboard_ps2_mca_1_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_mca_2_device = {
@@ -2704,7 +2758,9 @@ const device_t keyboard_ps2_mca_2_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_quadtel_device = {
@@ -2718,7 +2774,9 @@ const device_t keyboard_ps2_quadtel_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_pci_device = {
@@ -2732,7 +2790,9 @@ const device_t keyboard_ps2_pci_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_ami_pci_device = {
@@ -2746,7 +2806,9 @@ const device_t keyboard_ps2_ami_pci_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_ali_pci_device = {
@@ -2760,7 +2822,9 @@ const device_t keyboard_ps2_ali_pci_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_intel_ami_pci_device = {
@@ -2774,7 +2838,9 @@ const device_t keyboard_ps2_intel_ami_pci_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_tg_ami_pci_device = {
@@ -2788,7 +2854,9 @@ const device_t keyboard_ps2_tg_ami_pci_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_acer_pci_device = {
@@ -2802,7 +2870,9 @@ const device_t keyboard_ps2_acer_pci_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
 
 const device_t keyboard_ps2_phoenix_pci_device = {
@@ -2816,5 +2886,7 @@ const device_t keyboard_ps2_phoenix_pci_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = kbc_at_state,
+    .load          = kbc_at_state
 };
@@ -38,6 +38,7 @@
 #include <86box/snd_speaker.h>
 #include <86box/video.h>
 #include <86box/keyboard.h>
+#include <86box/savestate.h>
 #include <86box/plat_fallthrough.h>
 
 #ifdef ENABLE_KBC_AT_DEV_LOG
@@ -195,6 +196,36 @@ kbc_at_dev_reset(atkbc_dev_t *dev, int do_fa)
         dev->state = DEV_STATE_EXECUTE_BAT;
 }
 
+/* The state common to the keyboard and the mouse, with that of their port. */
+void
+kbc_at_dev_state(atkbc_dev_t *dev, savestate_t *state)
+{
+    SAVESTATE_VAR(state, dev->command);
+    SAVESTATE_VAR(state, dev->last_scan_code);
+    SAVESTATE_VAR(state, dev->state);
+    SAVESTATE_VAR(state, dev->resolution);
+    SAVESTATE_VAR(state, dev->rate);
+    SAVESTATE_VAR(state, dev->cmd_queue_start);
+    SAVESTATE_VAR(state, dev->cmd_queue_end);
+    SAVESTATE_VAR(state, dev->queue_start);
+    SAVESTATE_VAR(state, dev->queue_end);
+    SAVESTATE_VAR(state, dev->cmd_queue);
+    SAVESTATE_VAR(state, dev->queue);
+    SAVESTATE_VAR(state, dev->mode);
+    SAVESTATE_VAR(state, dev->x);
+    SAVESTATE_VAR(state, dev->y);
+    SAVESTATE_VAR(state, dev->z);
+    SAVESTATE_VAR(state, dev->b);
+    SAVESTATE_VAR(state, dev->ignore);
+    savestate_var(state, dev->scan, sizeof(int));
+
+    if (dev->port != NULL) {
+        SAVESTATE_VAR(state, dev->port->wantcmd);
+        SAVESTATE_VAR(state, dev->port->dat);
+        SAVESTATE_VAR(state, dev->port->out_new);
+    }
+}
+
 atkbc_dev_t *
 kbc_at_dev_init(uint8_t inst)
 {
@@ -29,6 +29,7 @@
 #include <86box/machine.h>
 #include <86box/keyboard.h>
 #include <86box/plat.h>
+#include <86box/replay.h>
 
 #include "cpu.h"
 
@@ -235,6 +236,16 @@ key_process(uint16_t scan, int down)
 /* Handle a keystroke event from the UI layer. */
 void
 keyboard_input(int down, uint16_t scan)
+{
+    /* While a replay log is active, keystrokes reach the machine through it. */
+    if (replay_queue_key(down, scan))
+        return;
+
+    keyboard_input_deliver(down, scan);
+}
+
+void
+keyboard_input_deliver(int down, uint16_t scan)
 {
     /* Special case for E1 1D, translate it to 0100 - special case. */
     if ((scan >> 8) == 0xe1) {
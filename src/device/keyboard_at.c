@@ -26,6 +26,7 @@
 #include <86box/keyboard.h>
 #include <86box/mouse.h>
 #include <86box/machine.h>
+#include <86box/savestate.h>
 
 #define FLAG_PS2       0x08  /* dev is AT or PS/2 */
 #define FLAG_AT        0x00  /* dev is AT or PS/2 */
@@ -3774,6 +3775,20 @@ keyboard_at_init(const device_t *info)
     return dev;
 }
 
+static void
+keyboard_at_state(void *priv, savestate_t *state)
+{
+    atkbc_dev_t *dev = (atkbc_dev_t *) priv;
+
+    kbc_at_dev_state(dev, state);
+
+    SAVESTATE_VAR(state, keyboard_set3_flags);
+    SAVESTATE_VAR(state, keyboard_set3_all_repeat);
+    SAVESTATE_VAR(state, keyboard_set3_all_break);
+    SAVESTATE_VAR(state, keyboard_mode);
+    SAVESTATE_VAR(state, bat_counter);
+}
+
 static void
 keyboard_at_close(void *priv)
 {
@@ -3830,5 +3845,7 @@ const device_t keyboard_at_generic_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = keyboard_at_config
+    .config        = keyboard_at_config,
+    .save          = keyboard_at_state,
+    .load          = keyboard_at_state
 };
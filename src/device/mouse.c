@@ -35,6 +35,7 @@
 #include <86box/video.h>
 #include <86box/plat.h>
 #include <86box/plat_unused.h>
+#include <86box/replay.h>
 
 typedef struct mouse_t {
     const device_t *device;
@@ -110,6 +111,14 @@ static atomic_int      mouse_z;
 static atomic_int      mouse_w;
 static atomic_int      mouse_buttons;
 
+/* Host input is staged here while a replay log is active, and only moved to
+   the state above through the log, from the emulation thread. */
+static _Atomic double  mouse_host_x;
+static _Atomic double  mouse_host_y;
+static atomic_int      mouse_host_z;
+static atomic_int      mouse_host_w;
+static atomic_int      mouse_host_buttons;
+
 static int             mouse_delta_b;
 static int             mouse_old_b;
 
@@ -431,25 +440,25 @@ atomic_double_add(_Atomic double *var, double val)
 void
 mouse_scale_fx(double x)
 {
-    atomic_double_add(&mouse_x, ((double) x) * mouse_sensitivity);
+    atomic_double_add(replay_mode ? &mouse_host_x : &mouse_x, ((double) x) * mouse_sensitivity);
 }
 
 void
 mouse_scale_fy(double y)
 {
-    atomic_double_add(&mouse_y, ((double) y) * mouse_sensitivity);
+    atomic_double_add(replay_mode ? &mouse_host_y : &mouse_y, ((double) y) * mouse_sensitivity);
 }
 
 void
 mouse_scale_x(int x)
 {
-    atomic_double_add(&mouse_x, ((double) x) * mouse_sensitivity);
+    atomic_double_add(replay_mode ? &mouse_host_x : &mouse_x, ((double) x) * mouse_sensitivity);
 }
 
 void
 mouse_scale_y(int y)
 {
-    atomic_double_add(&mouse_y, ((double) y) * mouse_sensitivity);
+    atomic_double_add(replay_mode ? &mouse_host_y : &mouse_y, ((double) y) * mouse_sensitivity);
 }
 
 void
@@ -478,7 +487,7 @@ mouse_scale_axis(int axis, int val)
 void
 mouse_set_z(int z)
 {
-    atomic_fetch_add(&mouse_z, z);
+    atomic_fetch_add(replay_mode ? &mouse_host_z : &mouse_z, z);
 }
 
 void
@@ -490,7 +499,7 @@ mouse_clear_z(void)
 void
 mouse_set_w(int w)
 {
-    atomic_fetch_add(&mouse_w, w);
+    atomic_fetch_add(replay_mode ? &mouse_host_w : &mouse_w, w);
 }
 
 void
@@ -542,7 +551,7 @@ mouse_subtract_w(int *delta_w, int min, int max, int invert)
 void
 mouse_set_buttons_ex(int b)
 {
-    atomic_store(&mouse_buttons, b);
+    atomic_store(replay_mode ? &mouse_host_buttons : &mouse_buttons, b);
 }
 
 int
@@ -577,9 +586,32 @@ mouse_get_abs_coords(double *x_abs, double *y_abs)
     *y_abs = mouse_y_abs;
 }
 
+static void
+mouse_replay(void)
+{
+    replay_mouse_t mouse;
+
+    mouse.x       = atomic_exchange(&mouse_host_x, 0.0);
+    mouse.y       = atomic_exchange(&mouse_host_y, 0.0);
+    mouse.z       = atomic_exchange(&mouse_host_z, 0);
+    mouse.w       = atomic_exchange(&mouse_host_w, 0);
+    mouse.buttons = atomic_load(&mouse_host_buttons);
+
+    if (replay_mouse(&mouse)) {
+        atomic_double_add(&mouse_x, mouse.x);
+        atomic_double_add(&mouse_y, mouse.y);
+        atomic_fetch_add(&mouse_z, mouse.z);
+        atomic_fetch_add(&mouse_w, mouse.w);
+        atomic_store(&mouse_buttons, mouse.buttons);
+    }
+}
+
 void
 mouse_process(void)
 {
+    if (replay_mode)
+        mouse_replay();
+
     if ((mouse_input_mode >= 1) && mouse_poll_ex)
         mouse_poll_ex();
     else if ((mouse_input_mode == 0) && (mouse_dev_poll != NULL))
@@ -19,6 +19,7 @@
  *          Copyright 2017-2020 Fred N. van Kempen.
  */
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -37,6 +38,7 @@
 #include <86box/fifo.h>
 #include <86box/serial.h>
 #include <86box/mouse.h>
+#include <86box/savestate.h>
 
 serial_port_t com_ports[SERIAL_MAX];
 
@@ -879,6 +881,35 @@ serial_speed_changed(void *priv)
     serial_update_speed(dev);
 }
 
+/* The registers and FIFO's of an enabled port. A Super I/O chip may have
+   moved it since the machine was started, so the I/O handler follows the
+   restored base address. */
+static void
+serial_state(void *priv, savestate_t *state)
+{
+    serial_t *dev  = (serial_t *) priv;
+    uint16_t  base = dev->base_address;
+
+    if (dev->sd == NULL)
+        return;
+
+    savestate_var(state, dev, offsetof(serial_t, rcvr_fifo));
+    fifo_state(dev->rcvr_fifo, state);
+    fifo_state(dev->xmit_fifo, state);
+    savestate_timer(state, &dev->transmit_timer);
+    savestate_timer(state, &dev->timeout_timer);
+    savestate_timer(state, &dev->receive_timer);
+    SAVESTATE_VAR(state, dev->clock_src);
+    SAVESTATE_VAR(state, dev->transmit_period);
+
+    if (savestate_is_loading(state) && (dev->base_address != base)) {
+        uint16_t addr = dev->base_address;
+
+        dev->base_address = base;
+        serial_setup(dev, addr, dev->irq);
+    }
+}
+
 static void
 serial_close(void *priv)
 {
@@ -1024,7 +1055,9 @@ const device_t ns8250_device = {
     .available     = NULL,
     .speed_changed = serial_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = serial_state,
+    .load          = serial_state
 };
 
 const device_t ns8250_pcjr_device = {
@@ -1038,7 +1071,9 @@ const device_t ns8250_pcjr_device = {
     .available     = NULL,
     .speed_changed = serial_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = serial_state,
+    .load          = serial_state
 };
 
 const device_t ns16450_device = {
@@ -1052,7 +1087,9 @@ const device_t ns16450_device = {
     .available     = NULL,
     .speed_changed = serial_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = serial_state,
+    .load          = serial_state
 };
 
 const device_t ns16550_device = {
@@ -1066,7 +1103,9 @@ const device_t ns16550_device = {
     .available     = NULL,
     .speed_changed = serial_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = serial_state,
+    .load          = serial_state
 };
 
 const device_t ns16650_device = {
@@ -1080,7 +1119,9 @@ const device_t ns16650_device = {
     .available     = NULL,
     .speed_changed = serial_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = serial_state,
+    .load          = serial_state
 };
 
 const device_t ns16750_device = {
@@ -1094,7 +1135,9 @@ const device_t ns16750_device = {
     .available     = NULL,
     .speed_changed = serial_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = serial_state,
+    .load          = serial_state
 };
 
 const device_t ns16850_device = {
@@ -1108,7 +1151,9 @@ const device_t ns16850_device = {
     .available     = NULL,
     .speed_changed = serial_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = serial_state,
+    .load          = serial_state
 };
 
 const device_t ns16950_device = {
@@ -1122,5 +1167,7 @@ const device_t ns16950_device = {
     .available     = NULL,
     .speed_changed = serial_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = serial_state,
+    .load          = serial_state
 };
@@ -19,6 +19,7 @@
  */
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -47,6 +48,7 @@
 #include <86box/hdc_ide.h>
 #include <86box/hdd.h>
 #include <86box/zip.h>
+#include <86box/savestate.h>
 #include <86box/version.h>
 
 /* Bits of 'atastat' */
@@ -3147,6 +3149,108 @@ ide_set_bus_master(int board,
     bm->priv    = priv;
 }
 
+/* The registers and buffers of a drive. ATAPI devices keep the packet data in
+   a buffer of their own, so they are only saved between commands. */
+static void
+ide_drive_state(ide_t *ide, savestate_t *state)
+{
+    scsi_common_t *sc = ide->sc;
+
+    if (((ide->type & ~IDE_SHADOW) == IDE_ATAPI) && !savestate_is_loading(state) &&
+        (ide->tf->atastat & (BSY_STAT | DRQ_STAT))) {
+        pclog("Save state: ATAPI device on IDE channel %i is busy\n", ide->channel);
+        savestate_set_error(state);
+        return;
+    }
+
+    savestate_var(state, ide, offsetof(ide_t, buffer));
+    savestate_var(state, ide->tf, sizeof(ide_tf_t));
+    savestate_timer(state, &ide->timer);
+    SAVESTATE_VAR(state, ide->interrupt_drq);
+    SAVESTATE_VAR(state, ide->pending_delay);
+
+    if (ide->buffer != NULL)
+        savestate_block(state, ide->buffer, 65536 * sizeof(uint16_t));
+    if (ide->sector_buffer != NULL)
+        savestate_block(state, ide->sector_buffer, 256 * 512);
+
+    if ((ide->type == IDE_ATAPI) && (sc != NULL)) {
+        SAVESTATE_VAR(state, sc->ms_pages_saved);
+        savestate_var(state, sc->atapi_cdb,
+                      offsetof(scsi_common_t, ven_cmd) - offsetof(scsi_common_t, atapi_cdb));
+    }
+}
+
+/* The board registers, then both drives on it. A PCI or PnP controller may
+   have been moved since the machine was started, in which case the I/O
+   handlers follow the restored base addresses. */
+static void
+ide_board_state(int board, savestate_t *state)
+{
+    ide_board_t *dev = ide_boards[board];
+    uint16_t     base[2];
+
+    if ((dev == NULL) || !dev->inited)
+        return;
+
+    base[0] = dev->base[0];
+    base[1] = dev->base[1];
+
+    savestate_var(state, dev, offsetof(ide_board_t, timer));
+    savestate_timer(state, &dev->timer);
+
+    if (savestate_is_loading(state) && ((dev->base[0] != base[0]) || (dev->base[1] != base[1]))) {
+        uint16_t new_base[2] = { dev->base[0], dev->base[1] };
+
+        dev->base[0] = base[0];
+        dev->base[1] = base[1];
+        if (base[0] || base[1])
+            ide_remove_handlers(board);
+
+        dev->base[0] = new_base[0];
+        dev->base[1] = new_base[1];
+        if (dev->base[0] && dev->base[1])
+            ide_set_handlers(board);
+    }
+
+    for (int d = (board << 1); d < ((board << 1) + 2); d++) {
+        if (ide_drives[d] != NULL)
+            ide_drive_state(ide_drives[d], state);
+    }
+}
+
+static void
+ide_state(UNUSED(void *priv), savestate_t *state)
+{
+    ide_board_state(0, state);
+    ide_board_state(1, state);
+}
+
+static void
+ide_sec_state(UNUSED(void *priv), savestate_t *state)
+{
+    ide_board_state(1, state);
+}
+
+static void
+ide_ter_state(UNUSED(void *priv), savestate_t *state)
+{
+    ide_board_state(2, state);
+}
+
+static void
+ide_qua_state(UNUSED(void *priv), savestate_t *state)
+{
+    ide_board_state(3, state);
+}
+
+static void
+ide_ter_qua_state(UNUSED(void *priv), savestate_t *state)
+{
+    ide_board_state(2, state);
+    ide_board_state(3, state);
+}
+
 static void *
 ide_init(const device_t *info)
 {
@@ -3429,7 +3533,9 @@ const device_t ide_isa_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_state,
+    .load          = ide_state
 };
 
 const device_t ide_isa_sec_device = {
@@ -3443,7 +3549,9 @@ const device_t ide_isa_sec_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_sec_state,
+    .load          = ide_sec_state
 };
 
 const device_t ide_isa_2ch_device = {
@@ -3457,7 +3565,9 @@ const device_t ide_isa_2ch_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_state,
+    .load          = ide_state
 };
 
 const device_t ide_vlb_device = {
@@ -3471,7 +3581,9 @@ const device_t ide_vlb_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_state,
+    .load          = ide_state
 };
 
 const device_t ide_vlb_sec_device = {
@@ -3485,7 +3597,9 @@ const device_t ide_vlb_sec_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_sec_state,
+    .load          = ide_sec_state
 };
 
 const device_t ide_vlb_2ch_device = {
@@ -3499,7 +3613,9 @@ const device_t ide_vlb_2ch_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_state,
+    .load          = ide_state
 };
 
 const device_t ide_pci_device = {
@@ -3513,7 +3629,9 @@ const device_t ide_pci_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_state,
+    .load          = ide_state
 };
 
 const device_t ide_pci_sec_device = {
@@ -3527,7 +3645,9 @@ const device_t ide_pci_sec_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_sec_state,
+    .load          = ide_sec_state
 };
 
 const device_t ide_pci_2ch_device = {
@@ -3541,7 +3661,9 @@ const device_t ide_pci_2ch_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_state,
+    .load          = ide_state
 };
 
 const device_t mcide_device = {
@@ -3625,7 +3747,9 @@ const device_t ide_ter_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = ide_ter_config
+    .config        = ide_ter_config,
+    .save          = ide_ter_state,
+    .load          = ide_ter_state
 };
 
 const device_t ide_ter_pnp_device = {
@@ -3639,7 +3763,9 @@ const device_t ide_ter_pnp_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_ter_state,
+    .load          = ide_ter_state
 };
 
 const device_t ide_qua_device = {
@@ -3653,7 +3779,9 @@ const device_t ide_qua_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = ide_qua_config
+    .config        = ide_qua_config,
+    .save          = ide_qua_state,
+    .load          = ide_qua_state
 };
 
 const device_t ide_qua_pnp_device = {
@@ -3667,7 +3795,9 @@ const device_t ide_qua_pnp_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_qua_state,
+    .load          = ide_qua_state
 };
 
 const device_t ide_pci_ter_qua_2ch_device = {
@@ -3681,5 +3811,7 @@ const device_t ide_pci_ter_qua_2ch_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = ide_ter_qua_state,
+    .load          = ide_ter_qua_state
 };
@@ -33,6 +33,7 @@
 #include <86box/86box.h>
 #include <86box/path.h>
 #include <86box/plat.h>
+#include <86box/prof.h>
 #include <86box/random.h>
 #include <86box/hdd.h>
 #include "minivhd/minivhd.h"
@@ -525,8 +526,8 @@ hdd_image_seek(uint8_t id, uint32_t sector)
     return 0;
 }
 
-int
-hdd_image_read(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
+static int
+hdd_image_do_read(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
 {
     int    non_transferred_sectors;
     size_t num_read;
@@ -552,6 +553,18 @@ hdd_image_read(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
     return 0;
 }
 
+int
+hdd_image_read(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
+{
+    int ret;
+
+    PROF_ENTER(&prof_disk);
+    ret = hdd_image_do_read(id, sector, count, buffer);
+    PROF_LEAVE();
+
+    return ret;
+}
+
 uint32_t
 hdd_image_get_last_sector(uint8_t id)
 {
@@ -581,8 +594,8 @@ hdd_image_read_ex(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
     return 0;
 }
 
-int
-hdd_image_write(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
+static int
+hdd_image_do_write(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
 {
     int    non_transferred_sectors;
     size_t num_write;
@@ -609,6 +622,18 @@ hdd_image_write(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
     return 0;
 }
 
+int
+hdd_image_write(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
+{
+    int ret;
+
+    PROF_ENTER(&prof_disk);
+    ret = hdd_image_do_write(id, sector, count, buffer);
+    PROF_LEAVE();
+
+    return ret;
+}
+
 int
 hdd_image_write_ex(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
 {
@@ -626,8 +651,8 @@ hdd_image_write_ex(uint8_t id, uint32_t sector, uint32_t count, uint8_t *buffer)
     return 0;
 }
 
-int
-hdd_image_zero(uint8_t id, uint32_t sector, uint32_t count)
+static int
+hdd_image_do_zero(uint8_t id, uint32_t sector, uint32_t count)
 {
     if (hdd_images[id].type == HDD_IMAGE_VHD) {
         hdd_images[id].vhd->error   = 0;
@@ -658,6 +683,18 @@ hdd_image_zero(uint8_t id, uint32_t sector, uint32_t count)
     return 0;
 }
 
+int
+hdd_image_zero(uint8_t id, uint32_t sector, uint32_t count)
+{
+    int ret;
+
+    PROF_ENTER(&prof_disk);
+    ret = hdd_image_do_zero(id, sector, count);
+    PROF_LEAVE();
+
+    return ret;
+}
+
 int
 hdd_image_zero_ex(uint8_t id, uint32_t sector, uint32_t count)
 {
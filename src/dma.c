@@ -33,6 +33,7 @@
 #include <86box/io.h>
 #include <86box/pic.h>
 #include <86box/dma.h>
+#include <86box/savestate.h>
 #include <86box/plat_unused.h>
 
 dma_t   dma[8];
@@ -1154,6 +1155,42 @@ dma_reset(void)
     dma_at = is286;
 }
 
+void
+dma_save_state(savestate_t *state)
+{
+    savestate_write_var(state, dma);
+    savestate_write_var(state, dma_e);
+    savestate_write_var(state, dma_m);
+    savestate_write_var(state, dmaregs);
+    savestate_write_var(state, dma_wp);
+    savestate_write_var(state, dma_stat);
+    savestate_write_var(state, dma_stat_rq);
+    savestate_write_var(state, dma_stat_rq_pc);
+    savestate_write_var(state, dma_stat_adv_pend);
+    savestate_write_var(state, dma_command);
+    savestate_write_var(state, dma_req_is_soft);
+    savestate_write_var(state, dma_mask);
+    savestate_write_var(state, dma_ps2);
+}
+
+void
+dma_load_state(savestate_t *state)
+{
+    savestate_read_var(state, dma);
+    savestate_read_var(state, dma_e);
+    savestate_read_var(state, dma_m);
+    savestate_read_var(state, dmaregs);
+    savestate_read_var(state, dma_wp);
+    savestate_read_var(state, dma_stat);
+    savestate_read_var(state, dma_stat_rq);
+    savestate_read_var(state, dma_stat_rq_pc);
+    savestate_read_var(state, dma_stat_adv_pend);
+    savestate_read_var(state, dma_command);
+    savestate_read_var(state, dma_req_is_soft);
+    savestate_read_var(state, dma_mask);
+    savestate_read_var(state, dma_ps2);
+}
+
 void
 dma_remove_sg(void)
 {
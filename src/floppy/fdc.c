@@ -17,6 +17,7 @@
  *          Copyright 2008-2020 Sarah Walker.
  *          Copyright 2016-2020 Miran Grca.
  */
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -39,6 +40,7 @@
 #include <86box/plat_fallthrough.h>
 #include <86box/plat_unused.h>
 #include <86box/fifo.h>
+#include <86box/savestate.h>
 
 extern uint64_t motoron[FDD_NUM];
 
@@ -2354,6 +2356,25 @@ fdc_reset(void *priv)
     fdc->power_down = 0;
 }
 
+/* The registers, up to the configuration that follows them, and the
+   drives. */
+static void
+fdc_state(void *priv, savestate_t *state)
+{
+    fdc_t *fdc = (fdc_t *) priv;
+
+    savestate_var(state, fdc, offsetof(fdc_t, fifo_p));
+    fifo_state(fdc->fifo_p, state);
+    SAVESTATE_VAR(state, fdc->fifointest);
+    SAVESTATE_VAR(state, fdc->read_track_sector);
+    SAVESTATE_VAR(state, fdc->format_sector_id);
+    SAVESTATE_VAR(state, fdc->watchdog_count);
+    savestate_timer(state, &fdc->timer);
+    savestate_timer(state, &fdc->watchdog_timer);
+
+    fdd_state(state);
+}
+
 static void
 fdc_close(void *priv)
 {
@@ -2434,7 +2455,9 @@ const device_t fdc_xt_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_xt_sec_device = {
@@ -2448,7 +2471,9 @@ const device_t fdc_xt_sec_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_xt_ter_device = {
@@ -2462,7 +2487,9 @@ const device_t fdc_xt_ter_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_xt_qua_device = {
@@ -2476,7 +2503,9 @@ const device_t fdc_xt_qua_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_xt_t1x00_device = {
@@ -2490,7 +2519,9 @@ const device_t fdc_xt_t1x00_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_xt_amstrad_device = {
@@ -2504,7 +2535,9 @@ const device_t fdc_xt_amstrad_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_xt_tandy_device = {
@@ -2518,7 +2551,9 @@ const device_t fdc_xt_tandy_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_xt_umc_um8398_device = {
@@ -2532,7 +2567,9 @@ const device_t fdc_xt_umc_um8398_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_pcjr_device = {
@@ -2546,7 +2583,9 @@ const device_t fdc_pcjr_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_device = {
@@ -2560,7 +2599,9 @@ const device_t fdc_at_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_sec_device = {
@@ -2574,7 +2615,9 @@ const device_t fdc_at_sec_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_ter_device = {
@@ -2588,7 +2631,9 @@ const device_t fdc_at_ter_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_qua_device = {
@@ -2602,7 +2647,9 @@ const device_t fdc_at_qua_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_actlow_device = {
@@ -2616,7 +2663,9 @@ const device_t fdc_at_actlow_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_smc_device = {
@@ -2630,7 +2679,9 @@ const device_t fdc_at_smc_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_ali_device = {
@@ -2644,7 +2695,9 @@ const device_t fdc_at_ali_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_winbond_device = {
@@ -2658,7 +2711,9 @@ const device_t fdc_at_winbond_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_nsc_device = {
@@ -2672,7 +2727,9 @@ const device_t fdc_at_nsc_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_at_nsc_dp8473_device = {
@@ -2686,7 +2743,9 @@ const device_t fdc_at_nsc_dp8473_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_ps2_device = {
@@ -2701,7 +2760,9 @@ const device_t fdc_ps2_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
 
 const device_t fdc_ps2_mca_device = {
@@ -2716,5 +2777,7 @@ const device_t fdc_ps2_mca_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = fdc_state,
+    .load          = fdc_state
 };
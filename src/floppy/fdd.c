@@ -39,6 +39,7 @@
 #include <86box/fdd_mfm.h>
 #include <86box/fdd_td0.h>
 #include <86box/fdc.h>
+#include <86box/savestate.h>
 
 /* Flags:
    Bit  0:  300 rpm supported;
@@ -272,6 +273,32 @@ fdd_seek(int drive, int track_diff)
     fdd_do_seek(drive, fdd[drive].track);
 }
 
+/* The head positions and motors of the drives. The images themselves are
+   host files, and have to be the same ones on restore; the track buffers are
+   refilled from them by seeking to the restored track. */
+void
+fdd_state(savestate_t *state)
+{
+    for (int i = 0; i < FDD_NUM; i++) {
+        if (!savestate_is_loading(state) && d86f_busy(i)) {
+            pclog("Save state: floppy drive %i is in the middle of a transfer\n", i + 1);
+            savestate_set_error(state);
+            return;
+        }
+
+        SAVESTATE_VAR(state, fdd[i].track);
+        SAVESTATE_VAR(state, fdd[i].densel);
+        SAVESTATE_VAR(state, fdd[i].head);
+        SAVESTATE_VAR(state, motoron[i]);
+        SAVESTATE_VAR(state, fdd_changed[i]);
+        savestate_timer(state, &fdd_poll_time[i]);
+
+        if (savestate_is_loading(state) && !drive_empty[i])
+            fdd_do_seek(i, fdd[i].track);
+    }
+    SAVESTATE_VAR(state, curdrive);
+}
+
 int
 fdd_track0(int drive)
 {
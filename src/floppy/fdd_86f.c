@@ -3002,6 +3002,13 @@ d86f_zero_track(int drive)
     }
 }
 
+/* A transfer in progress, which a save state can not capture. */
+int
+d86f_busy(int drive)
+{
+    return (d86f[drive] != NULL) && (d86f[drive]->state != STATE_IDLE);
+}
+
 void
 d86f_seek(int drive, int track)
 {
@@ -30,6 +30,7 @@
 #include <86box/io.h>
 #include <86box/timer.h>
 #include <86box/isapnp.h>
+#include <86box/savestate.h>
 #include <86box/gameport.h>
 #include <86box/plat_unused.h>
 
@@ -453,6 +454,26 @@ tmacm_init(UNUSED(const device_t *info))
     return dev;
 }
 
+/* The port address and the one-shots of the joystick on it; the joystick
+   itself is a host device, and is read again on the next trigger. */
+static void
+gameport_state(void *priv, savestate_t *state)
+{
+    gameport_t          *dev      = (gameport_t *) priv;
+    joystick_instance_t *joystick = dev->joystick;
+    uint16_t             addr     = dev->addr;
+
+    SAVESTATE_VAR(state, addr);
+    if (savestate_is_loading(state) && (addr != dev->addr))
+        gameport_remap(dev, addr);
+
+    if (joystick != NULL) {
+        SAVESTATE_VAR(state, joystick->state);
+        for (uint8_t i = 0; i < 4; i++)
+            savestate_timer(state, &joystick->axis[i].timer);
+    }
+}
+
 static void
 gameport_close(void *priv)
 {
@@ -483,7 +504,9 @@ const device_t gameport_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_201_device = {
@@ -497,7 +520,9 @@ const device_t gameport_201_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_203_device = {
@@ -511,7 +536,9 @@ const device_t gameport_203_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_205_device = {
@@ -525,7 +552,9 @@ const device_t gameport_205_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_207_device = {
@@ -539,7 +568,9 @@ const device_t gameport_207_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_208_device = {
@@ -553,7 +584,9 @@ const device_t gameport_208_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_209_device = {
@@ -567,7 +600,9 @@ const device_t gameport_209_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_20b_device = {
@@ -581,7 +616,9 @@ const device_t gameport_20b_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_20d_device = {
@@ -595,7 +632,9 @@ const device_t gameport_20d_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_20f_device = {
@@ -609,7 +648,9 @@ const device_t gameport_20f_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 static const device_config_t tmacm_config[] = {
@@ -679,7 +720,9 @@ const device_t gameport_pnp_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_pnp_1io_device = {
@@ -693,7 +736,9 @@ const device_t gameport_pnp_1io_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_pnp_6io_device = {
@@ -707,7 +752,9 @@ const device_t gameport_pnp_6io_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_sio_device = {
@@ -721,7 +768,9 @@ const device_t gameport_sio_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 const device_t gameport_sio_1io_device = {
@@ -735,7 +784,9 @@ const device_t gameport_sio_1io_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = gameport_state,
+    .load          = gameport_state
 };
 
 static const GAMEPORT gameports[] = {
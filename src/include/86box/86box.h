@@ -86,6 +86,8 @@ extern "C" {
 /* Global variables. */
 extern int dump_on_exit;        /* (O) dump regs on exit*/
 extern int start_in_fullscreen; /* (O) start in fullscreen */
+extern int headless;            /* (O) no window and no audio output */
+extern int turbo_mode;          /* (O) run as fast as the host allows */
 #ifdef _WIN32
 extern int force_debug; /* (O) force debug output */
 #endif
@@ -143,8 +145,15 @@ extern int      xga_standalone_enabled;     /* (C) video option */
 extern int      da2_standalone_enabled;     /* (C) video option */
 extern uint32_t mem_size;                   /* (C) memory size (Installed on system board) */
 extern uint32_t isa_mem_size;               /* (C) memory size (ISA Memory Cards) */
+extern int      mem_hugepages;              /* (C) back the RAM with transparent (1) or explicit (2) huge pages */
+extern int      mem_numa;                   /* (C) place the RAM on the NUMA node of the emulation thread */
 extern int      cpu;                        /* (C) cpu type */
 extern int      cpu_use_dynarec;            /* (C) cpu uses/needs Dyna */
+extern int      cpu_dynarec_trace;          /* (C) dynarec compiles hot blocks as traces */
+extern int      cpu_dynarec_cache;          /* (C) dynarec keeps block hints in the VM directory */
+extern int      cpu_dynarec_compile_threshold; /* (C) dynarec interprets marked blocks this many times before compiling */
+extern int      cpu_dynarec_compile_thread; /* (C) dynarec generates host code on a worker thread */
+extern int      cpu_idle_skip;              /* (C) skip to the next timer on HLT (1), and in polling loops (2) */
 extern int      fpu_type;                   /* (C) fpu type */
 extern int      fpu_softfloat;              /* (C) fpu uses softfloat */
 extern int      time_sync;                  /* (C) enable time sync */
@@ -153,6 +162,7 @@ extern int      lba_enhancer_enabled;       /* (C) enable Vision Systems LBA Enh
 extern int      confirm_reset;              /* (C) enable reset confirmation */
 extern int      confirm_exit;               /* (C) enable exit confirmation */
 extern int      confirm_save;               /* (C) enable save confirmation */
+extern int      density_mode;               /* (C) share ROMs and media with other instances, let the host merge RAM */
 extern int      enable_discord;             /* (C) enable Discord integration */
 extern int      other_ide_present;          /* IDE controllers from non-IDE cards are present */
 extern int      other_scsi_present;         /* SCSI controllers from non-SCSI cards are present */
@@ -208,6 +218,7 @@ extern int  pc_init(int argc, char *argv[]);
 extern void pc_close(void *threadid);
 extern void pc_reset_hard_close(void);
 extern void pc_reset_hard_init(void);
+extern void pc_mem_usage_log(void);
 extern void pc_reset_hard(void);
 extern void pc_full_speed(void);
 extern void pc_speed_changed(void);
@@ -232,6 +243,7 @@ extern void do_pause(int p);
 extern double isa_timing;
 extern int    io_delay;
 extern int    framecountx;
+extern int    cpu_idle_percent;
 
 extern volatile int     cpu_thread_run;
 extern          uint8_t postcard_codes[POSTCARDS_NUM];
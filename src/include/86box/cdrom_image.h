@@ -25,10 +25,12 @@ typedef struct track_file_t {
     uint64_t (*get_length)(void *priv);
     void (*close)(void *priv);
 
-    char  fn[260];
-    FILE *fp;
-    void *priv;
-    void *log;
+    char     fn[260];
+    FILE    *fp;
+    uint8_t *map; /* read-only mapping of the file in density mode */
+    uint64_t map_size;
+    void    *priv;
+    void    *log;
 
     int motorola;
 } track_file_t;
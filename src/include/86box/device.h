@@ -157,6 +157,8 @@ typedef struct _device_config_ {
     const device_config_bios_t       bios[32];
 } device_config_t;
 
+struct savestate_t;
+
 typedef struct _device_ {
     const char *name;
     const char *internal_name;
@@ -174,6 +176,10 @@ typedef struct _device_ {
     void (*force_redraw)(void *priv);
 
     const device_config_t *config;
+
+    /* Save state support, see savestate.h. */
+    void (*save)(void *priv, struct savestate_t *state);
+    void (*load)(void *priv, struct savestate_t *state);
 } device_t;
 
 typedef struct device_context_t {
@@ -203,8 +209,12 @@ extern void  device_add_inst_ex_params(const device_t *dev, void *priv, int inst
 extern void *device_get_common_priv(void);
 extern void  device_close_all(void);
 extern void  device_reset_all(uint32_t match_flags);
+extern int   device_check_state(void);
+extern void  device_save_state(struct savestate_t *state);
+extern void  device_load_state(struct savestate_t *state);
 extern void *device_find_first_priv(uint32_t match_flags);
 extern void *device_get_priv(const device_t *dev);
+extern const device_t *device_get_by_priv(void *priv);
 extern int   device_available(const device_t *dev);
 extern void  device_speed_changed(void);
 extern void  device_force_redraw(void);
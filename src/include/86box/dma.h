@@ -84,6 +84,10 @@ extern void dma_init(void);
 extern void dma16_init(void);
 extern void ps2_dma_init(void);
 extern void dma_reset(void);
+
+struct savestate_t;
+extern void dma_save_state(struct savestate_t *state);
+extern void dma_load_state(struct savestate_t *state);
 extern int  dma_mode(int channel);
 
 extern void    readdma0(void);
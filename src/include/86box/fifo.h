@@ -78,6 +78,9 @@ extern void       fifo_set_priv(void *priv, void *sub_priv);
 extern void       fifo_reset(void *priv);
 extern void       fifo_reset_evt(void *priv);
 extern void       fifo_close(void *priv);
+
+struct savestate_t;
+extern void       fifo_state(void *priv, struct savestate_t *state);
 extern void      *fifo_init(int len);
 
 #endif /*FIFO_H*/
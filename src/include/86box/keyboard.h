@@ -272,6 +272,7 @@ extern void     keyboard_poll_host(void);
 extern void     keyboard_process(void);
 extern uint16_t keyboard_convert(int ch);
 extern void     keyboard_input(int down, uint16_t scan);
+extern void     keyboard_input_deliver(int down, uint16_t scan);
 extern void     keyboard_all_up(void);
 extern void     keyboard_update_states(uint8_t cl, uint8_t nl, uint8_t sl);
 extern uint8_t  keyboard_get_shift(void);
@@ -294,6 +295,8 @@ extern uint8_t      kbc_at_dev_queue_pos(atkbc_dev_t *dev, uint8_t main);
 extern void         kbc_at_dev_queue_add(atkbc_dev_t *dev, uint8_t val, uint8_t main);
 extern void         kbc_at_dev_reset(atkbc_dev_t *dev, int do_fa);
 extern atkbc_dev_t *kbc_at_dev_init(uint8_t inst);
+struct savestate_t;
+extern void         kbc_at_dev_state(atkbc_dev_t *dev, struct savestate_t *state);
 /* This is so we can disambiguate scan codes that would otherwise conflict and get
    passed on incorrectly. */
 extern uint16_t     convert_scan_code(uint16_t scan_code);
@@ -256,6 +256,20 @@ typedef struct _page_ {
 } page_t;
 #endif
 
+/* Counters for the software TLB (the readlookup/writelookup rings) and the
+   page walk caches. */
+typedef struct mmu_stats_t {
+    uint64_t read_fills;   /* readlookup2 misses that installed an entry */
+    uint64_t write_fills;  /* writelookup2 misses that installed an entry */
+    uint64_t flushes;      /* full flushes */
+    uint64_t cr3_flushes;  /* CR3 reloads that kept global pages */
+    uint64_t globals_kept; /* entries kept across those reloads */
+    uint64_t pde_hits;     /* page walks that reused a cached PDE */
+    uint64_t pde_misses;
+    uint64_t pdpte_hits;   /* PAE page walks that reused a cached PDPTE */
+    uint64_t pdpte_misses;
+} mmu_stats_t;
+
 extern uint8_t *ram;
 extern uint8_t *ram2;
 extern uint32_t rammask;
@@ -298,6 +312,8 @@ extern int shadowbios_write;
 extern int readlnum;
 extern int writelnum;
 
+extern mmu_stats_t mmu_stats;
+
 extern int memspeed[11];
 
 extern int     mmu_perm;
@@ -452,6 +468,17 @@ extern void flushmmucache(void);
 extern void flushmmucache_write(void);
 extern void flushmmucache_pc(void);
 extern void flushmmucache_nopc(void);
+extern void flushmmucache_cr3(void);
+
+extern void mem_mmu_stats_dump(void);
+extern void mem_mmu_stats_reset(void);
+
+struct savestate_t;
+extern void mem_save_state(struct savestate_t *state);
+extern void mem_load_state(struct savestate_t *state);
+extern void mem_dirty_start(void);
+extern void mem_dirty_stop(void);
+extern int  mem_dirty_active(void);
 
 extern void mem_debug_check_addr(uint32_t addr, int write);
 
@@ -462,6 +489,7 @@ extern void mem_init(void);
 extern void mem_close(void);
 extern void mem_zero(void);
 extern void mem_reset(void);
+extern void mem_numa_update(void);
 extern void mem_remap_top_ex(int kb, uint32_t start);
 extern void mem_remap_top_ex_nomid(int kb, uint32_t start);
 extern void mem_remap_top(int kb);
@@ -108,6 +108,10 @@ extern void  nvr_init(nvr_t *);
 extern int   nvr_load(void);
 extern void  nvr_close(void);
 extern void  nvr_set_ven_save(void (*ven_save)(void));
+#ifdef _TIMER_H_
+struct savestate_t;
+extern void  nvr_state(nvr_t *nvr, struct savestate_t *state);
+#endif
 extern int   nvr_save(void);
 
 extern int  nvr_is_leap(int year);
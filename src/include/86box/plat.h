@@ -151,6 +151,13 @@ extern int      plat_dir_check(char *path);
 extern int      plat_dir_create(char *path);
 extern void    *plat_mmap(size_t size, uint8_t executable);
 extern void     plat_munmap(void *ptr, size_t size);
+extern void    *plat_mmap_file(FILE *fp, uint64_t offset, size_t size, int copy);
+extern void     plat_munmap_file(void *ptr, size_t size);
+extern void     plat_mem_mergeable(void *ptr, size_t size);
+extern void    *plat_mmap_ram(size_t size, int huge);
+extern void     plat_munmap_ram(void *ptr, size_t size, int huge);
+extern int      plat_mem_bind_node(void *ptr, size_t size);
+extern int      plat_mem_usage(uint64_t *resident, uint64_t *shared);
 extern uint64_t plat_timer_read(void);
 extern uint32_t plat_get_ticks(void);
 extern void     plat_delay_ms(uint32_t count);
@@ -163,6 +170,7 @@ extern void     plat_resize_request(int x, int y, int monitor_index);
 extern int      plat_language_code(char *langcode);
 extern void     plat_language_code_r(int id, char *outbuf, int len);
 extern void     plat_get_cpu_string(char *outbuf, uint8_t len);
+extern int      plat_cpu_count(void);
 extern void     plat_set_thread_name(void *thread, const char *name);
 extern void     plat_break(void);
 
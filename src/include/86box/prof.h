@@ -0,0 +1,93 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Definitions for the host time profiler.
+ *
+ *
+ *
+ * Authors: The 86Box development team
+ *
+ *          Copyright 2026 The 86Box development team
+ */
+#ifndef EMU_PROF_H
+#define EMU_PROF_H
+
+/*
+ * The profiler is only built with the PROFILER option. It attributes the host
+ * time the emulation thread spends in each frame (one pc_run() call) to a set
+ * of sections: CPU execution, dynarec compilation, video, sound mixing, disk
+ * image I/O, and one section per device for the timer callbacks of that
+ * device. Sections nest, and each one is only charged for the time not spent
+ * in the sections it contains, so the times add up to the frame time.
+ *
+ * Sections may only be entered from the emulation thread. Starting, stopping
+ * and resetting take effect at the start of the next frame.
+ *
+ * The totals are printed by prof_summary(). In builds with MINITRACE, each
+ * section's time is also emitted as a counter every frame while tracing.
+ */
+
+typedef struct prof_section_t {
+    const char *name;
+    uint64_t    ticks;       /* Host time since the last reset. */
+    uint64_t    frame_ticks; /* Host time in the current frame. */
+    uint64_t    calls;
+
+    struct prof_section_t *next;
+} prof_section_t;
+
+struct pc_timer_t;
+struct _device_;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef USE_PROFILER
+extern int prof_active;
+
+extern prof_section_t prof_cpu;
+extern prof_section_t prof_compile;
+extern prof_section_t prof_video;
+extern prof_section_t prof_sound;
+extern prof_section_t prof_disk;
+
+extern void            prof_enter(prof_section_t *section);
+extern void            prof_leave(void);
+extern prof_section_t *prof_device_section(const struct _device_ *dev);
+extern prof_section_t *prof_timer_section(struct pc_timer_t *timer);
+
+extern void prof_frame_begin(void);
+extern void prof_frame_end(void);
+
+extern void prof_start(void);
+extern void prof_stop(void);
+extern void prof_reset(void);
+extern int  prof_running(void);
+extern void prof_summary(FILE *fp);
+
+#    define PROF_ENTER(section)      \
+        do {                         \
+            if (prof_active)         \
+                prof_enter(section); \
+        } while (0)
+#    define PROF_LEAVE()      \
+        do {                  \
+            if (prof_active)  \
+                prof_leave(); \
+        } while (0)
+#else
+#    define PROF_ENTER(section)
+#    define PROF_LEAVE()
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*EMU_PROF_H*/
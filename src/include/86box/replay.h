@@ -0,0 +1,81 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Definitions for the deterministic record/replay subsystem.
+ *
+ *
+ *
+ * Authors: The 86Box development team
+ *
+ *          Copyright 2026 The 86Box development team
+ */
+#ifndef EMU_REPLAY_H
+#define EMU_REPLAY_H
+
+/*
+ * Emulated time is derived from the emulated TSC only, so a run can be
+ * reproduced by feeding the machine the same inputs, at the same TSC values,
+ * from the same starting point. A replay log records those inputs:
+ *
+ * - keystrokes and mouse input, which the UI delivers from its own thread,
+ *   and which are therefore staged and only passed on to the emulation from
+ *   the emulation thread while a log is recorded or played back;
+ * - network packets received from the host, at the point the card takes them;
+ * - host clock reads for the RTC time sync.
+ *
+ * The starting point is either a hard reset, or a save state taken when the
+ * recording was started. Disk images and the NVR are not part of the log, and
+ * must be in the same state for the replay as they were for the recording;
+ * NVR saving is disabled for the rest of the session once a log is recorded
+ * or played back for that reason. During playback, UI input and host network packets are dropped.
+ */
+
+#define REPLAY_NONE   0
+#define REPLAY_RECORD 1
+#define REPLAY_PLAY   2
+
+typedef struct replay_mouse_t {
+    double  x;
+    double  y;
+    int32_t z;
+    int32_t w;
+    int32_t buttons;
+    int32_t pad;
+} replay_mouse_t;
+
+struct netpkt;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int replay_mode;
+extern int replay_started; /* a log was recorded or played back this session */
+
+/* Start recording to or playing back fn. A log recorded with a NULL state
+   starts at the next hard reset, which the caller has to bring about; with a
+   state, the machine is saved to, or restored from, it first. Return 0 on
+   success. */
+extern int  replay_record(const char *fn, const char *state);
+extern int  replay_play(const char *fn);
+extern int  replay_waiting_reset(void);
+extern void replay_stop(void);
+
+/* Hooks, all called from the emulation thread unless noted otherwise. */
+extern void    replay_reset(void);
+extern void    replay_frame(void);
+extern int     replay_queue_key(int down, uint16_t scan); /* UI thread */
+extern int     replay_mouse(replay_mouse_t *mouse);
+extern int     replay_net_rx(int card_num, struct netpkt *pkt, int res);
+extern int64_t replay_host_time(int64_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*EMU_REPLAY_H*/
@@ -0,0 +1,94 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Definitions for the machine save state subsystem.
+ *
+ *
+ *
+ * Authors: The 86Box development team
+ *
+ *          Copyright 2026 The 86Box development team
+ */
+#ifndef EMU_SAVESTATE_H
+#define EMU_SAVESTATE_H
+
+/*
+ * A save state file is a header followed by a sequence of sections. Each
+ * section carries a name and its payload length, and the sections appear in
+ * a fixed order: the core sections (CPU, memory, PIC, DMA) followed by one
+ * section per device, in device_add() order.
+ *
+ * Section payloads are raw host-endian structures. A state can therefore only
+ * be restored by the same build, on the same kind of host, into a machine with
+ * the same configuration - this is checked through the header, the version
+ * and the section names and lengths.
+ *
+ * Checkpoints form a chain: the first one is a full state, and each following
+ * one is a delta state that names the previous one as its parent and only
+ * stores the guest RAM pages written since it was taken. Everything else is
+ * stored in full every time, with large buffers such as video memory packed.
+ * Loading a delta state restores its parents first.
+ *
+ * A device takes part by setting the save and load callbacks in its device_t,
+ * and using the accessors below from them. Saving is refused while any device
+ * without those callbacks is present, as its state could not be restored.
+ */
+
+#define SAVESTATE_VERSION 4
+
+typedef struct savestate_t savestate_t;
+
+struct pc_timer_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Section payload accessors, for use from device save/load callbacks. */
+extern void savestate_write(savestate_t *state, const void *data, size_t len);
+extern void savestate_read(savestate_t *state, void *data, size_t len);
+extern void savestate_write_timer(savestate_t *state, struct pc_timer_t *timer);
+extern void savestate_read_timer(savestate_t *state, struct pc_timer_t *timer);
+
+/* Blocks are packed, for large buffers such as RAM pages and VRAM. */
+extern void savestate_write_block(savestate_t *state, const void *data, size_t len);
+extern void savestate_read_block(savestate_t *state, void *data, size_t len);
+
+/* The same, in the direction the state is going, so that one callback can
+   serve as both the save and the load one. */
+extern void savestate_var(savestate_t *state, void *data, size_t len);
+extern void savestate_timer(savestate_t *state, struct pc_timer_t *timer);
+extern void savestate_block(savestate_t *state, void *data, size_t len);
+
+#define savestate_write_var(state, var) savestate_write(state, &(var), sizeof(var))
+#define savestate_read_var(state, var)  savestate_read(state, &(var), sizeof(var))
+#define SAVESTATE_VAR(state, var)       savestate_var(state, &(var), sizeof(var))
+
+/* Sections; savestate_section() returns 0 if the state being loaded has no
+   section of that name at this position. */
+extern int  savestate_section(savestate_t *state, const char *name);
+extern void savestate_section_end(savestate_t *state);
+extern int  savestate_is_loading(savestate_t *state);
+extern int  savestate_is_delta(savestate_t *state);
+extern void savestate_set_error(savestate_t *state);
+
+/* Save or restore the whole machine; must be called between CPU slices.
+   Return 0 on success. */
+extern int savestate_save(const char *fn);
+extern int savestate_checkpoint(const char *fn);
+extern int savestate_load(const char *fn);
+
+/* Save to fn, restore from it and check that saving again gives the same;
+   with checkpoint set, fn is a checkpoint and its whole chain is restored. */
+extern int savestate_verify(const char *fn, int checkpoint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*EMU_SAVESTATE_H*/
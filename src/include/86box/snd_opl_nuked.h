@@ -21,7 +21,11 @@
 #define SOUND_OPL_NUKED_H
 
 #ifdef __cplusplus
+#    include <atomic>
+using atomic_int = std::atomic<int>;
 extern "C" {
+#else
+#    include <stdatomic.h>
 #endif
 
 #include <inttypes.h>
@@ -33,6 +37,9 @@ extern "C" {
 #define OPL_WRITEBUF_SIZE  1024
 #define OPL_WRITEBUF_DELAY 2
 
+#define NUKED_FIFO_SIZE 4096
+#define NUKED_FIFO_MASK (NUKED_FIFO_SIZE - 1)
+
 typedef struct _opl3_slot    opl3_slot;
 typedef struct _opl3_channel opl3_channel;
 typedef struct _opl3_chip    opl3_chip;
@@ -155,10 +162,33 @@ typedef struct {
     uint16_t timer_count[2];
     uint16_t timer_cur_count[2];
 
+    /* Everything written to the chip, to rebuild it from on restore. */
+    uint8_t regs[0x200];
+
     pc_timer_t timers[2];
 
+    /* Owned by the render thread. */
     int     pos;
     int32_t buffer[MUSICBUFLEN * 2];
+
+    /* Finished frames, handed out one frame after they were queued. */
+    int32_t frames[2][MUSICBUFLEN * 2];
+    int     frames_queued;
+
+    /* Register writes, stamped with the sample they land on. */
+    struct {
+        int      pos;
+        uint16_t reg;
+        uint8_t  val;
+    } fifo[NUKED_FIFO_SIZE];
+    atomic_int fifo_read_idx;
+    atomic_int fifo_write_idx;
+    atomic_int frames_done;
+
+    void         *render_thread;
+    void         *wake_render_thread;
+    void         *render_done_event;
+    volatile int  render_on;
 } nuked_drv_t;
 
 enum {
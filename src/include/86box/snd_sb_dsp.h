@@ -189,6 +189,9 @@ extern void sb_dsp_set_mpu(sb_dsp_t *dsp, mpu_t *src_mpu);
 extern void sb_dsp_init(sb_dsp_t *dsp, int type, int subtype, void *parent);
 extern void sb_dsp_close(sb_dsp_t *dsp);
 
+struct savestate_t;
+extern void sb_dsp_state(sb_dsp_t *dsp, struct savestate_t *state);
+
 extern void sb_dsp_setirq(sb_dsp_t *dsp, int irq);
 extern void sb_dsp_setdma8(sb_dsp_t *dsp, int dma);
 extern void sb_dsp_setdma16(sb_dsp_t *dsp, int dma);
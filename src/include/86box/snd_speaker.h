@@ -31,4 +31,7 @@ extern void speaker_init(void);
 extern void speaker_set_count(uint8_t new_m, int new_count);
 extern void speaker_update(void);
 
+struct savestate_t;
+extern void speaker_state(struct savestate_t *state);
+
 #endif /*SOUND_SPEAKER_H*/
@@ -99,6 +99,7 @@ extern void sound_reset(void);
 extern void sound_card_reset(void);
 
 extern void sound_cd_thread_end(void);
+extern void sound_out_thread_end(void);
 extern void sound_cd_thread_reset(void);
 
 extern void closeal(void);
@@ -50,8 +50,12 @@ typedef struct pc_timer_t {
     void (*callback)(void *priv);
     void *priv;
 
-    struct pc_timer_t *prev;
-    struct pc_timer_t *next;
+    uint32_t heap_pos; /* Position in the timer heap plus one, 0 if not queued. */
+    uint32_t seq;      /* Enable sequence, used to order equal timestamps. */
+
+#ifdef USE_PROFILER
+    struct prof_section_t *prof; /* Profiler section of the owning device. */
+#endif
 } pc_timer_t;
 
 #ifdef __cplusplus
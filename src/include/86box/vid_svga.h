@@ -300,6 +300,18 @@ typedef struct svga_t {
     /* Enable LUT mapping of >= 24 bpp modes. */
     int lut_map;
 
+    /* Runs of target buffer lines drawn this frame, passed on with the blit
+       so the UI only has to update those. */
+    int          damage_num;
+    int          damage_full;
+    video_rect_t damage[VIDEO_DAMAGE_MAX];
+
+    /* State of the previous blit, a change to which damages everything. */
+    int      damage_dpms;
+    int      damage_y_add;
+    int      damage_scrollcache;
+    uint32_t damage_overscan_color;
+
     /* Override the horizontal blanking stuff. */
     int hoverride;
 
@@ -359,6 +371,11 @@ extern int  svga_init(const device_t *info, svga_t *svga, void *priv, int memsiz
 extern void svga_recalctimings(svga_t *svga);
 extern void svga_close(svga_t *svga);
 
+struct savestate_t;
+extern void svga_state(svga_t *svga, struct savestate_t *state);
+
+extern uint32_t svga_conv_16to32(struct svga_t *svga, uint16_t color, uint8_t bpp);
+
 uint8_t  svga_read(uint32_t addr, void *priv);
 uint16_t svga_readw(uint32_t addr, void *priv);
 uint32_t svga_readl(uint32_t addr, void *priv);
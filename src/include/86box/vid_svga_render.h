@@ -89,4 +89,14 @@ extern void ibm8514_render_RGBA8888(svga_t *svga);
 
 extern void (*svga_render)(svga_t *svga);
 
+/* Scanline converters from packed VRAM pixels to the 32-bit target buffer,
+   picked for the host CPU by svga_render_simd_init(). */
+extern void (*svga_conv_line_15to32)(uint32_t *dst, const uint8_t *src, int n);
+extern void (*svga_conv_line_16to32)(uint32_t *dst, const uint8_t *src, int n);
+extern void (*svga_conv_line_24to32)(uint32_t *dst, const uint8_t *src, int n);
+extern void (*svga_conv_line_32to32)(uint32_t *dst, const uint8_t *src, int n);
+extern const char *svga_conv_line_name;
+
+extern void svga_render_simd_init(void);
+
 #endif /*VID_SVGA_RENDER_H*/
@@ -0,0 +1,593 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          AVX2 code generator for the Voodoo pixel pipeline, shading
+ *          eight pixels of a span per iteration. Included from
+ *          vid_voodoo_codegen_x86-64.h.
+ *
+ *
+ *
+ * Authors: The 86Box development team
+ *
+ *          Copyright 2026 The 86Box development team
+ */
+#ifndef VIDEO_VOODOO_CODEGEN_AVX2_H
+#define VIDEO_VOODOO_CODEGEN_AVX2_H
+
+/*Only pipelines where every pixel of a span is written, and nothing is read
+  back from the frame buffer, are handled here: untextured, with no depth
+  test, alpha test, alpha blending or fog, to linear buffers. Those have no
+  per-pixel early exits, so eight pixels can be shaded in lockstep. Anything
+  else is left to the SSE2 generator.
+
+  Each colour channel is kept in its own YMM register as eight 32-bit lanes,
+  lane 0 being the leftmost pixel. Register use :
+
+  YMM0-YMM7  - temporaries
+  YMM8-YMM12 - iterated R, G, B, A and Z
+  YMM13      - dither table offset of each lane's screen position
+  YMM14      - zero
+  YMM15      - 0xff in each lane
+
+  RDI - voodoo_state
+  RSI - voodoo_params
+  RDX - frame buffer address of lane 0
+  EBX - pixels left in the span
+  R9  - real_y*/
+
+#define AVX2_STK_STEP(i)   ((i) * 32)        /*per iteration step of each iterator*/
+#define AVX2_STK_COLOR0(c) (160 + ((c) * 32)) /*color0 channels, B G R A*/
+#define AVX2_STK_COLOR1(c) (288 + ((c) * 32)) /*color1 channels, B G R A*/
+#define AVX2_STK_TAIL      416                /*packed pixels of a partial iteration*/
+#define AVX2_STK_XMM       448                /*saved XMM6-XMM15 on Win64*/
+#define AVX2_STK_SIZE      616
+
+#define AVX2_ITER_R 0
+#define AVX2_ITER_G 1
+#define AVX2_ITER_B 2
+#define AVX2_ITER_A 3
+#define AVX2_ITER_Z 4
+
+static int voodoo_codegen_avx2 = 0;
+
+static const int32_t avx2_lanes_up[8]   = { 0, 1, 2, 3, 4, 5, 6, 7 };
+static const int32_t avx2_lanes_down[8] = { -7, -6, -5, -4, -3, -2, -1, 0 };
+
+/*The dither tables widened to 32 bits, so that they can be gathered from*/
+static uint32_t avx2_dither_rb[256 * 4 * 4];
+static uint32_t avx2_dither_g[256 * 4 * 4];
+static uint32_t avx2_dither_rb2x2[256 * 2 * 2];
+static uint32_t avx2_dither_g2x2[256 * 2 * 2];
+
+static int
+voodoo_cpu_has_avx2(void)
+{
+#ifdef _MSC_VER
+    int regs[4];
+
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return 0;
+    __cpuid(regs, 1);
+    /*AVX and OSXSAVE, with the OS saving the YMM state*/
+    if ((regs[2] & 0x18000000) != 0x18000000)
+        return 0;
+    if ((_xgetbv(0) & 6) != 6)
+        return 0;
+    __cpuidex(regs, 7, 0);
+    return !!(regs[1] & (1 << 5));
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static void
+voodoo_codegen_avx2_init(void)
+{
+    const uint8_t *rb    = &dither_rb[0][0][0];
+    const uint8_t *g     = &dither_g[0][0][0];
+    const uint8_t *rb2x2 = &dither_rb2x2[0][0][0];
+    const uint8_t *g2x2  = &dither_g2x2[0][0][0];
+
+    voodoo_codegen_avx2 = voodoo_cpu_has_avx2();
+
+    for (int c = 0; c < (256 * 4 * 4); c++) {
+        avx2_dither_rb[c] = rb[c];
+        avx2_dither_g[c]  = g[c];
+    }
+    for (int c = 0; c < (256 * 2 * 2); c++) {
+        avx2_dither_rb2x2[c] = rb2x2[c];
+        avx2_dither_g2x2[c]  = g2x2[c];
+    }
+}
+
+static inline int
+voodoo_avx2_supported(voodoo_params_t *params)
+{
+    int need_alpha = (cc_mselect == CC_MSELECT_AOTHER) || (cc_mselect == CC_MSELECT_ALOCAL) || (cc_add == CC_ADD_ALOCAL);
+
+    if (params->col_tiled || params->aux_tiled)
+        return 0;
+    if (params->fbzColorPath & FBZCP_TEXTURE_ENABLED)
+        return 0;
+    if (params->fbzMode & (FBZ_DEPTH_ENABLE | FBZ_CHROMAKEY))
+        return 0;
+    if ((params->alphaMode & ((1 << 0) | (1 << 4))) || (params->fogMode & FOG_ENABLE))
+        return 0;
+    /*With no depth test or write and no texturing, a block that writes no
+      colour only has to count the pixels*/
+    if (!(params->fbzMode & FBZ_RGB_WMASK))
+        return 1;
+
+    /*Selections that read the (disabled) texture unit, or that the
+      interpreter treats as fatal*/
+    if (cc_localselect_override || (_rgb_sel == CC_LOCALSELECT_TEX))
+        return 0;
+    if ((cc_mselect > CC_MSELECT_ALOCAL) || (cc_add == 3) || (a_sel == A_SEL_LFB) || (cca_localselect == 3))
+        return 0;
+    if (need_alpha && (a_sel == A_SEL_TEX))
+        return 0;
+
+    return 1;
+}
+
+/*Three byte VEX prefix. r, x and b are the registers encoded in the ModRM reg
+  field, the SIB index and the ModRM rm field or SIB base; only their top bit
+  goes here. v is the extra source register, 0 if unused.*/
+static inline int
+codegen_avx2_vex(uint8_t *code_block, int block_pos, int map, int pp, int w, int l, int r, int x, int b, int v)
+{
+    addbyte(0xc4);
+    addbyte(((~r & 8) << 4) | ((~x & 8) << 3) | ((~b & 8) << 2) | map);
+    addbyte((w << 7) | ((~v & 15) << 3) | (l << 2) | pp);
+    return block_pos;
+}
+
+/*dst = op(src1, src2), on YMM registers*/
+static inline int
+codegen_avx2_rrr(uint8_t *code_block, int block_pos, int map, uint8_t opcode, int dst, int src1, int src2)
+{
+    block_pos = codegen_avx2_vex(code_block, block_pos, map, 1, 0, 1, dst, 0, src2, src1);
+    addbyte(opcode);
+    addbyte(0xc0 | ((dst & 7) << 3) | (src2 & 7));
+    return block_pos;
+}
+
+/*dst = src shifted by imm, ext selects the shift (2 - PSRLD, 4 - PSRAD, 6 - PSLLD)*/
+static inline int
+codegen_avx2_shift(uint8_t *code_block, int block_pos, int ext, int dst, int src, int imm)
+{
+    block_pos = codegen_avx2_vex(code_block, block_pos, 1, 1, 0, 1, 0, 0, src, dst);
+    addbyte(0x72);
+    addbyte(0xc0 | (ext << 3) | (src & 7));
+    addbyte(imm);
+    return block_pos;
+}
+
+/*reg = op(v, [base + disp]), or the store form of op*/
+static inline int
+codegen_avx2_mem(uint8_t *code_block, int block_pos, int map, int pp, int l, uint8_t opcode, int reg, int v, int base, int32_t disp)
+{
+    block_pos = codegen_avx2_vex(code_block, block_pos, map, pp, 0, l, reg, 0, base, v);
+    addbyte(opcode);
+    addbyte(0x80 | ((reg & 7) << 3) | (base & 7));
+    if ((base & 7) == 4)
+        addbyte(0x24); /*SIB, base only*/
+    addlong(disp);
+    return block_pos;
+}
+
+#define AVX2_RRR(map, opcode, dst, src1, src2) block_pos = codegen_avx2_rrr(code_block, block_pos, map, opcode, dst, src1, src2)
+
+#define VPADDD(dst, src1, src2)   AVX2_RRR(1, 0xfe, dst, src1, src2)
+#define VPSUBD(dst, src1, src2)   AVX2_RRR(1, 0xfa, dst, src1, src2)
+#define VPAND(dst, src1, src2)    AVX2_RRR(1, 0xdb, dst, src1, src2)
+#define VPOR(dst, src1, src2)     AVX2_RRR(1, 0xeb, dst, src1, src2)
+#define VPXOR(dst, src1, src2)    AVX2_RRR(1, 0xef, dst, src1, src2)
+#define VPCMPEQD(dst, src1, src2) AVX2_RRR(1, 0x76, dst, src1, src2)
+#define VPMULLD(dst, src1, src2)  AVX2_RRR(2, 0x40, dst, src1, src2)
+#define VPMAXSD(dst, src1, src2)  AVX2_RRR(2, 0x3d, dst, src1, src2)
+#define VPMINSD(dst, src1, src2)  AVX2_RRR(2, 0x39, dst, src1, src2)
+#define VPACKUSDW(dst, src1, src2) AVX2_RRR(2, 0x2b, dst, src1, src2)
+
+#define VPSRLD(dst, src, imm) block_pos = codegen_avx2_shift(code_block, block_pos, 2, dst, src, imm)
+#define VPSRAD(dst, src, imm) block_pos = codegen_avx2_shift(code_block, block_pos, 4, dst, src, imm)
+#define VPSLLD(dst, src, imm) block_pos = codegen_avx2_shift(code_block, block_pos, 6, dst, src, imm)
+
+#define VMOVDQU_LOAD(dst, base, disp)      block_pos = codegen_avx2_mem(code_block, block_pos, 1, 2, 1, 0x6f, dst, 0, base, disp)
+#define VMOVDQU_STORE(base, disp, src)     block_pos = codegen_avx2_mem(code_block, block_pos, 1, 2, 1, 0x7f, src, 0, base, disp)
+#define VMOVDQU_STORE_XMM(base, disp, src) block_pos = codegen_avx2_mem(code_block, block_pos, 1, 2, 0, 0x7f, src, 0, base, disp)
+#define VMOVDQU_LOAD_XMM(dst, base, disp)  block_pos = codegen_avx2_mem(code_block, block_pos, 1, 2, 0, 0x6f, dst, 0, base, disp)
+#define VPBROADCASTD_MEM(dst, base, disp)  block_pos = codegen_avx2_mem(code_block, block_pos, 2, 1, 1, 0x58, dst, 0, base, disp)
+#define VPADDD_MEM(dst, src, base, disp)   block_pos = codegen_avx2_mem(code_block, block_pos, 1, 1, 1, 0xfe, dst, src, base, disp)
+#define VPMULLD_MEM(dst, src, base, disp)  block_pos = codegen_avx2_mem(code_block, block_pos, 2, 1, 1, 0x40, dst, src, base, disp)
+
+#define REG_RAX 0
+#define REG_RCX 1
+#define REG_RDX 2
+#define REG_RSP 4
+#define REG_RSI 6
+#define REG_RDI 7
+
+/*dst = CLAMP(src >> shift)*/
+static inline int
+codegen_avx2_clamp_iter(uint8_t *code_block, int block_pos, int dst, int src, int shift)
+{
+    VPSRAD(dst, src, shift);
+    VPMAXSD(dst, dst, 14);
+    VPMINSD(dst, dst, 15);
+    return block_pos;
+}
+
+/*Broadcast EAX to every lane of dst*/
+static inline int
+codegen_avx2_broadcast_eax(uint8_t *code_block, int block_pos, int dst)
+{
+    block_pos = codegen_avx2_vex(code_block, block_pos, 1, 1, 0, 0, dst, 0, REG_RAX, 0);
+    addbyte(0x6e); /*VMOVD dst, EAX*/
+    addbyte(0xc0 | ((dst & 7) << 3));
+    block_pos = codegen_avx2_vex(code_block, block_pos, 2, 1, 0, 1, dst, 0, dst, 0);
+    addbyte(0x58); /*VPBROADCASTD dst, dst*/
+    addbyte(0xc0 | ((dst & 7) << 3) | (dst & 7));
+    return block_pos;
+}
+
+static inline void
+voodoo_generate_avx2(uint8_t *code_block, voodoo_t *voodoo, voodoo_params_t *params, voodoo_state_t *state)
+{
+    static const int iter_state[5]  = { offsetof(voodoo_state_t, ir), offsetof(voodoo_state_t, ig), offsetof(voodoo_state_t, ib), offsetof(voodoo_state_t, ia), offsetof(voodoo_state_t, z) };
+    static const int iter_params[5] = { offsetof(voodoo_params_t, dRdX), offsetof(voodoo_params_t, dGdX), offsetof(voodoo_params_t, dBdX), offsetof(voodoo_params_t, dAdX), offsetof(voodoo_params_t, dZdX) };
+    /*Channel order R, G, B : colour slot and 565 position*/
+    static const int col_slot[3]   = { 2, 1, 0 };
+    static const int out_shift[3]  = { 11, 5, 0 };
+    static const int out_bits[3]   = { 3, 2, 3 };
+    int              block_pos     = 0;
+    int              need_iter[5]  = { 0 };
+    int              need_alocal   = (cc_mselect == CC_MSELECT_ALOCAL) || (cc_add == CC_ADD_ALOCAL);
+    int              need_aother   = (cc_mselect == CC_MSELECT_AOTHER);
+    int              need_color0   = 0;
+    int              need_color1   = 0;
+    int              write         = params->fbzMode & FBZ_RGB_WMASK;
+    int              loop_jump_pos = 0;
+    int              tail_jump_pos = 0;
+    int              done_jump_pos = 0;
+    int              tail_loop_pos = 0;
+
+    if (!cc_localselect)
+        need_iter[AVX2_ITER_R] = need_iter[AVX2_ITER_G] = need_iter[AVX2_ITER_B] = 1;
+    else
+        need_color0 = 1;
+    if (!cc_zero_other && (_rgb_sel == CC_LOCALSELECT_ITER_RGB))
+        need_iter[AVX2_ITER_R] = need_iter[AVX2_ITER_G] = need_iter[AVX2_ITER_B] = 1;
+    if (!cc_zero_other && (_rgb_sel == CC_LOCALSELECT_COLOR1))
+        need_color1 = 1;
+    if (need_alocal) {
+        if (cca_localselect == CCA_LOCALSELECT_ITER_A)
+            need_iter[AVX2_ITER_A] = 1;
+        else if (cca_localselect == CCA_LOCALSELECT_COLOR0)
+            need_color0 = 1;
+        else
+            need_iter[AVX2_ITER_Z] = 1;
+    }
+    if (need_aother) {
+        if (a_sel == A_SEL_ITER_A)
+            need_iter[AVX2_ITER_A] = 1;
+        else
+            need_color1 = 1;
+    }
+
+    addbyte(0x53); /*PUSH RBX*/
+    addbyte(0x56); /*PUSH RSI*/
+    addbyte(0x57); /*PUSH RDI*/
+    addbyte(0x48); /*SUB RSP, AVX2_STK_SIZE*/
+    addbyte(0x81);
+    addbyte(0xec);
+    addlong(AVX2_STK_SIZE);
+
+#if _WIN64
+    for (int c = 6; c < 16; c++)
+        VMOVDQU_STORE_XMM(REG_RSP, AVX2_STK_XMM + ((c - 6) * 16), c);
+    addbyte(0x48); /*MOV RDI, RCX (voodoo_state)*/
+    addbyte(0x89);
+    addbyte(0xcf);
+    addbyte(0x48); /*MOV RSI, RDX (voodoo_params)*/
+    addbyte(0x89);
+    addbyte(0xd6);
+#else
+    addbyte(0x41); /*MOV R9D, ECX (real_y)*/
+    addbyte(0x89);
+    addbyte(0xc9);
+#endif
+
+    addbyte(0x8b); /*MOV EAX, state->x[EDI]*/
+    addbyte(0x87);
+    addlong(offsetof(voodoo_state_t, x));
+    addbyte(0x8b); /*MOV EBX, state->x2[EDI]*/
+    addbyte(0x9f);
+    addlong(offsetof(voodoo_state_t, x2));
+    if (state->xdir > 0) {
+        addbyte(0x29); /*SUB EBX, EAX*/
+        addbyte(0xc3);
+    } else {
+        addbyte(0xf7); /*NEG EBX*/
+        addbyte(0xdb);
+        addbyte(0x01); /*ADD EBX, EAX*/
+        addbyte(0xc3);
+        addbyte(0x83); /*SUB EAX, 7 - lane 0 is the leftmost pixel*/
+        addbyte(0xe8);
+        addbyte(7);
+    }
+    addbyte(0x83); /*ADD EBX, 1*/
+    addbyte(0xc3);
+    addbyte(1);
+    addbyte(0x01); /*ADD state->pixel_count[EDI], EBX*/
+    addbyte(0x9f);
+    addlong(offsetof(voodoo_state_t, pixel_count));
+
+    if (write) {
+        addbyte(0x48); /*MOV RDX, state->fb_mem[EDI]*/
+        addbyte(0x8b);
+        addbyte(0x97);
+        addlong(offsetof(voodoo_state_t, fb_mem));
+        addbyte(0x48); /*MOVSXD RCX, EAX*/
+        addbyte(0x63);
+        addbyte(0xc8);
+        addbyte(0x48); /*LEA RDX, [RDX+RCX*2]*/
+        addbyte(0x8d);
+        addbyte(0x14);
+        addbyte(0x4a);
+
+        VPXOR(14, 14, 14);
+        VPCMPEQD(15, 15, 15);
+        VPSRLD(15, 15, 24);
+
+        if (dither) {
+            /*Lane offsets into dither_rb[][y][x], from the screen position.
+              Eight pixels on, x & 3 is the same again, so this holds for
+              the whole span.*/
+            block_pos = codegen_avx2_broadcast_eax(code_block, block_pos, 13);
+            addbyte(0x48); /*MOV RCX, avx2_lanes_up*/
+            addbyte(0xb9);
+            addquad((uintptr_t) avx2_lanes_up);
+            VPADDD_MEM(13, 13, REG_RCX, 0);
+            VPSLLD(13, 13, dither2x2 ? 31 : 30);
+            VPSRLD(13, 13, dither2x2 ? 31 : 30);
+            addbyte(0x44); /*MOV EAX, R9D*/
+            addbyte(0x89);
+            addbyte(0xc8);
+            addbyte(0x83); /*AND EAX, 1 or 3*/
+            addbyte(0xe0);
+            addbyte(dither2x2 ? 1 : 3);
+            addbyte(0xc1); /*SHL EAX, 1 or 2*/
+            addbyte(0xe0);
+            addbyte(dither2x2 ? 1 : 2);
+            block_pos = codegen_avx2_broadcast_eax(code_block, block_pos, 0);
+            VPADDD(13, 13, 0);
+        }
+
+        addbyte(0x48); /*MOV RCX, lane offsets*/
+        addbyte(0xb9);
+        addquad((state->xdir > 0) ? (uintptr_t) avx2_lanes_up : (uintptr_t) avx2_lanes_down);
+        for (int i = 0; i < 5; i++) {
+            if (!need_iter[i])
+                continue;
+            VPBROADCASTD_MEM(0, REG_RSI, iter_params[i]);
+            VPMULLD_MEM(1, 0, REG_RCX, 0);
+            VPBROADCASTD_MEM(8 + i, REG_RDI, iter_state[i]);
+            VPADDD(8 + i, 8 + i, 1);
+            VPSLLD(0, 0, 3);
+            if (state->xdir < 0)
+                VPSUBD(0, 14, 0);
+            VMOVDQU_STORE(REG_RSP, AVX2_STK_STEP(i), 0);
+        }
+
+        for (int c = 0; c < 4; c++) {
+            if (need_color0) {
+                VPBROADCASTD_MEM(0, REG_RSI, offsetof(voodoo_params_t, color0));
+                if (c)
+                    VPSRLD(0, 0, c * 8);
+                VPAND(0, 0, 15);
+                VMOVDQU_STORE(REG_RSP, AVX2_STK_COLOR0(c), 0);
+            }
+            if (need_color1) {
+                VPBROADCASTD_MEM(0, REG_RSI, offsetof(voodoo_params_t, color1));
+                if (c)
+                    VPSRLD(0, 0, c * 8);
+                VPAND(0, 0, 15);
+                VMOVDQU_STORE(REG_RSP, AVX2_STK_COLOR1(c), 0);
+            }
+        }
+
+        loop_jump_pos = block_pos;
+
+        if (need_alocal) {
+            if (cca_localselect == CCA_LOCALSELECT_ITER_A)
+                block_pos = codegen_avx2_clamp_iter(code_block, block_pos, 3, 8 + AVX2_ITER_A, 12);
+            else if (cca_localselect == CCA_LOCALSELECT_COLOR0)
+                VMOVDQU_LOAD(3, REG_RSP, AVX2_STK_COLOR0(3));
+            else
+                block_pos = codegen_avx2_clamp_iter(code_block, block_pos, 3, 8 + AVX2_ITER_Z, 20);
+        }
+        if (need_aother) {
+            if (a_sel == A_SEL_ITER_A)
+                block_pos = codegen_avx2_clamp_iter(code_block, block_pos, 4, 8 + AVX2_ITER_A, 12);
+            else
+                VMOVDQU_LOAD(4, REG_RSP, AVX2_STK_COLOR1(3));
+        }
+
+        VPXOR(5, 5, 5);
+        for (int ch = 0; ch < 3; ch++) {
+            /*YMM0 = clocal, YMM1 = src, YMM2 = msel*/
+            if (cc_localselect)
+                VMOVDQU_LOAD(0, REG_RSP, AVX2_STK_COLOR0(col_slot[ch]));
+            else
+                block_pos = codegen_avx2_clamp_iter(code_block, block_pos, 0, 8 + ch, 12);
+
+            if (cc_zero_other || (_rgb_sel == CC_LOCALSELECT_LFB))
+                VPXOR(1, 1, 1);
+            else if (_rgb_sel == CC_LOCALSELECT_COLOR1)
+                VMOVDQU_LOAD(1, REG_RSP, AVX2_STK_COLOR1(col_slot[ch]));
+            else
+                block_pos = codegen_avx2_clamp_iter(code_block, block_pos, 1, 8 + ch, 12);
+            if (cc_sub_clocal)
+                VPSUBD(1, 1, 0);
+
+            switch (cc_mselect) {
+                case CC_MSELECT_ZERO:
+                    VPXOR(2, 2, 2);
+                    break;
+                case CC_MSELECT_CLOCAL:
+                    VPOR(2, 0, 0);
+                    break;
+                case CC_MSELECT_AOTHER:
+                    VPOR(2, 4, 4);
+                    break;
+                case CC_MSELECT_ALOCAL:
+                    VPOR(2, 3, 3);
+                    break;
+
+                default:
+                    break;
+            }
+            if (!cc_reverse_blend)
+                VPXOR(2, 2, 15);
+
+            /*src = (src * (msel + 1)) >> 8*/
+            VPMULLD(6, 1, 2);
+            VPADDD(1, 6, 1);
+            VPSRAD(1, 1, 8);
+
+            if (cc_add == CC_ADD_CLOCAL)
+                VPADDD(1, 1, 0);
+            else if (cc_add == CC_ADD_ALOCAL)
+                VPADDD(1, 1, 3);
+
+            VPMAXSD(1, 1, 14);
+            VPMINSD(1, 1, 15);
+            if (cc_invert_output)
+                VPXOR(1, 1, 15);
+
+            if (dither) {
+                VPSLLD(1, 1, dither2x2 ? 2 : 4);
+                VPADDD(1, 1, 13);
+                VPCMPEQD(7, 7, 7);
+                addbyte(0x48); /*MOV RAX, dither table*/
+                addbyte(0xb8);
+                if (ch == 1)
+                    addquad(dither2x2 ? (uintptr_t) avx2_dither_g2x2 : (uintptr_t) avx2_dither_g);
+                else
+                    addquad(dither2x2 ? (uintptr_t) avx2_dither_rb2x2 : (uintptr_t) avx2_dither_rb);
+                block_pos = codegen_avx2_vex(code_block, block_pos, 2, 1, 0, 1, 6, 1, REG_RAX, 7);
+                addbyte(0x90); /*VPGATHERDD YMM6, [RAX+YMM1*4], YMM7*/
+                addbyte(0x04 | (6 << 3));
+                addbyte(0x80 | (1 << 3) | REG_RAX);
+                if (out_shift[ch])
+                    VPSLLD(6, 6, out_shift[ch]);
+                VPOR(5, 5, 6);
+            } else {
+                VPSRLD(1, 1, out_bits[ch]);
+                if (out_shift[ch])
+                    VPSLLD(1, 1, out_shift[ch]);
+                VPOR(5, 5, 1);
+            }
+        }
+
+        VPACKUSDW(5, 5, 5);
+        block_pos = codegen_avx2_vex(code_block, block_pos, 3, 1, 1, 1, 5, 0, 5, 0);
+        addbyte(0x00); /*VPERMQ YMM5, YMM5, 0x08 - pixels 0-7 in the low half*/
+        addbyte(0xc0 | (5 << 3) | 5);
+        addbyte(0x08);
+
+        addbyte(0x83); /*CMP EBX, 8*/
+        addbyte(0xfb);
+        addbyte(8);
+        addbyte(0x0f); /*JB tail*/
+        addbyte(0x82);
+        tail_jump_pos = block_pos;
+        addlong(0);
+
+        VMOVDQU_STORE_XMM(REG_RDX, 0, 5);
+        addbyte(0x48); /*ADD/SUB RDX, 16*/
+        addbyte(0x83);
+        addbyte((state->xdir > 0) ? 0xc2 : 0xea);
+        addbyte(16);
+        for (int i = 0; i < 5; i++) {
+            if (need_iter[i])
+                VPADDD_MEM(8 + i, 8 + i, REG_RSP, AVX2_STK_STEP(i));
+        }
+        addbyte(0x83); /*SUB EBX, 8*/
+        addbyte(0xeb);
+        addbyte(8);
+        addbyte(0x0f); /*JNZ loop_jump_pos*/
+        addbyte(0x85);
+        addlong(loop_jump_pos - (block_pos + 4));
+        addbyte(0xe9); /*JMP done*/
+        done_jump_pos = block_pos;
+        addlong(0);
+
+        /*Fewer than eight pixels left; only write the lanes inside the span*/
+        *(uint32_t *) &code_block[tail_jump_pos] = (block_pos - tail_jump_pos) - 4;
+        VMOVDQU_STORE_XMM(REG_RSP, AVX2_STK_TAIL, 5);
+        if (state->xdir > 0) {
+            addbyte(0x31); /*XOR ECX, ECX*/
+            addbyte(0xc9);
+            addbyte(0x41); /*MOV R8D, EBX*/
+            addbyte(0x89);
+            addbyte(0xd8);
+        } else {
+            addbyte(0xb9); /*MOV ECX, 8*/
+            addlong(8);
+            addbyte(0x29); /*SUB ECX, EBX*/
+            addbyte(0xd9);
+            addbyte(0x41); /*MOV R8D, 8*/
+            addbyte(0xb8);
+            addlong(8);
+        }
+        tail_loop_pos = block_pos;
+        addbyte(0x0f); /*MOVZX EAX, [RSP+RCX*2+AVX2_STK_TAIL]*/
+        addbyte(0xb7);
+        addbyte(0x84);
+        addbyte(0x4c);
+        addlong(AVX2_STK_TAIL);
+        addbyte(0x66); /*MOV [RDX+RCX*2], AX*/
+        addbyte(0x89);
+        addbyte(0x04);
+        addbyte(0x4a);
+        addbyte(0x83); /*ADD ECX, 1*/
+        addbyte(0xc1);
+        addbyte(1);
+        addbyte(0x44); /*CMP ECX, R8D*/
+        addbyte(0x39);
+        addbyte(0xc1);
+        addbyte(0x72); /*JB tail_loop_pos*/
+        tail_loop_pos -= block_pos + 1;
+        addbyte(tail_loop_pos);
+
+        *(uint32_t *) &code_block[done_jump_pos] = (block_pos - done_jump_pos) - 4;
+    }
+
+#if _WIN64
+    for (int c = 6; c < 16; c++)
+        VMOVDQU_LOAD_XMM(c, REG_RSP, AVX2_STK_XMM + ((c - 6) * 16));
+#endif
+    addbyte(0x48); /*ADD RSP, AVX2_STK_SIZE*/
+    addbyte(0x81);
+    addbyte(0xc4);
+    addlong(AVX2_STK_SIZE);
+    addbyte(0xc5); /*VZEROUPPER*/
+    addbyte(0xf8);
+    addbyte(0x77);
+    addbyte(0x5f); /*POP RDI*/
+    addbyte(0x5e); /*POP RSI*/
+    addbyte(0x5b); /*POP RBX*/
+
+    addbyte(0xc3); /*RET*/
+}
+
+#endif /*VIDEO_VOODOO_CODEGEN_AVX2_H*/
@@ -14,8 +14,12 @@
 #    include <xmmintrin.h>
 #endif
 
-#define BLOCK_NUM  8
-#define BLOCK_MASK (BLOCK_NUM - 1)
+/*Each render thread has a set associative cache of BLOCK_NUM blocks, indexed
+  by a hash of the pipeline state. Within a set, the least recently used block
+  is recompiled.*/
+#define BLOCK_SETS 16
+#define BLOCK_WAYS 4
+#define BLOCK_NUM  (BLOCK_SETS * BLOCK_WAYS)
 #define BLOCK_SIZE 8192
 
 #define LOD_MASK   (LOD_TMIRROR_S | LOD_TMIRROR_T)
@@ -36,11 +40,9 @@ typedef struct voodoo_x86_data_t {
     uint32_t tLOD[2];
     uint32_t trexInit1;
     int      is_tiled;
+    uint32_t last_used;
 } voodoo_x86_data_t;
 
-static int last_block[4]          = { 0, 0 };
-static int next_block_to_write[4] = { 0, 0 };
-
 #define addbyte(val)                   \
     do {                               \
         code_block[block_pos++] = val; \
@@ -3132,29 +3134,45 @@ voodoo_generate(uint8_t *code_block, voodoo_t *voodoo, voodoo_params_t *params,
 }
 int voodoo_recomp = 0;
 
+static __inline uint32_t
+voodoo_block_hash(voodoo_t *voodoo, voodoo_params_t *params, voodoo_state_t *state)
+{
+    uint32_t hash = params->alphaMode;
+
+    hash = (hash * 0x9e3779b1) ^ params->fbzMode;
+    hash = (hash * 0x9e3779b1) ^ params->fogMode;
+    hash = (hash * 0x9e3779b1) ^ params->fbzColorPath;
+    hash = (hash * 0x9e3779b1) ^ params->textureMode[0];
+    hash = (hash * 0x9e3779b1) ^ params->textureMode[1];
+    hash = (hash * 0x9e3779b1) ^ (params->tLOD[0] & LOD_MASK) ^ ((params->tLOD[1] & LOD_MASK) << 1);
+    hash ^= (state->xdir & 2) ^ (voodoo->trexInit1[0] & (1 << 18)) ^ ((params->col_tiled || params->aux_tiled) ? 4 : 0);
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6d;
+    hash ^= hash >> 12;
+
+    return hash & (BLOCK_SETS - 1);
+}
+
 static inline void *
 voodoo_get_block(voodoo_t *voodoo, voodoo_params_t *params, voodoo_state_t *state, int odd_even)
 {
-    int                c;
-    int                b = last_block[odd_even];
-    voodoo_x86_data_t *data;
     voodoo_x86_data_t *codegen_data = voodoo->codegen_data;
-
-    for (c = 0; c < 8; c++) {
-        data = &codegen_data[odd_even + b * 4];
-
-        if (state->xdir == data->xdir && params->alphaMode == data->alphaMode && params->fbzMode == data->fbzMode && params->fogMode == data->fogMode && params->fbzColorPath == data->fbzColorPath && (voodoo->trexInit1[0] & (1 << 18)) == data->trexInit1 && params->textureMode[0] == data->textureMode[0] && params->textureMode[1] == data->textureMode[1] && (params->tLOD[0] & LOD_MASK) == data->tLOD[0] && (params->tLOD[1] & LOD_MASK) == data->tLOD[1] && ((params->col_tiled || params->aux_tiled) ? 1 : 0) == data->is_tiled) {
-            last_block[odd_even] = b;
-            return data->code_block;
+    voodoo_x86_data_t *set     = &codegen_data[(odd_even * BLOCK_NUM) + (voodoo_block_hash(voodoo, params, state) * BLOCK_WAYS)];
+    voodoo_x86_data_t *data    = set;
+    uint32_t           stamp   = ++voodoo->codegen_stamp[odd_even];
+
+    for (uint8_t c = 0; c < BLOCK_WAYS; c++) {
+        if (state->xdir == set[c].xdir && params->alphaMode == set[c].alphaMode && params->fbzMode == set[c].fbzMode && params->fogMode == set[c].fogMode && params->fbzColorPath == set[c].fbzColorPath && (voodoo->trexInit1[0] & (1 << 18)) == set[c].trexInit1 && params->textureMode[0] == set[c].textureMode[0] && params->textureMode[1] == set[c].textureMode[1] && (params->tLOD[0] & LOD_MASK) == set[c].tLOD[0] && (params->tLOD[1] & LOD_MASK) == set[c].tLOD[1] && ((params->col_tiled || params->aux_tiled) ? 1 : 0) == set[c].is_tiled) {
+            set[c].last_used = stamp;
+            voodoo->codegen_hits[odd_even]++;
+            return set[c].code_block;
         }
 
-        b = (b + 1) & 7;
+        if ((stamp - set[c].last_used) > (stamp - data->last_used))
+            data = &set[c];
     }
     voodoo_recomp++;
-    data = &codegen_data[odd_even + next_block_to_write[odd_even] * 4];
-#if 0
-    code_block = data->code_block;
-#endif
+    voodoo->codegen_misses[odd_even]++;
 
     voodoo_generate(data->code_block, voodoo, params, state, depth_op);
 
@@ -3169,8 +3187,7 @@ voodoo_get_block(voodoo_t *voodoo, voodoo_params_t *params, voodoo_state_t *stat
     data->tLOD[0]        = params->tLOD[0] & LOD_MASK;
     data->tLOD[1]        = params->tLOD[1] & LOD_MASK;
     data->is_tiled       = (params->col_tiled || params->aux_tiled) ? 1 : 0;
-
-    next_block_to_write[odd_even] = (next_block_to_write[odd_even] + 1) & 7;
+    data->last_used      = stamp;
 
     return data->code_block;
 }
@@ -3178,7 +3195,7 @@ voodoo_get_block(voodoo_t *voodoo, voodoo_params_t *params, voodoo_state_t *stat
 void
 voodoo_codegen_init(voodoo_t *voodoo)
 {
-    voodoo->codegen_data = plat_mmap(sizeof(voodoo_x86_data_t) * BLOCK_NUM * 4, 1);
+    voodoo->codegen_data = plat_mmap(sizeof(voodoo_x86_data_t) * BLOCK_NUM * voodoo->render_threads, 1);
 
     for (uint16_t c = 0; c < 256; c++) {
         int d[4];
@@ -3204,7 +3221,17 @@ voodoo_codegen_init(voodoo_t *voodoo)
 void
 voodoo_codegen_close(voodoo_t *voodoo)
 {
-    plat_munmap(voodoo->codegen_data, sizeof(voodoo_x86_data_t) * BLOCK_NUM * 4);
+    uint64_t hits   = 0;
+    uint64_t misses = 0;
+
+    for (int c = 0; c < voodoo->render_threads; c++) {
+        hits += voodoo->codegen_hits[c];
+        misses += voodoo->codegen_misses[c];
+    }
+    if (hits || misses)
+        voodoo_render_log("Voodoo recompiler: %" PRIu64 " block hits, %" PRIu64 " misses\n", hits, misses);
+
+    plat_munmap(voodoo->codegen_data, sizeof(voodoo_x86_data_t) * BLOCK_NUM * voodoo->render_threads);
 }
 
 #endif /*VIDEO_VOODOO_CODEGEN_X86_H*/
@@ -30,7 +30,13 @@
 
 #define TEX_DIRTY_SHIFT 10
 
-#define TEX_CACHE_MAX   64
+/*Decoded textures are cached in fixed size entries, large enough for a full
+  256x256 mip chain. The number of entries is set by the configured cache size
+  in megabytes, and entry memory is only allocated on first use. An entry is
+  about 600 KB, so the 32 MB setting holds 54 textures per TMU, fewer than the
+  64 of the old fixed size cache, and the 64 MB default holds 109.*/
+#define TEX_CACHE_ENTRY_SIZE ((256 * 256 + 256 * 256 + 128 * 128 + 64 * 64 + 32 * 32 + 16 * 16 + 8 * 8 + 4 * 4 + 2 * 2) * 4)
+#define TEX_HASH_SIZE        256
 
 #ifdef __cplusplus
 #    include <atomic>
@@ -104,6 +110,12 @@ enum {
 #define PARAM_FULL(x)    ((voodoo->params_write_idx - voodoo->params_read_idx[x]) >= PARAM_SIZE)
 #define PARAM_EMPTY(x)   (voodoo->params_read_idx[x] == voodoo->params_write_idx)
 
+/* The screen is split into bands of (1 << VOODOO_BAND_SHIFT) lines, dealt out
+   to the render threads in turn. Triangles are only rendered by the threads
+   owning a band they touch. */
+#define VOODOO_RENDER_THREADS_MAX 16
+#define VOODOO_BAND_SHIFT         3
+
 typedef struct
 {
     uint32_t addr_type;
@@ -228,18 +240,23 @@ typedef struct voodoo_params_t {
     int aux_tiled;
     int row_width;
     int aux_row_width;
+
+    int      y_origin;    /* Flipped Y origin at the time the triangle was queued. */
+    uint32_t render_mask; /* Render threads owning bands the triangle touches. */
 } voodoo_params_t;
 
 typedef struct texture_t {
     uint32_t   base;
     uint32_t   tLOD;
     atomic_int refcount;
-    atomic_int refcount_r[4];
+    atomic_int refcount_r[VOODOO_RENDER_THREADS_MAX];
     int        is16;
     uint32_t   palette_checksum;
     uint32_t   addr_start[4];
     uint32_t   addr_end[4];
     uint32_t  *data;
+    uint32_t   last_used;
+    int        hash_next;
 } texture_t;
 
 typedef struct vert_t {
@@ -266,6 +283,11 @@ typedef struct clip_t {
     int y_max;
 } clip_t;
 
+typedef struct voodoo_render_thread_params_t {
+    struct voodoo_t *voodoo;
+    int              index;
+} voodoo_render_thread_params_t;
+
 typedef struct voodoo_t {
     mem_mapping_t mapping;
 
@@ -362,25 +384,26 @@ typedef struct voodoo_t {
     int    ncc_dirty[2];
 
     thread_t *fifo_thread;
-    thread_t *render_thread[4];
+    thread_t *render_thread[VOODOO_RENDER_THREADS_MAX];
     event_t  *wake_fifo_thread;
     event_t  *wake_main_thread;
     event_t  *fifo_not_full_event;
-    event_t  *render_not_full_event[4];
-    event_t  *wake_render_thread[4];
+    event_t  *render_not_full_event[VOODOO_RENDER_THREADS_MAX];
+    event_t  *wake_render_thread[VOODOO_RENDER_THREADS_MAX];
 
     int voodoo_busy;
-    int render_voodoo_busy[4];
+    int render_voodoo_busy[VOODOO_RENDER_THREADS_MAX];
 
     int render_threads;
-    int odd_even_mask;
 
-    int pixel_count[4];
-    int texel_count[4];
+    voodoo_render_thread_params_t render_thread_params[VOODOO_RENDER_THREADS_MAX];
+
+    int pixel_count[VOODOO_RENDER_THREADS_MAX];
+    int texel_count[VOODOO_RENDER_THREADS_MAX];
     int tri_count;
     int frame_count;
-    int pixel_count_old[4];
-    int texel_count_old[4];
+    int pixel_count_old[VOODOO_RENDER_THREADS_MAX];
+    int texel_count_old[VOODOO_RENDER_THREADS_MAX];
     int wr_count;
     int rd_count;
     int tex_count;
@@ -411,7 +434,7 @@ typedef struct voodoo_t {
     atomic_int   cmd_written_fifo_2;
 
     voodoo_params_t params_buffer[PARAM_SIZE];
-    atomic_int      params_read_idx[4];
+    atomic_int      params_read_idx[VOODOO_RENDER_THREADS_MAX];
     atomic_int      params_write_idx;
 
     uint32_t   cmdfifo_base;
@@ -658,27 +681,42 @@ typedef struct voodoo_t {
     uint8_t  thefilterb[256][256];
     uint16_t purpleline[256][3];
 
-    texture_t texture_cache[2][TEX_CACHE_MAX];
-    uint8_t   texture_present[2][16384];
-    int       texture_last_removed;
+    texture_t *texture_cache[2];
+    int        texture_cache_entries;
+    int        texture_hash[2][TEX_HASH_SIZE];
+    uint32_t   texture_stamp;
+    uint16_t   texture_present[2][16384]; /*Number of cached textures using each page*/
+
+    /*Texture cache statistics*/
+    uint64_t texture_hits;
+    uint64_t texture_decodes;
+    int      texture_frame;
+    int      texture_frame_hits;
+    int      texture_frame_decodes;
 
     uint32_t palette_checksum[2];
     int      palette_dirty[2];
 
     uint64_t time;
-    int      render_time[4];
+    int      render_time[VOODOO_RENDER_THREADS_MAX];
 
     int      force_blit_count;
     int      can_blit;
     mutex_t *force_blit_mutex;
 
     int   use_recompiler;
+    int   use_avx2; /*let the recompiler use AVX2 where the host has it*/
     void *codegen_data;
 
+    /*Per render thread recompiler block cache state*/
+    uint32_t codegen_stamp[VOODOO_RENDER_THREADS_MAX];
+    uint64_t codegen_hits[VOODOO_RENDER_THREADS_MAX];
+    uint64_t codegen_misses[VOODOO_RENDER_THREADS_MAX];
+
     struct voodoo_set_t *set;
 
     uint8_t fifo_thread_run;
-    uint8_t render_thread_run[4];
+    uint8_t render_thread_run[VOODOO_RENDER_THREADS_MAX];
 
     uint8_t *vram;
     uint8_t *changedvram;
@@ -134,6 +134,17 @@ typedef struct monitor_t {
     struct blit_data_struct *mon_blit_data_ptr;
 } monitor_t;
 
+/* An area of a target buffer, in target buffer pixels. */
+typedef struct video_rect_t {
+    int x;
+    int y;
+    int w;
+    int h;
+} video_rect_t;
+
+/* Most damage rectangles passed with a blit; more are merged. */
+#define VIDEO_DAMAGE_MAX 16
+
 typedef struct monitor_settings_t {
     int mon_window_x; /* (C) window size and position info. */
     int mon_window_y;
@@ -255,6 +266,8 @@ extern void video_blit_memtoscreen_8(int x, int y, int w, int h);
 extern void video_blend_monitor(int x, int y, int monitor_index);
 extern void video_process_8_monitor(int x, int y, int monitor_index);
 extern void video_blit_memtoscreen_monitor(int x, int y, int w, int h, int monitor_index);
+extern void video_blit_memtoscreen_damage_monitor(int x, int y, int w, int h, const video_rect_t *damage, int num, int monitor_index);
+extern int  video_blit_damage_monitor(video_rect_t *rects, int max, int monitor_index);
 extern void video_blit_complete_monitor(int monitor_index);
 extern void video_wait_for_blit_monitor(int monitor_index);
 extern void video_wait_for_buffer_monitor(int monitor_index);
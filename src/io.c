@@ -78,6 +78,255 @@ io_log(const char *fmt, ...)
 #    define io_log(fmt, ...)
 #endif
 
+/* Compiled per-port dispatch, rebuilt from the handler lists above whenever
+   a handler is added or removed. For each access kind, a port has the flat
+   list of handler calls that access makes, in the order the lists would have
+   been walked: handlers of the access width at the port itself first, then
+   the narrower handlers that the access is split into. An access with a
+   single handler of its own width calls it directly. */
+#define IO_INB   0
+#define IO_INW   1
+#define IO_INL   2
+#define IO_OUTB  3
+#define IO_OUTW  4
+#define IO_OUTL  5
+#define IO_KINDS 6
+
+typedef struct io_step_t {
+    union {
+        uint8_t (*inb)(uint16_t addr, void *priv);
+        uint16_t (*inw)(uint16_t addr, void *priv);
+        uint32_t (*inl)(uint16_t addr, void *priv);
+
+        void (*outb)(uint16_t addr, uint8_t val, void *priv);
+        void (*outw)(uint16_t addr, uint16_t val, void *priv);
+        void (*outl)(uint16_t addr, uint32_t val, void *priv);
+    };
+
+    void   *priv;
+    uint8_t width;  /* Handler width in bytes. */
+    uint8_t offset; /* Byte offset of the handler's port from the accessed one. */
+} io_step_t;
+
+typedef struct io_map_t {
+    uint16_t num[IO_KINDS];
+    uint16_t first[IO_KINDS];
+
+    struct io_map_t *next; /* Retired maps only. */
+
+    io_step_t steps[];
+} io_map_t;
+
+static io_map_t *io_map[NPORTS];
+
+/* Maps replaced while a multi-handler access is in progress are only freed
+   once it has completed, as its handlers may remap I/O. */
+static io_map_t *io_map_retired = NULL;
+static int       io_map_busy    = 0;
+
+static int
+io_map_build(uint16_t port, io_step_t *steps, uint16_t *num, uint16_t *first)
+{
+    io_t *p;
+    int   n = 0;
+    int   i;
+
+#define IO_STEP(kind, fn, w, o, q)         \
+    do {                                   \
+        if (steps != NULL) {               \
+            steps[n].fn     = (q)->fn;     \
+            steps[n].priv   = (q)->priv;   \
+            steps[n].width  = (w);         \
+            steps[n].offset = (o);         \
+        }                                  \
+        n++;                               \
+        num[kind]++;                       \
+    } while (0)
+
+    memset(num, 0, IO_KINDS * sizeof(uint16_t));
+
+    first[IO_INB] = n;
+    for (p = io[port]; p != NULL; p = p->next) {
+        if (p->inb)
+            IO_STEP(IO_INB, inb, 1, 0, p);
+    }
+
+    first[IO_OUTB] = n;
+    for (p = io[port]; p != NULL; p = p->next) {
+        if (p->outb)
+            IO_STEP(IO_OUTB, outb, 1, 0, p);
+    }
+
+    first[IO_INW] = n;
+    for (p = io[port]; p != NULL; p = p->next) {
+        if (p->inw)
+            IO_STEP(IO_INW, inw, 2, 0, p);
+    }
+    for (i = 0; i < 2; i++) {
+        for (p = io[(port + i) & 0xffff]; p != NULL; p = p->next) {
+            if (p->inb && !p->inw)
+                IO_STEP(IO_INW, inb, 1, i, p);
+        }
+    }
+
+    first[IO_OUTW] = n;
+    for (p = io[port]; p != NULL; p = p->next) {
+        if (p->outw)
+            IO_STEP(IO_OUTW, outw, 2, 0, p);
+    }
+    for (i = 0; i < 2; i++) {
+        for (p = io[(port + i) & 0xffff]; p != NULL; p = p->next) {
+            if (p->outb && !p->outw)
+                IO_STEP(IO_OUTW, outb, 1, i, p);
+        }
+    }
+
+    first[IO_INL] = n;
+    for (p = io[port]; p != NULL; p = p->next) {
+        if (p->inl)
+            IO_STEP(IO_INL, inl, 4, 0, p);
+    }
+    for (i = 0; i < 4; i += 2) {
+        for (p = io[(port + i) & 0xffff]; p != NULL; p = p->next) {
+            if (p->inw && !p->inl)
+                IO_STEP(IO_INL, inw, 2, i, p);
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        for (p = io[(port + i) & 0xffff]; p != NULL; p = p->next) {
+            if (p->inb && !p->inw && !p->inl)
+                IO_STEP(IO_INL, inb, 1, i, p);
+        }
+    }
+
+    first[IO_OUTL] = n;
+    for (p = io[port]; p != NULL; p = p->next) {
+        if (p->outl)
+            IO_STEP(IO_OUTL, outl, 4, 0, p);
+    }
+    for (i = 0; i < 4; i += 2) {
+        for (p = io[(port + i) & 0xffff]; p != NULL; p = p->next) {
+            if (p->outw && !p->outl)
+                IO_STEP(IO_OUTL, outw, 2, i, p);
+        }
+    }
+    for (i = 0; i < 4; i++) {
+        for (p = io[(port + i) & 0xffff]; p != NULL; p = p->next) {
+            if (p->outb && !p->outw && !p->outl)
+                IO_STEP(IO_OUTL, outb, 1, i, p);
+        }
+    }
+
+#undef IO_STEP
+
+    return n;
+}
+
+static void
+io_map_free_retired(void)
+{
+    io_map_t *map;
+
+    while (io_map_retired != NULL) {
+        map            = io_map_retired;
+        io_map_retired = map->next;
+        free(map);
+    }
+}
+
+static void
+io_map_update(uint16_t port)
+{
+    io_map_t *map = NULL;
+    io_map_t *old = io_map[port];
+    uint16_t  num[IO_KINDS];
+    uint16_t  first[IO_KINDS];
+    int       n;
+
+    n = io_map_build(port, NULL, num, first);
+    if (n > 0) {
+        map = (io_map_t *) malloc(sizeof(io_map_t) + (n * sizeof(io_step_t)));
+        if (map == NULL)
+            fatal("io_map_update(): map malloc failed\n");
+        io_map_build(port, map->steps, map->num, map->first);
+        map->next = NULL;
+    }
+
+    io_map[port] = map;
+
+    if (old != NULL) {
+        if (io_map_busy) {
+            old->next      = io_map_retired;
+            io_map_retired = old;
+        } else
+            free(old);
+    }
+}
+
+/* A port's map also covers the handlers of the three ports above it, which
+   word and dword accesses can be split into. */
+static void
+io_map_update_range(uint16_t base, int size)
+{
+    for (int c = -3; c < size; c++)
+        io_map_update((base + c) & 0xffff);
+}
+
+static uint32_t
+io_map_read(io_step_t *step, int num, uint16_t port)
+{
+    uint32_t ret = 0xffffffff;
+    uint16_t addr;
+    int      shift;
+
+    io_map_busy++;
+    for (int i = 0; i < num; i++, step++) {
+        addr  = port + step->offset;
+        shift = step->offset << 3;
+        switch (step->width) {
+            case 1:
+                ret &= ((uint32_t) step->inb(addr, step->priv) << shift) | ~(0x000000ffU << shift);
+                break;
+            case 2:
+                ret &= ((uint32_t) step->inw(addr, step->priv) << shift) | ~(0x0000ffffU << shift);
+                break;
+            default:
+                ret &= step->inl(addr, step->priv);
+                break;
+        }
+    }
+    if (!--io_map_busy && (io_map_retired != NULL))
+        io_map_free_retired();
+
+    return ret;
+}
+
+static void
+io_map_write(io_step_t *step, int num, uint16_t port, uint32_t val)
+{
+    uint16_t addr;
+    int      shift;
+
+    io_map_busy++;
+    for (int i = 0; i < num; i++, step++) {
+        addr  = port + step->offset;
+        shift = step->offset << 3;
+        switch (step->width) {
+            case 1:
+                step->outb(addr, val >> shift, step->priv);
+                break;
+            case 2:
+                step->outw(addr, val >> shift, step->priv);
+                break;
+            default:
+                step->outl(addr, val, step->priv);
+                break;
+        }
+    }
+    if (!--io_map_busy && (io_map_retired != NULL))
+        io_map_free_retired();
+}
+
 void
 io_init(void)
 {
@@ -106,7 +355,12 @@ io_init(void)
 
         /* io[c] should be NULL. */
         io[c] = io_last[c] = NULL;
+
+        free(io_map[c]);
+        io_map[c] = NULL;
     }
+
+    io_map_free_retired();
 }
 
 void
@@ -149,6 +403,8 @@ io_sethandler_common(uint16_t base, int size,
 
         q = NULL;
     }
+
+    io_map_update_range(base, size);
 }
 
 void
@@ -186,6 +442,8 @@ io_removehandler_common(uint16_t base, int size,
             p = q;
         }
     }
+
+    io_map_update_range(base, size);
 }
 
 void
@@ -334,16 +592,41 @@ io_debug_check_addr(uint16_t addr)
 }
 #endif
 
+/* With cpu_idle_skip at 2, a guest that keeps reading the same values from
+   port 61h or the RTC is assumed to be waiting for one of them to change,
+   which can only happen when a timer fires, so skip to the next one. Loops
+   that alternate between two reads are caught too. The PIT counters are
+   deliberately left out: TSC calibration loops (such as Linux's
+   quick_pit_calibrate) read them back to back and measure how far the TSC
+   moves between counts, which skipping ahead would throw off. */
+#define IO_IDLE_POLL_READS 16
+
+static void
+io_idle_poll(uint16_t port, uint8_t val)
+{
+    static uint32_t last[2];
+    static int      count;
+    uint32_t        key = (port << 8) | val;
+
+    if ((key == last[0]) || (key == last[1])) {
+        if (++count >= IO_IDLE_POLL_READS) {
+            cycles -= cpu_idle_cycles(0);
+            count = 0;
+        }
+    } else
+        count = 0;
+
+    last[1] = last[0];
+    last[0] = key;
+}
+
 uint8_t
 inb(uint16_t port)
 {
-    uint8_t ret = 0xff;
-    io_t   *p;
-    io_t   *q;
-    int     found  = 0;
-#ifdef ENABLE_IO_LOG
-    int     qfound = 0;
-#endif
+    uint8_t    ret   = 0xff;
+    io_map_t  *map;
+    io_step_t *step;
+    int        found = 0;
 
     io_port = port;
 
@@ -352,30 +635,18 @@ inb(uint16_t port)
 #endif
 
     if ((pci_flags & FLAG_CONFIG_IO_ON) && (port >= pci_base) && (port < (pci_base + pci_size))) {
-        ret = pci_read(port, NULL);
+        ret   = pci_read(port, NULL);
         found = 1;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
     } else if ((pci_flags & FLAG_CONFIG_DEV0_IO_ON) && (port >= 0xc000) && (port < 0xc100)) {
-        ret = pci_read(port, NULL);
+        ret   = pci_read(port, NULL);
         found = 1;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
-    } else {
-        p = io[port];
-        while (p) {
-            q = p->next;
-            if (p->inb) {
-                ret &= p->inb(port, p->priv);
-                found |= 1;
-#ifdef ENABLE_IO_LOG
-                qfound++;
-#endif
-            }
-            p = q;
-        }
+    } else if ((map = io_map[port]) != NULL) {
+        found = map->num[IO_INB];
+        step  = &map->steps[map->first[IO_INB]];
+        if (found == 1)
+            ret = step->inb(port, step->priv);
+        else if (found)
+            ret = io_map_read(step, found, port);
     }
 
     if (amstrad_latch & 0x80000000) {
@@ -396,7 +667,10 @@ inb(uint16_t port)
         ret = 0xfe;
 #endif
 
-    io_log("[%04X:%08X] (%i, %i, %04i) in b(%04X) = %02X\n", CS, cpu_state.pc, in_smm, found, qfound, port, ret);
+    if ((cpu_idle_skip >= 2) && ((port == 0x61) || (port == 0x71)))
+        io_idle_poll(port, ret);
+
+    io_log("[%04X:%08X] (%i, %04i) in b(%04X) = %02X\n", CS, cpu_state.pc, in_smm, found, port, ret);
 
     return ret;
 }
@@ -404,12 +678,9 @@ inb(uint16_t port)
 void
 outb(uint16_t port, uint8_t val)
 {
-    io_t *p;
-    io_t *q;
-    int   found  = 0;
-#ifdef ENABLE_IO_LOG
-    int   qfound = 0;
-#endif
+    io_map_t  *map;
+    io_step_t *step;
+    int        found = 0;
 
     io_port = port;
     io_val  = val;
@@ -421,28 +692,16 @@ outb(uint16_t port, uint8_t val)
     if ((pci_flags & FLAG_CONFIG_IO_ON) && (port >= pci_base) && (port < (pci_base + pci_size))) {
         pci_write(port, val, NULL);
         found = 1;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
     } else if ((pci_flags & FLAG_CONFIG_DEV0_IO_ON) && (port >= 0xc000) && (port < 0xc100)) {
         pci_write(port, val, NULL);
         found = 1;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
-    } else {
-        p = io[port];
-        while (p) {
-            q = p->next;
-            if (p->outb) {
-                p->outb(port, val, p->priv);
-                found |= 1;
-#ifdef ENABLE_IO_LOG
-                qfound++;
-#endif
-            }
-            p = q;
-        }
+    } else if ((map = io_map[port]) != NULL) {
+        found = map->num[IO_OUTB];
+        step  = &map->steps[map->first[IO_OUTB]];
+        if (found == 1)
+            step->outb(port, val, step->priv);
+        else if (found)
+            io_map_write(step, found, port, val);
     }
 
     if (!found) {
@@ -453,7 +712,7 @@ outb(uint16_t port, uint8_t val)
 #endif
     }
 
-    io_log("[%04X:%08X] (%i, %i, %04i) outb(%04X, %02X)\n", CS, cpu_state.pc, in_smm, found, qfound, port, val);
+    io_log("[%04X:%08X] (%i, %04i) outb(%04X, %02X)\n", CS, cpu_state.pc, in_smm, found, port, val);
 
     return;
 }
@@ -461,14 +720,10 @@ outb(uint16_t port, uint8_t val)
 uint16_t
 inw(uint16_t port)
 {
-    io_t    *p;
-    io_t    *q;
-    uint16_t ret    = 0xffff;
-    int      found  = 0;
-#ifdef ENABLE_IO_LOG
-    int      qfound = 0;
-#endif
-    uint8_t  ret8[2];
+    uint16_t   ret   = 0xffff;
+    io_map_t  *map;
+    io_step_t *step;
+    int        found = 0;
 
     io_port = port;
 
@@ -477,48 +732,18 @@ inw(uint16_t port)
 #endif
 
     if ((pci_flags & FLAG_CONFIG_IO_ON) && (port >= pci_base) && (port < (pci_base + pci_size))) {
-        ret = pci_readw(port, NULL);
-        found = 2;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
+        ret   = pci_readw(port, NULL);
+        found = 1;
     } else if ((pci_flags & FLAG_CONFIG_DEV0_IO_ON) && (port >= 0xc000) && (port < 0xc100)) {
-        ret = pci_readw(port, NULL);
-        found = 2;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
-    } else {
-        p = io[port];
-        while (p) {
-            q = p->next;
-            if (p->inw) {
-                ret &= p->inw(port, p->priv);
-                found |= 2;
-#ifdef ENABLE_IO_LOG
-                qfound++;
-#endif
-            }
-            p = q;
-        }
-
-        ret8[0] = ret & 0xff;
-        ret8[1] = (ret >> 8) & 0xff;
-        for (uint8_t i = 0; i < 2; i++) {
-            p = io[(port + i) & 0xffff];
-            while (p) {
-                q = p->next;
-                if (p->inb && !p->inw) {
-                    ret8[i] &= p->inb(port + i, p->priv);
-                    found |= 1;
-#ifdef ENABLE_IO_LOG
-                    qfound++;
-#endif
-                }
-                p = q;
-            }
-        }
-        ret = (ret8[1] << 8) | ret8[0];
+        ret   = pci_readw(port, NULL);
+        found = 1;
+    } else if ((map = io_map[port]) != NULL) {
+        found = map->num[IO_INW];
+        step  = &map->steps[map->first[IO_INW]];
+        if ((found == 1) && (step->width == 2))
+            ret = step->inw(port, step->priv);
+        else if (found)
+            ret = io_map_read(step, found, port);
     }
 
     if (amstrad_latch & 0x80000000) {
@@ -533,7 +758,7 @@ inw(uint16_t port)
     if (!found)
         cycles -= io_delay;
 
-    io_log("[%04X:%08X] (%i, %i, %04i) in w(%04X) = %04X\n", CS, cpu_state.pc, in_smm, found, qfound, port, ret);
+    io_log("[%04X:%08X] (%i, %04i) in w(%04X) = %04X\n", CS, cpu_state.pc, in_smm, found, port, ret);
 
     return ret;
 }
@@ -541,12 +766,9 @@ inw(uint16_t port)
 void
 outw(uint16_t port, uint16_t val)
 {
-    io_t *p;
-    io_t *q;
-    int   found  = 0;
-#ifdef ENABLE_IO_LOG
-    int   qfound = 0;
-#endif
+    io_map_t  *map;
+    io_step_t *step;
+    int        found = 0;
 
     io_port = port;
     io_val  = val;
@@ -557,44 +779,17 @@ outw(uint16_t port, uint16_t val)
 
     if ((pci_flags & FLAG_CONFIG_IO_ON) && (port >= pci_base) && (port < (pci_base + pci_size))) {
         pci_writew(port, val, NULL);
-        found = 2;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
+        found = 1;
     } else if ((pci_flags & FLAG_CONFIG_DEV0_IO_ON) && (port >= 0xc000) && (port < 0xc100)) {
         pci_writew(port, val, NULL);
-        found = 2;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
-    } else {
-        p = io[port];
-        while (p) {
-            q = p->next;
-            if (p->outw) {
-                p->outw(port, val, p->priv);
-                found |= 2;
-#ifdef ENABLE_IO_LOG
-                qfound++;
-#endif
-            }
-            p = q;
-        }
-
-        for (uint8_t i = 0; i < 2; i++) {
-            p = io[(port + i) & 0xffff];
-            while (p) {
-                q = p->next;
-                if (p->outb && !p->outw) {
-                    p->outb(port + i, val >> (i << 3), p->priv);
-                    found |= 1;
-#ifdef ENABLE_IO_LOG
-                    qfound++;
-#endif
-                }
-                p = q;
-            }
-        }
+        found = 1;
+    } else if ((map = io_map[port]) != NULL) {
+        found = map->num[IO_OUTW];
+        step  = &map->steps[map->first[IO_OUTW]];
+        if ((found == 1) && (step->width == 2))
+            step->outw(port, val, step->priv);
+        else if (found)
+            io_map_write(step, found, port, val);
     }
 
     if (!found) {
@@ -605,7 +800,7 @@ outw(uint16_t port, uint16_t val)
 #endif
     }
 
-    io_log("[%04X:%08X] (%i, %i, %04i) outw(%04X, %04X)\n", CS, cpu_state.pc, in_smm, found, qfound, port, val);
+    io_log("[%04X:%08X] (%i, %04i) outw(%04X, %04X)\n", CS, cpu_state.pc, in_smm, found, port, val);
 
     return;
 }
@@ -613,15 +808,10 @@ outw(uint16_t port, uint16_t val)
 uint32_t
 inl(uint16_t port)
 {
-    io_t    *p;
-    io_t    *q;
-    uint32_t ret = 0xffffffff;
-    uint16_t ret16[2];
-    uint8_t  ret8[4];
-    int      found  = 0;
-#ifdef ENABLE_IO_LOG
-    int      qfound = 0;
-#endif
+    uint32_t   ret   = 0xffffffff;
+    io_map_t  *map;
+    io_step_t *step;
+    int        found = 0;
 
     io_port = port;
 
@@ -630,79 +820,18 @@ inl(uint16_t port)
 #endif
 
     if ((pci_flags & FLAG_CONFIG_IO_ON) && (port >= pci_base) && (port < (pci_base + pci_size))) {
-        ret = pci_readl(port, NULL);
-        found = 4;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
+        ret   = pci_readl(port, NULL);
+        found = 1;
     } else if ((pci_flags & FLAG_CONFIG_DEV0_IO_ON) && (port >= 0xc000) && (port < 0xc100)) {
-        ret = pci_readl(port, NULL);
-        found = 4;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
-    } else {
-        p = io[port];
-        while (p) {
-            q = p->next;
-            if (p->inl) {
-                ret &= p->inl(port, p->priv);
-                found |= 4;
-#ifdef ENABLE_IO_LOG
-                qfound++;
-#endif
-            }
-            p = q;
-        }
-
-        ret16[0] = ret & 0xffff;
-        ret16[1] = (ret >> 16) & 0xffff;
-        p        = io[port & 0xffff];
-        while (p) {
-            q = p->next;
-            if (p->inw && !p->inl) {
-                ret16[0] &= p->inw(port, p->priv);
-                found |= 2;
-#ifdef ENABLE_IO_LOG
-                qfound++;
-#endif
-            }
-            p = q;
-        }
-
-        p = io[(port + 2) & 0xffff];
-        while (p) {
-            q = p->next;
-            if (p->inw && !p->inl) {
-                ret16[1] &= p->inw(port + 2, p->priv);
-                found |= 2;
-#ifdef ENABLE_IO_LOG
-                qfound++;
-#endif
-            }
-            p = q;
-        }
-        ret = (ret16[1] << 16) | ret16[0];
-
-        ret8[0] = ret & 0xff;
-        ret8[1] = (ret >> 8) & 0xff;
-        ret8[2] = (ret >> 16) & 0xff;
-        ret8[3] = (ret >> 24) & 0xff;
-        for (uint8_t i = 0; i < 4; i++) {
-            p = io[(port + i) & 0xffff];
-            while (p) {
-                q = p->next;
-                if (p->inb && !p->inw && !p->inl) {
-                    ret8[i] &= p->inb(port + i, p->priv);
-                    found |= 1;
-#ifdef ENABLE_IO_LOG
-                    qfound++;
-#endif
-                }
-                p = q;
-            }
-        }
-        ret = (ret8[3] << 24) | (ret8[2] << 16) | (ret8[1] << 8) | ret8[0];
+        ret   = pci_readl(port, NULL);
+        found = 1;
+    } else if ((map = io_map[port]) != NULL) {
+        found = map->num[IO_INL];
+        step  = &map->steps[map->first[IO_INL]];
+        if ((found == 1) && (step->width == 4))
+            ret = step->inl(port, step->priv);
+        else if (found)
+            ret = io_map_read(step, found, port);
     }
 
     if (amstrad_latch & 0x80000000) {
@@ -717,7 +846,7 @@ inl(uint16_t port)
     if (!found)
         cycles -= io_delay;
 
-    io_log("[%04X:%08X] (%i, %i, %04i) in l(%04X) = %08X\n", CS, cpu_state.pc, in_smm, found, qfound, port, ret);
+    io_log("[%04X:%08X] (%i, %04i) in l(%04X) = %08X\n", CS, cpu_state.pc, in_smm, found, port, ret);
 
     return ret;
 }
@@ -725,13 +854,9 @@ inl(uint16_t port)
 void
 outl(uint16_t port, uint32_t val)
 {
-    io_t *p;
-    io_t *q;
-    int   found  = 0;
-#ifdef ENABLE_IO_LOG
-    int   qfound = 0;
-#endif
-    int   i      = 0;
+    io_map_t  *map;
+    io_step_t *step;
+    int        found = 0;
 
     io_port = port;
     io_val  = val;
@@ -742,61 +867,17 @@ outl(uint16_t port, uint32_t val)
 
     if ((pci_flags & FLAG_CONFIG_IO_ON) && (port >= pci_base) && (port < (pci_base + pci_size))) {
         pci_writel(port, val, NULL);
-        found = 4;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
+        found = 1;
     } else if ((pci_flags & FLAG_CONFIG_DEV0_IO_ON) && (port >= 0xc000) && (port < 0xc100)) {
         pci_writel(port, val, NULL);
-        found = 4;
-#ifdef ENABLE_IO_LOG
-        qfound = 1;
-#endif
-    } else {
-        p = io[port];
-        if (p) {
-            while (p) {
-                q = p->next;
-                if (p->outl) {
-                    p->outl(port, val, p->priv);
-                    found |= 4;
-#ifdef ENABLE_IO_LOG
-                    qfound++;
-#endif
-                }
-                p = q;
-            }
-        }
-
-        for (i = 0; i < 4; i += 2) {
-            p = io[(port + i) & 0xffff];
-            while (p) {
-                q = p->next;
-                if (p->outw && !p->outl) {
-                    p->outw(port + i, val >> (i << 3), p->priv);
-                    found |= 2;
-#ifdef ENABLE_IO_LOG
-                    qfound++;
-#endif
-                }
-                p = q;
-            }
-        }
-
-        for (i = 0; i < 4; i++) {
-            p = io[(port + i) & 0xffff];
-            while (p) {
-                q = p->next;
-                if (p->outb && !p->outw && !p->outl) {
-                    p->outb(port + i, val >> (i << 3), p->priv);
-                    found |= 1;
-#ifdef ENABLE_IO_LOG
-                    qfound++;
-#endif
-                }
-                p = q;
-            }
-        }
+        found = 1;
+    } else if ((map = io_map[port]) != NULL) {
+        found = map->num[IO_OUTL];
+        step  = &map->steps[map->first[IO_OUTL]];
+        if ((found == 1) && (step->width == 4))
+            step->outl(port, val, step->priv);
+        else if (found)
+            io_map_write(step, found, port, val);
     }
 
     if (!found) {
@@ -807,7 +888,7 @@ outl(uint16_t port, uint32_t val)
 #endif
     }
 
-    io_log("[%04X:%08X] (%i, %i, %04i) outl(%04X, %08X)\n", CS, cpu_state.pc, in_smm, found, qfound, port, val);
+    io_log("[%04X:%08X] (%i, %04i) outl(%04X, %08X)\n", CS, cpu_state.pc, in_smm, found, port, val);
 
     return;
 }
@@ -38,6 +38,7 @@
 #include <86box/mem.h>
 #include <86box/plat.h>
 #include <86box/rom.h>
+#include <86box/savestate.h>
 #include <86box/gdbstub.h>
 #ifdef USE_DYNAREC
 #    include "codegen_public.h"
@@ -111,6 +112,8 @@ int mem_a20_state = 0;
 int mmuflush = 0;
 int mmu_perm = 4;
 
+mmu_stats_t mmu_stats;
+
 #ifdef USE_NEW_DYNAREC
 uint64_t *byte_dirty_mask;
 uint64_t *byte_code_present_mask;
@@ -130,6 +133,21 @@ uint8_t              *_mem_exec[MEM_MAPPINGS_NO];
 static uint8_t       *page_lookupp; /* pagetable mmu_perm lookup */
 static uint8_t       *readlookupp;
 static uint8_t       *writelookupp;
+static uint8_t        readlookup_global[256];  /* ring entry maps a global page */
+static uint8_t        writelookup_global[256];
+static uint32_t       mmu_global_page = 0xffffffff; /* last translated page, if global */
+
+/* Paging-structure caches. An entry is valid while its gen matches mmu_walk_gen,
+   so every TLB flush drops them by bumping the generation. */
+typedef struct mmu_walk_entry_t {
+    uint32_t gen;
+    uint32_t pad;
+    uint64_t val;
+} mmu_walk_entry_t;
+
+static mmu_walk_entry_t mmu_pde_cache[1024]; /* non-PAE PDEs, by linear address bits 31:22 */
+static mmu_walk_entry_t mmu_pdpte_cache[4];  /* PAE PDPTEs, by linear address bits 31:30 */
+static uint32_t         mmu_walk_gen = 1;
 static mem_mapping_t *base_mapping;
 static mem_mapping_t *last_mapping;
 static mem_mapping_t *read_mapping_bus[MEM_MAPPINGS_NO];
@@ -147,9 +165,20 @@ static uint32_t       remap_start_addr2;
 #if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
 static size_t ram_size = 0;
 static size_t ram2_size = 0;
+static size_t ram2_map_size = 0; /* size ram2 was mapped with */
 #else
 static size_t ram_size = 0;
 #endif
+static size_t ram_map_size = 0; /* size ram was mapped with, padding included */
+static int    ram_huge  = 0; /* mem_hugepages the RAM and page table were allocated with */
+static int    ram_bound = 0; /* the RAM was placed on the NUMA node of the emulation thread */
+
+/* Pages written since the last checkpoint, one bit per 4k page of RAM, or NULL
+   while no checkpoint chain is active. Only the write handlers see writes, so
+   the fast write lookups are flushed whenever the map is cleared - the first
+   write to every page then goes through a handler that marks it. */
+static uint32_t *mem_dirty_map;
+static uint32_t  mem_dirty_pages;
 
 #ifdef ENABLE_MEM_LOG
 int mem_do_log = ENABLE_MEM_LOG;
@@ -178,6 +207,16 @@ mem_addr_is_ram(uint32_t addr)
            (mapping == &ram_mid_mapping2) || (mapping == &ram_remapped_mapping);
 }
 
+static __inline void
+mmu_walk_cache_flush(void)
+{
+    if (!++mmu_walk_gen) {
+        memset(mmu_pde_cache, 0x00, sizeof(mmu_pde_cache));
+        memset(mmu_pdpte_cache, 0x00, sizeof(mmu_pdpte_cache));
+        mmu_walk_gen = 1;
+    }
+}
+
 void
 resetreadlookup(void)
 {
@@ -201,6 +240,33 @@ resetreadlookup(void)
     writelnext = 0;
     pccache    = 0xffffffff;
     high_page  = 0;
+
+    mmu_walk_cache_flush();
+}
+
+static __inline void
+mem_dirty_mark(uint32_t addr)
+{
+    uint32_t page = addr >> 12;
+
+    if (mem_dirty_map && (page < mem_dirty_pages))
+        mem_dirty_map[page >> 5] |= ((uint32_t) 1 << (page & 31));
+}
+
+/* For the phys write paths, which store through the mapping's exec pointer
+   rather than by RAM offset. */
+static void
+mem_dirty_mark_ptr(const uint8_t *p)
+{
+    if (!mem_dirty_map)
+        return;
+
+    if ((p >= ram) && (p < (ram + ram_size)))
+        mem_dirty_mark(p - ram);
+#if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
+    else if (ram2 && (p >= ram2) && (p < (ram2 + ram2_size)))
+        mem_dirty_mark((p - ram2) + (1 << 30));
+#endif
 }
 
 void
@@ -221,6 +287,55 @@ flushmmucache(void)
         }
     }
     mmuflush++;
+    mmu_global_page = 0xffffffff;
+    mmu_walk_cache_flush();
+    mmu_stats.flushes++;
+
+    pccache  = (uint32_t) 0xffffffff;
+    pccache2 = (uint8_t *) 0xffffffff;
+
+#ifdef USE_DYNAREC
+    codegen_flush();
+#endif
+}
+
+/* CR3 reload. With CR4.PGE set, entries for global pages stay valid, so
+   task switches in guests that map their kernel global only refill the
+   per-process part of the TLB. */
+void
+flushmmucache_cr3(void)
+{
+    if (!(cr4 & CR4_PGE)) {
+        flushmmucache();
+        return;
+    }
+
+    for (uint16_t c = 0; c < 256; c++) {
+        if (readlookup[c] != (int) 0xffffffff) {
+            if (readlookup_global[c])
+                mmu_stats.globals_kept++;
+            else {
+                readlookup2[readlookup[c]] = LOOKUP_INV;
+                readlookupp[readlookup[c]] = 4;
+                readlookup[c]              = 0xffffffff;
+            }
+        }
+        if (writelookup[c] != (int) 0xffffffff) {
+            if (writelookup_global[c])
+                mmu_stats.globals_kept++;
+            else {
+                page_lookup[writelookup[c]]  = NULL;
+                page_lookupp[writelookup[c]] = 4;
+                writelookup2[writelookup[c]] = LOOKUP_INV;
+                writelookupp[writelookup[c]] = 4;
+                writelookup[c]               = 0xffffffff;
+            }
+        }
+    }
+    mmuflush++;
+    mmu_global_page = 0xffffffff;
+    mmu_walk_cache_flush();
+    mmu_stats.cr3_flushes++;
 
     pccache  = (uint32_t) 0xffffffff;
     pccache2 = (uint8_t *) 0xffffffff;
@@ -275,6 +390,15 @@ flushmmucache_nopc(void)
             writelookup[c]               = 0xffffffff;
         }
     }
+    mmu_global_page = 0xffffffff;
+    mmu_walk_cache_flush();
+    mmu_stats.flushes++;
+
+#ifdef USE_NEW_DYNAREC
+    /* Only the new recompiler needs to hear about these, it chains blocks
+       across the mappings being flushed. */
+    codegen_flush();
+#endif
 }
 
 void
@@ -308,6 +432,25 @@ mem_flush_write_page(uint32_t addr, uint32_t virt)
     }
 }
 
+void
+mem_mmu_stats_dump(void)
+{
+    pclog("MMU lookup cache statistics:\n");
+    pclog("  Read fills                : %" PRIu64 "\n", mmu_stats.read_fills);
+    pclog("  Write fills               : %" PRIu64 "\n", mmu_stats.write_fills);
+    pclog("  Full flushes              : %" PRIu64 "\n", mmu_stats.flushes);
+    pclog("  CR3 flushes (PGE)         : %" PRIu64 "\n", mmu_stats.cr3_flushes);
+    pclog("  Global entries kept       : %" PRIu64 "\n", mmu_stats.globals_kept);
+    pclog("  PDE cache hits / misses   : %" PRIu64 " / %" PRIu64 "\n", mmu_stats.pde_hits, mmu_stats.pde_misses);
+    pclog("  PDPTE cache hits / misses : %" PRIu64 " / %" PRIu64 "\n", mmu_stats.pdpte_hits, mmu_stats.pdpte_misses);
+}
+
+void
+mem_mmu_stats_reset(void)
+{
+    memset(&mmu_stats, 0, sizeof(mmu_stats_t));
+}
+
 #define mmutranslate_read(addr)  mmutranslatereal(addr, 0)
 #define mmutranslate_write(addr) mmutranslatereal(addr, 1)
 #define mmutranslate_execute(addr) mmutranslatereal(addr, 2)
@@ -317,16 +460,23 @@ mem_flush_write_page(uint32_t addr, uint32_t virt)
 static __inline uint64_t
 mmutranslatereal_normal(uint32_t addr, int rw)
 {
-    uint32_t temp;
-    uint32_t temp2;
-    uint32_t temp3;
-    uint32_t addr2;
+    mmu_walk_entry_t *pde = &mmu_pde_cache[addr >> 22];
+    uint32_t          temp;
+    uint32_t          temp2;
+    uint32_t          temp3;
+    uint32_t          addr2;
 
     if (cpu_state.abrt)
         return 0xffffffffffffffffULL;
 
     addr2 = ((cr3 & ~0xfff) + ((addr >> 20) & 0xffc));
-    temp = temp2 = rammap(addr2);
+    if (pde->gen == mmu_walk_gen) {
+        temp = temp2 = (uint32_t) pde->val;
+        mmu_stats.pde_hits++;
+    } else {
+        temp = temp2 = rammap(addr2);
+        mmu_stats.pde_misses++;
+    }
     if (!(temp & 1)) {
         cr2 = addr;
         temp &= 1;
@@ -357,6 +507,8 @@ mmutranslatereal_normal(uint32_t addr, int rw)
         mmu_perm = temp & 4;
         rammap(addr2) |= ((rw == 1) ? 0x60 : 0x20);
 
+        mmu_global_page = ((temp & 0x100) && (cr4 & CR4_PGE)) ? (addr >> 12) : 0xffffffff;
+
         uint64_t page = temp & ~0x3fffff;
         if (cpu_features & CPU_FEATURE_PSE36)
             page |= (uint64_t) (temp & 0x1e000) << 19;
@@ -378,29 +530,47 @@ mmutranslatereal_normal(uint32_t addr, int rw)
     }
 
     mmu_perm = temp & 4;
-    rammap(addr2) |= 0x20;
+    if (pde->gen != mmu_walk_gen) {
+        /* Only page table PDEs are cached, once their accessed bit is set. */
+        rammap(addr2) |= 0x20;
+        pde->gen = mmu_walk_gen;
+        pde->val = temp2 | 0x20;
+    }
     rammap((temp2 & ~0xfff) + ((addr >> 10) & 0xffc)) |= ((rw == 1) ? 0x60 : 0x20);
 
+    mmu_global_page = ((temp & 0x100) && (cr4 & CR4_PGE)) ? (addr >> 12) : 0xffffffff;
+
     return (uint64_t) ((temp & ~0xfff) + (addr & 0xfff));
 }
 
 static __inline uint64_t
 mmutranslatereal_pae(uint32_t addr, int rw)
 {
-    uint64_t temp;
-    uint64_t temp2;
-    uint64_t temp3;
-    uint64_t temp4;
-    uint64_t addr2;
-    uint64_t addr3;
-    uint64_t addr4;
-    uint64_t nxbit;
+    mmu_walk_entry_t *pdpte = &mmu_pdpte_cache[addr >> 30];
+    uint64_t          temp;
+    uint64_t          temp2;
+    uint64_t          temp3;
+    uint64_t          temp4;
+    uint64_t          addr2;
+    uint64_t          addr3;
+    uint64_t          addr4;
+    uint64_t          nxbit;
 
     if (cpu_state.abrt)
         return 0xffffffffffffffffULL;
 
     addr2 = (cr3 & ~0x1f) + ((addr >> 27) & 0x18);
-    temp = temp2 = rammap64(addr2) & 0x000000ffffffffffULL;
+    if (pdpte->gen == mmu_walk_gen) {
+        temp = temp2 = pdpte->val;
+        mmu_stats.pdpte_hits++;
+    } else {
+        temp = temp2 = rammap64(addr2) & 0x000000ffffffffffULL;
+        mmu_stats.pdpte_misses++;
+        if (temp & 1) {
+            pdpte->gen = mmu_walk_gen;
+            pdpte->val = temp;
+        }
+    }
     if (!(temp & 1)) {
         cr2 = addr;
         temp &= 1;
@@ -457,6 +627,8 @@ mmutranslatereal_pae(uint32_t addr, int rw)
         mmu_perm = temp & 4;
         rammap64(addr3) |= ((rw == 1) ? 0x60 : 0x20);
 
+        mmu_global_page = ((temp & 0x100) && (cr4 & CR4_PGE)) ? (addr >> 12) : 0xffffffff;
+
         return ((temp & ~0x1fffffULL) + (addr & 0x1fffffULL)) & 0x000000ffffffffffULL;
     }
 
@@ -491,6 +663,8 @@ mmutranslatereal_pae(uint32_t addr, int rw)
     rammap64(addr3) |= 0x20;
     rammap64(addr4) |= ((rw == 1) ? 0x60 : 0x20);
 
+    mmu_global_page = ((temp & 0x100) && (cr4 & CR4_PGE)) ? (addr >> 12) : 0xffffffff;
+
     return ((temp & ~0x8000000000000fffULL) + ((uint64_t) (addr & 0xfff))) & 0x000000ffffffffffULL;
 }
 
@@ -665,8 +839,10 @@ addreadlookup(uint32_t virt, uint32_t phys)
 #endif
     readlookupp[virt >> 12] = mmu_perm;
 
-    readlookup[readlnext++] = virt >> 12;
+    readlookup_global[readlnext] = (cr0 & 0x80000000) && (mmu_global_page == (virt >> 12));
+    readlookup[readlnext++]      = virt >> 12;
     readlnext &= (cachesize - 1);
+    mmu_stats.read_fills++;
 
     cycles -= 9;
 }
@@ -718,8 +894,10 @@ addwritelookup(uint32_t virt, uint32_t phys)
     }
     writelookupp[virt >> 12] = mmu_perm;
 
-    writelookup[writelnext++] = virt >> 12;
+    writelookup_global[writelnext] = (cr0 & 0x80000000) && (mmu_global_page == (virt >> 12));
+    writelookup[writelnext++]      = virt >> 12;
     writelnext &= (cachesize - 1);
+    mmu_stats.write_fills++;
 
     cycles -= 9;
 }
@@ -1997,9 +2175,10 @@ mem_writeb_phys(uint32_t addr, uint8_t val)
     mem_logical_addr = 0xffffffff;
 
     if (map) {
-        if (cpu_use_exec && map->exec)
+        if (cpu_use_exec && map->exec) {
             map->exec[(addr - map->base) & map->mask] = val;
-        else if (map->write_b)
+            mem_dirty_mark_ptr(&map->exec[(addr - map->base) & map->mask]);
+        } else if (map->write_b)
             map->write_b(addr, val, map->priv);
     }
 }
@@ -2015,6 +2194,8 @@ mem_writew_phys(uint32_t addr, uint16_t val)
     if (cpu_use_exec && ((addr & MEM_GRANULARITY_MASK) <= MEM_GRANULARITY_HBOUND) && (map && map->exec)) {
         p  = (uint16_t *) &(map->exec[(addr - map->base) & map->mask]);
         *p = val;
+        mem_dirty_mark_ptr((uint8_t *) p);
+        mem_dirty_mark_ptr((uint8_t *) p + 1);
     } else if (((addr & MEM_GRANULARITY_MASK) <= MEM_GRANULARITY_HBOUND) && (map && map->write_w))
         map->write_w(addr, val, map->priv);
     else {
@@ -2034,6 +2215,8 @@ mem_writel_phys(uint32_t addr, uint32_t val)
     if (cpu_use_exec && ((addr & MEM_GRANULARITY_MASK) <= MEM_GRANULARITY_QBOUND) && (map && map->exec)) {
         p  = (uint32_t *) &(map->exec[(addr - map->base) & map->mask]);
         *p = val;
+        mem_dirty_mark_ptr((uint8_t *) p);
+        mem_dirty_mark_ptr((uint8_t *) p + 3);
     } else if (((addr & MEM_GRANULARITY_MASK) <= MEM_GRANULARITY_QBOUND) && (map && map->write_l))
         map->write_l(addr, val, map->priv);
     else {
@@ -2329,6 +2512,7 @@ mem_write_ram(uint32_t addr, uint8_t val, UNUSED(void *priv))
     if ((addr >= 0xa0000) && (addr <= 0xbffff))
         mem_log("Write B       %02X to   %08X\n", val, addr);
 #endif
+    mem_dirty_mark(addr);
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramb_page(addr, val, &pages[addr >> 12]);
@@ -2343,6 +2527,8 @@ mem_write_ramw(uint32_t addr, uint16_t val, UNUSED(void *priv))
     if ((addr >= 0xa0000) && (addr <= 0xbffff))
         mem_log("Write W     %04X to   %08X\n", val, addr);
 #endif
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 1);
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramw_page(addr, val, &pages[addr >> 12]);
@@ -2357,6 +2543,8 @@ mem_write_raml(uint32_t addr, uint32_t val, UNUSED(void *priv))
     if ((addr >= 0xa0000) && (addr <= 0xbffff))
         mem_log("Write L %08X to   %08X\n", val, addr);
 #endif
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 3);
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_raml_page(addr, val, &pages[addr >> 12]);
@@ -2423,6 +2611,7 @@ mem_write_remapped(uint32_t addr, uint8_t val, UNUSED(void *priv))
 {
     uint32_t oldaddr = addr;
     addr             = 0xA0000 + (addr - remap_start_addr);
+    mem_dirty_mark(addr);
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramb_page(addr, val, &pages[oldaddr >> 12]);
@@ -2435,6 +2624,8 @@ mem_write_remappedw(uint32_t addr, uint16_t val, UNUSED(void *priv))
 {
     uint32_t oldaddr = addr;
     addr             = 0xA0000 + (addr - remap_start_addr);
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 1);
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramw_page(addr, val, &pages[oldaddr >> 12]);
@@ -2447,6 +2638,8 @@ mem_write_remappedl(uint32_t addr, uint32_t val, UNUSED(void *priv))
 {
     uint32_t oldaddr = addr;
     addr             = 0xA0000 + (addr - remap_start_addr);
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 3);
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_raml_page(addr, val, &pages[oldaddr >> 12]);
@@ -2459,6 +2652,7 @@ mem_write_remapped2(uint32_t addr, uint8_t val, UNUSED(void *priv))
 {
     uint32_t oldaddr = addr;
     addr             = 0xD0000 + (addr - remap_start_addr2);
+    mem_dirty_mark(addr);
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramb_page(addr, val, &pages[oldaddr >> 12]);
@@ -2471,6 +2665,8 @@ mem_write_remappedw2(uint32_t addr, uint16_t val, UNUSED(void *priv))
 {
     uint32_t oldaddr = addr;
     addr             = 0xD0000 + (addr - remap_start_addr2);
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 1);
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_ramw_page(addr, val, &pages[oldaddr >> 12]);
@@ -2483,6 +2679,8 @@ mem_write_remappedl2(uint32_t addr, uint32_t val, UNUSED(void *priv))
 {
     uint32_t oldaddr = addr;
     addr             = 0xD0000 + (addr - remap_start_addr2);
+    mem_dirty_mark(addr);
+    mem_dirty_mark(addr + 3);
     if (cpu_use_exec) {
         addwritelookup(mem_logical_addr, addr);
         mem_write_raml_page(addr, val, &pages[oldaddr >> 12]);
@@ -2996,10 +3194,46 @@ mem_zero(void)
 {
 #if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
     if (mem_size > 1048576)
-        memset(ram2, 0x00, ram2_size + 16);
+        memset(ram2, 0x00, ram2_map_size);
+#endif
+
+    memset(ram, 0x00, ram_map_size);
+}
+
+/* Clear a newly allocated RAM block. In density mode, the host is allowed to
+   merge its pages with those of other instances instead, and the block is not
+   touched, as a fresh mapping is already zeroed; this way, the RAM the guest
+   does not use is never made resident. */
+static void
+mem_ram_prepare(uint8_t *ptr, size_t size)
+{
+    if (density_mode)
+        plat_mem_mergeable(ptr, size);
+    else
+        memset(ptr, 0x00, size);
+}
+
+/* Place the RAM and the page table on the NUMA node of the emulation thread,
+   the first time this is called on that thread after they are allocated. */
+void
+mem_numa_update(void)
+{
+    int node;
+
+    if (!mem_numa || ram_bound || (ram == NULL))
+        return;
+
+    ram_bound = 1;
+    node      = plat_mem_bind_node(ram, ram_size);
+#if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
+    if ((ram2 != NULL) && (ram2 != &(ram[1 << 30])))
+        plat_mem_bind_node(ram2, ram2_size);
 #endif
+    if (pages != NULL)
+        plat_mem_bind_node(pages, pages_sz * sizeof(page_t));
 
-    memset(ram, 0x00, ram_size + 16);
+    if (node >= 0)
+        pclog("MEM: RAM placed on NUMA node %i\n", node);
 }
 
 /* Reset the memory state. */
@@ -3022,42 +3256,53 @@ mem_reset(void)
     }
 #endif
 
+    /* The RAM is about to be reallocated, which breaks any checkpoint chain. */
+    mem_dirty_stop();
+
     /* Free the old pages array, if necessary. */
     if (pages) {
-        free(pages);
+        plat_munmap_ram(pages, pages_sz * sizeof(page_t), ram_huge);
         pages = NULL;
     }
 
     if (ram != NULL) {
-        plat_munmap(ram, ram_size);
-        ram      = NULL;
-        ram_size = 0;
+        plat_munmap_ram(ram, ram_map_size, ram_huge);
+        ram          = NULL;
+        ram_size     = 0;
+        ram_map_size = 0;
     }
 #if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
-    if (ram2 != NULL) {
-        plat_munmap(ram2, ram2_size);
-        ram2      = NULL;
-        ram2_size = 0;
-    }
+    /* ram2 only has a mapping of its own when it was mapped separately,
+       otherwise it points into ram. */
+    if ((ram2 != NULL) && (ram2_map_size != 0))
+        plat_munmap_ram(ram2, ram2_map_size, ram_huge);
+    ram2          = NULL;
+    ram2_size     = 0;
+    ram2_map_size = 0;
 
     if (mem_size > 2097152)
         mem_size = 2097152;
 #endif
 
+    ram_huge  = mem_hugepages;
+    ram_bound = 0;
+
     m = 1024UL * (size_t) mem_size;
 
 #if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
     if (mem_size > 1048576) {
-        ram_size = 1 << 30;
-        ram      = (uint8_t *) plat_mmap(ram_size, 0); /* allocate and clear the RAM block of the first 1 GB */
+        ram_size     = 1 << 30;
+        ram_map_size = ram_size;
+        ram          = (uint8_t *) plat_mmap_ram(ram_map_size, ram_huge); /* allocate and clear the RAM block of the first 1 GB */
         if (ram == NULL) {
             fatal("Failed to allocate primary RAM block. Make sure you have enough RAM available.\n");
             return;
         }
-        memset(ram, 0x00, ram_size);
-        ram2_size = m - (1 << 30);
+        mem_ram_prepare(ram, ram_size);
+        ram2_size     = m - (1 << 30);
         /* Allocate 16 extra bytes of RAM to mitigate some dynarec recompiler memory access quirks. */
-        ram2      = (uint8_t *) plat_mmap(ram2_size + 16, 0); /* allocate and clear the RAM block above 1 GB */
+        ram2_map_size = ram2_size + 16;
+        ram2          = (uint8_t *) plat_mmap_ram(ram2_map_size, ram_huge); /* allocate and clear the RAM block above 1 GB */
         if (ram2 == NULL) {
             if (config_changed == 2)
                 fatal(EMU_NAME " must be restarted for the memory amount change to be applied.\n");
@@ -3065,18 +3310,19 @@ mem_reset(void)
                 fatal("Failed to allocate secondary RAM block. Make sure you have enough RAM available.\n");
             return;
         }
-        memset(ram2, 0x00, ram2_size + 16);
+        mem_ram_prepare(ram2, ram2_size + 16);
     } else
 #endif
     {
-        ram_size = m;
+        ram_size     = m;
         /* Allocate 16 extra bytes of RAM to mitigate some dynarec recompiler memory access quirks. */
-        ram      = (uint8_t *) plat_mmap(ram_size + 16, 0); /* allocate and clear the RAM block */
+        ram_map_size = ram_size + 16;
+        ram          = (uint8_t *) plat_mmap_ram(ram_map_size, ram_huge); /* allocate and clear the RAM block */
         if (ram == NULL) {
             fatal("Failed to allocate RAM block. Make sure you have enough RAM available.\n");
             return;
         }
-        memset(ram, 0x00, ram_size + 16);
+        mem_ram_prepare(ram, ram_size + 16);
 #if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
         if (mem_size > 1048576)
             ram2 = &(ram[1 << 30]);
@@ -3110,7 +3356,7 @@ mem_reset(void)
      * Allocate and initialize the (new) page table.
      */
     pages_sz = m;
-    pages    = (page_t *) malloc(m * sizeof(page_t));
+    pages    = (page_t *) plat_mmap_ram(m * sizeof(page_t), ram_huge);
 
     memset(page_lookup, 0x00, (1 << 20) * sizeof(page_t *));
     memset(page_lookupp, 0x04, (1 << 20) * sizeof(uint8_t));
@@ -3437,6 +3683,149 @@ mem_remap_top_nomid(int kb)
     mem_remap_top_ex_nomid(kb, (mem_size >= 1024) ? mem_size : 1024);
 }
 
+#define MEM_STATE_ZERO 0 /* page is all zeroes */
+#define MEM_STATE_FILL 1 /* page is one repeated byte, which follows */
+#define MEM_STATE_DATA 2 /* the page contents follow, packed */
+#define MEM_STATE_SAME 3 /* delta states only: page unchanged since the parent */
+
+static uint8_t *
+mem_state_page(uint32_t addr)
+{
+#if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
+    if (addr >= (1 << 30))
+        return &ram2[addr - (1 << 30)];
+#endif
+    return &ram[addr];
+}
+
+/* Start, or restart, tracking the pages written from now on. */
+void
+mem_dirty_start(void)
+{
+    uint32_t words = ((mem_size >> 2) + 31) >> 5;
+
+    if (mem_dirty_map && (mem_dirty_pages != (mem_size >> 2)))
+        mem_dirty_stop();
+
+    if (mem_dirty_map)
+        memset(mem_dirty_map, 0x00, words * sizeof(uint32_t));
+    else {
+        mem_dirty_map   = (uint32_t *) calloc(words, sizeof(uint32_t));
+        mem_dirty_pages = mem_dirty_map ? (mem_size >> 2) : 0;
+    }
+
+    flushmmucache();
+}
+
+void
+mem_dirty_stop(void)
+{
+    free(mem_dirty_map);
+    mem_dirty_map   = NULL;
+    mem_dirty_pages = 0;
+}
+
+int
+mem_dirty_active(void)
+{
+    return mem_dirty_map != NULL;
+}
+
+/* Guest RAM is stored one tag byte per 4k page, so that the zeroed memory
+   most guests leave alone costs a single byte per page, and other pages are
+   packed. A delta state only stores the pages written since the parent
+   state was taken. */
+void
+mem_save_state(savestate_t *state)
+{
+    uint32_t pages_nr = mem_size >> 2;
+    int      delta    = savestate_is_delta(state);
+    uint8_t  tag;
+
+    savestate_write_var(state, mem_size);
+    savestate_write_var(state, mem_a20_key);
+    savestate_write_var(state, mem_a20_alt);
+
+    for (uint32_t c = 0; c < pages_nr; c++) {
+        const uint8_t *page = mem_state_page(c << 12);
+        int            d;
+
+        if (delta && !(mem_dirty_map[c >> 5] & ((uint32_t) 1 << (c & 31)))) {
+            tag = MEM_STATE_SAME;
+            savestate_write_var(state, tag);
+            continue;
+        }
+
+        for (d = 1; d < 4096; d++) {
+            if (page[d] != page[0])
+                break;
+        }
+
+        if (d < 4096) {
+            tag = MEM_STATE_DATA;
+            savestate_write_var(state, tag);
+            savestate_write_block(state, page, 4096);
+        } else if (page[0]) {
+            tag = MEM_STATE_FILL;
+            savestate_write_var(state, tag);
+            savestate_write(state, page, 1);
+        } else {
+            tag = MEM_STATE_ZERO;
+            savestate_write_var(state, tag);
+        }
+    }
+}
+
+void
+mem_load_state(savestate_t *state)
+{
+    uint32_t pages_nr = mem_size >> 2;
+    uint32_t size;
+    uint8_t  tag;
+    uint8_t  fill;
+
+    savestate_read_var(state, size);
+    if (size != mem_size) {
+        pclog("Save state has %u KB of RAM, the machine has %u KB\n", size, mem_size);
+        savestate_set_error(state);
+        return;
+    }
+    savestate_read_var(state, mem_a20_key);
+    savestate_read_var(state, mem_a20_alt);
+
+    for (uint32_t c = 0; c < pages_nr; c++) {
+        uint8_t *page = mem_state_page(c << 12);
+
+        tag = 0xff;
+        savestate_read_var(state, tag);
+        switch (tag) {
+            case MEM_STATE_ZERO:
+                memset(page, 0x00, 4096);
+                break;
+            case MEM_STATE_FILL:
+                savestate_read_var(state, fill);
+                memset(page, fill, 4096);
+                break;
+            case MEM_STATE_DATA:
+                savestate_read_block(state, page, 4096);
+                break;
+            case MEM_STATE_SAME:
+                if (savestate_is_delta(state))
+                    break;
+                fallthrough;
+            default:
+                savestate_set_error(state);
+                return;
+        }
+    }
+
+    /* mem_a20_recalc() only updates rammask and flushes the MMU cache when the
+       gate changes, so start from the opposite of the restored state to make
+       it always do both. */
+    mem_a20_state = !(mem_a20_key | mem_a20_alt);
+    mem_a20_recalc();
+}
+
 void
 mem_reset_page_blocks(void)
 {
@@ -329,6 +329,33 @@ rom_load_linear_oddeven(const char *fn, uint32_t addr, int sz, int off, uint8_t
     return 1;
 }
 
+/* In density mode, images that are loaded as they are, at the start of their
+   buffer, are mapped copy-on-write instead, so that instances running off the
+   same ROM files share the memory of them. */
+static uint8_t *
+rom_map(const char *fn, uint32_t addr, int sz, int off)
+{
+    FILE    *fp;
+    uint8_t *ptr = NULL;
+
+    if (!density_mode || (addr != 0) || (sz <= 0) || (off < 0))
+        return NULL;
+
+    fp = rom_fopen(fn, "rb");
+    if (fp == NULL)
+        return NULL;
+
+    if ((fseeko64(fp, 0, SEEK_END) == 0) && (ftello64(fp) >= ((int64_t) off + sz)))
+        ptr = (uint8_t *) plat_mmap_file(fp, off, sz, 1);
+
+    (void) fclose(fp);
+
+    if (ptr != NULL)
+        rom_log("ROM: mapped %i bytes of '%s'\n", sz, fn);
+
+    return ptr;
+}
+
 /* Load a ROM BIOS from its chips, interleaved mode. */
 int
 rom_load_linear(const char *fn, uint32_t addr, int sz, int off, uint8_t *ptr)
@@ -457,6 +484,9 @@ bios_normalize(int n, int up)
     return temp_n;
 }
 
+/* Size of the mapping, if the BIOS ROM is mapped. */
+static size_t rom_mapped = 0;
+
 static uint8_t *
 rom_reset(uint32_t addr, int sz)
 {
@@ -470,8 +500,12 @@ rom_reset(uint32_t addr, int sz)
     /* If not done yet, allocate a 128KB buffer for the BIOS ROM. */
     if (rom != NULL) {
         rom_log("ROM allocated, freeing...\n");
-        free(rom);
-        rom = NULL;
+        if (rom_mapped)
+            plat_munmap_file(rom, rom_mapped);
+        else
+            free(rom);
+        rom        = NULL;
+        rom_mapped = 0;
     }
     rom_log("Allocating ROM...\n");
     rom = (uint8_t *) malloc(biosmask + 1);
@@ -577,8 +611,9 @@ bios_add(void)
 int
 bios_load(const char *fn1, const char *fn2, uint32_t addr, int sz, int off, int flags)
 {
-    uint8_t  ret = 0;
-    uint8_t *ptr = NULL;
+    uint8_t  ret    = 0;
+    uint8_t *ptr    = NULL;
+    uint8_t *mapped = NULL;
     int      old_sz = sz;
 
     /*
@@ -598,7 +633,15 @@ bios_load(const char *fn1, const char *fn2, uint32_t addr, int sz, int off, int
         rom_log("%sing %i bytes of %sBIOS starting with ptr[%08X] (ptr = %08X)\n", (bios_only) ? "Check" : "Load", sz, (flags & FLAG_AUX) ? "auxiliary " : "", addr - biosaddr, ptr);
 #endif
 
-    if (flags & FLAG_INT)
+    if (!bios_only && !(flags & (FLAG_AUX | FLAG_INT | FLAG_INV)) && (sz == (biosmask + 1)))
+        mapped = rom_map(fn1, addr - biosaddr, sz, off);
+
+    if (mapped != NULL) {
+        free(rom);
+        rom = ptr  = mapped;
+        rom_mapped = sz;
+        ret        = 1;
+    } else if (flags & FLAG_INT)
         ret = rom_load_interleaved(fn1, fn2, addr - biosaddr, sz, off, ptr);
     else {
         if (flags & FLAG_INV)
@@ -667,16 +710,21 @@ rom_init(rom_t *rom, const char *fn, uint32_t addr, int sz, int mask, int off, u
 {
     rom_log("rom_init(%08X, %s, %08X, %08X, %08X, %08X, %08X)\n", rom, fn, addr, sz, mask, off, flags);
 
-    /* Allocate a buffer for the image. */
-    rom->rom = malloc(sz);
-    memset(rom->rom, 0xff, sz);
+    rom->rom    = rom_map(fn, (addr >= 0x40000) ? 0 : (addr & 0x03ffff), sz, off);
+    rom->mapped = (rom->rom != NULL);
 
-    /* Load the image file into the buffer. */
-    if (!rom_load_linear(fn, addr, sz, off, rom->rom)) {
-        /* Nope.. clean up. */
-        free(rom->rom);
-        rom->rom = NULL;
-        return (-1);
+    if (!rom->mapped) {
+        /* Allocate a buffer for the image. */
+        rom->rom = malloc(sz);
+        memset(rom->rom, 0xff, sz);
+
+        /* Load the image file into the buffer. */
+        if (!rom_load_linear(fn, addr, sz, off, rom->rom)) {
+            /* Nope.. clean up. */
+            free(rom->rom);
+            rom->rom = NULL;
+            return (-1);
+        }
     }
 
     rom->sz   = sz;
@@ -700,6 +748,8 @@ rom_init_oddeven(rom_t *rom, const char *fn, uint32_t addr, int sz, int mask, in
     rom->rom = malloc(sz);
     memset(rom->rom, 0xff, sz);
 
+    rom->mapped = 0;
+
     /* Load the image file into the buffer. */
     if (!rom_load_linear_oddeven(fn, addr, sz, off, rom->rom)) {
         /* Nope.. clean up. */
@@ -727,6 +777,8 @@ rom_init_interleaved(rom_t *rom, const char *fnl, const char *fnh, uint32_t addr
     rom->rom = malloc(sz);
     memset(rom->rom, 0xff, sz);
 
+    rom->mapped = 0;
+
     /* Load the image file into the buffer. */
     if (!rom_load_interleaved(fnl, fnh, addr, sz, off, rom->rom)) {
         /* Nope.. clean up. */
@@ -746,3 +798,18 @@ rom_init_interleaved(rom_t *rom, const char *fnl, const char *fnh, uint32_t addr
 
     return 0;
 }
+
+/* Release the image of a ROM set up by one of the rom_init functions. */
+void
+rom_close(rom_t *rom)
+{
+    if (rom->rom == NULL)
+        return;
+
+    if (rom->mapped)
+        plat_munmap_file(rom->rom, rom->sz);
+    else
+        free(rom->rom);
+    rom->rom    = NULL;
+    rom->mapped = 0;
+}
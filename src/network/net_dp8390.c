@@ -15,6 +15,7 @@
  *          Copyright 2016-2018 Miran Grca.
  *          Copyright 2008-2018 Bochs project.
  */
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
@@ -25,6 +26,7 @@
 #define HAVE_STDARG_H
 #include <86box/86box.h>
 #include <86box/device.h>
+#include <86box/savestate.h>
 #include <86box/thread.h>
 #include <86box/timer.h>
 #include <86box/network.h>
@@ -1020,6 +1022,19 @@ dp8390_init(UNUSED(const device_t *info))
     return dp8390;
 }
 
+/* The registers and the packet memory; frames still queued on the host side
+   of the card are not part of this. */
+static void
+dp8390_state(void *priv, savestate_t *state)
+{
+    dp8390_t *dev = (dp8390_t *) priv;
+
+    savestate_var(state, dev, offsetof(dp8390_t, mem));
+    if (dev->mem != NULL)
+        savestate_block(state, dev->mem, dev->mem_size);
+    savestate_var(state, dev->macaddr, offsetof(dp8390_t, priv) - offsetof(dp8390_t, macaddr));
+}
+
 static void
 dp8390_close(void *priv)
 {
@@ -1048,5 +1063,7 @@ const device_t dp8390_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = dp8390_state,
+    .load          = dp8390_state
 };
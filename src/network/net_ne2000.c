@@ -44,6 +44,7 @@
  *   Boston, MA 02111-1307
  *   USA.
  */
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
@@ -61,6 +62,7 @@
 #include <86box/pic.h>
 #include <86box/random.h>
 #include <86box/device.h>
+#include <86box/savestate.h>
 #include <86box/thread.h>
 #include <86box/timer.h>
 #include <86box/network.h>
@@ -1209,6 +1211,29 @@ nic_init(const device_t *info)
     return dev;
 }
 
+/* The ASIC and bus registers; the DP8390 on the card is a device of its own.
+   PCI and Plug and Play may have moved the I/O window and the BIOS since the
+   machine was started, so both follow the restored values. */
+static void
+nic_state(void *priv, savestate_t *state)
+{
+    nic_t   *dev  = (nic_t *) priv;
+    uint32_t base = dev->base_address;
+
+    savestate_var(state, &dev->pnp_csnsav, offsetof(nic_t, pci_bar) - offsetof(nic_t, pnp_csnsav));
+    SAVESTATE_VAR(state, dev->pci_bar);
+
+    if (savestate_is_loading(state)) {
+        if (dev->base_address != base) {
+            if (base)
+                nic_ioremove(dev, base);
+            if (dev->base_address)
+                nic_ioset(dev, dev->base_address);
+        }
+        nic_update_bios(dev);
+    }
+}
+
 static void
 nic_close(void *priv)
 {
@@ -1694,7 +1719,9 @@ const device_t ne1000_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = ne1000_config
+    .config        = ne1000_config,
+    .save          = nic_state,
+    .load          = nic_state
 };
 
 const device_t ne1000_compat_device = {
@@ -1708,7 +1735,9 @@ const device_t ne1000_compat_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = ne1000_compat_config
+    .config        = ne1000_compat_config,
+    .save          = nic_state,
+    .load          = nic_state
 };
 
 const device_t ne2000_device = {
@@ -1722,7 +1751,9 @@ const device_t ne2000_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = ne2000_config
+    .config        = ne2000_config,
+    .save          = nic_state,
+    .load          = nic_state
 };
 
 const device_t ne2000_compat_device = {
@@ -1736,7 +1767,9 @@ const device_t ne2000_compat_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = ne2000_compat_config
+    .config        = ne2000_compat_config,
+    .save          = nic_state,
+    .load          = nic_state
 };
 
 const device_t ne2000_compat_8bit_device = {
@@ -1750,7 +1783,9 @@ const device_t ne2000_compat_8bit_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = ne2000_compat_8bit_config
+    .config        = ne2000_compat_8bit_config,
+    .save          = nic_state,
+    .load          = nic_state
 };
 
 const device_t ethernext_mc_device = {
@@ -1764,7 +1799,9 @@ const device_t ethernext_mc_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = mca_mac_config
+    .config        = mca_mac_config,
+    .save          = nic_state,
+    .load          = nic_state
 };
 
 const device_t rtl8019as_pnp_device = {
@@ -1778,7 +1815,9 @@ const device_t rtl8019as_pnp_device = {
     .available     = rtl8019as_available,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = rtl8019as_config
+    .config        = rtl8019as_config,
+    .save          = nic_state,
+    .load          = nic_state
 };
 
 const device_t de220p_device = {
@@ -1792,7 +1831,9 @@ const device_t de220p_device = {
     .available     = de220p_available,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = rtl8019as_config
+    .config        = rtl8019as_config,
+    .save          = nic_state,
+    .load          = nic_state
 };
 
 const device_t rtl8029as_device = {
@@ -1806,5 +1847,7 @@ const device_t rtl8029as_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = rtl8029as_config
+    .config        = rtl8029as_config,
+    .save          = nic_state,
+    .load          = nic_state
 };
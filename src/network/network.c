@@ -70,6 +70,7 @@
 #include <86box/net_ne2000.h>
 #include <86box/net_pcnet.h>
 #include <86box/net_wd8003.h>
+#include <86box/replay.h>
 
 #ifdef _WIN32
 #    define WIN32_LEAN_AND_MEAN
@@ -396,6 +397,8 @@ network_rx_queue(void *priv)
             thread_wait_mutex(card->rx_mutex);
             int res = network_queue_get_swap(&card->queues[NET_QUEUE_RX], &card->queued_pkt);
             thread_release_mutex(card->rx_mutex);
+            if (replay_mode)
+                res = replay_net_rx(card->card_num, &card->queued_pkt, res);
             if (!res)
                 break;
         }
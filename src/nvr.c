@@ -59,6 +59,8 @@
 #include <86box/path.h>
 #include <86box/plat.h>
 #include <86box/nvr.h>
+#include <86box/replay.h>
+#include <86box/savestate.h>
 
 int nvr_dosave; /* NVR is dirty, needs saved */
 
@@ -188,6 +190,16 @@ nvr_init(nvr_t *nvr)
     (void) nvr_load();
 }
 
+/* The registers and the internal clock, for the RTC devices built on this. */
+void
+nvr_state(nvr_t *nvr, savestate_t *state)
+{
+    SAVESTATE_VAR(state, nvr->regs);
+    SAVESTATE_VAR(state, nvr->onesec_cnt);
+    savestate_timer(state, &nvr->onesec_time);
+    SAVESTATE_VAR(state, intclk);
+}
+
 /* Get path to the NVR folder. */
 char *
 nvr_path(char *str)
@@ -277,8 +289,9 @@ nvr_save(void)
     const char *path;
     FILE       *fp;
 
-    /* Make sure we have been initialized. */
-    if (saved_nvr == NULL)
+    /* Make sure we have been initialized. A replay has to start from the same
+       NVR contents as its recording, so they are left alone from then on. */
+    if ((saved_nvr == NULL) || replay_started)
         return 0;
 
     if (saved_nvr->size != 0) {
@@ -315,6 +328,8 @@ nvr_time_sync(void)
 
     /* Get the current time of day, and convert to local time. */
     (void) time(&now);
+    if (replay_mode)
+        now = (time_t) replay_host_time((int64_t) now);
     if (time_sync & TIME_SYNC_UTC)
         tm = gmtime(&now);
     else
@@ -237,6 +237,7 @@
 #include <86box/device.h>
 #include <86box/nvr.h>
 #include <86box/fdd.h>
+#include <86box/savestate.h>
 
 /* RTC registers and bit definitions. */
 #define RTC_SECONDS        0
@@ -1237,6 +1238,33 @@ nvr_at_init(const device_t *info)
     return nvr;
 }
 
+static void
+nvr_at_state(void *priv, savestate_t *state)
+{
+    nvr_t   *nvr   = (nvr_t *) priv;
+    local_t *local = (local_t *) nvr->data;
+
+    nvr_state(nvr, state);
+
+    SAVESTATE_VAR(state, local->stat);
+    SAVESTATE_VAR(state, local->read_addr);
+    SAVESTATE_VAR(state, local->wp_0d);
+    SAVESTATE_VAR(state, local->wp_32);
+    SAVESTATE_VAR(state, local->irq_state);
+    SAVESTATE_VAR(state, local->smi_status);
+    SAVESTATE_VAR(state, local->wp);
+    SAVESTATE_VAR(state, local->bank);
+    savestate_var(state, local->lock, nvr->size);
+    SAVESTATE_VAR(state, local->count);
+    SAVESTATE_VAR(state, local->state);
+    SAVESTATE_VAR(state, local->addr);
+    SAVESTATE_VAR(state, local->smi_enable);
+    SAVESTATE_VAR(state, local->ecount);
+    SAVESTATE_VAR(state, local->rtc_time);
+    savestate_timer(state, &local->update_timer);
+    savestate_timer(state, &local->rtc_timer);
+}
+
 static void
 nvr_at_close(void *priv)
 {
@@ -1274,7 +1302,9 @@ const device_t at_nvr_old_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t at_nvr_device = {
@@ -1288,7 +1318,9 @@ const device_t at_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t at_mb_nvr_device = {
@@ -1302,7 +1334,9 @@ const device_t at_mb_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t ps_nvr_device = {
@@ -1316,7 +1350,9 @@ const device_t ps_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t amstrad_nvr_device = {
@@ -1330,7 +1366,9 @@ const device_t amstrad_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t ibmat_nvr_device = {
@@ -1344,7 +1382,9 @@ const device_t ibmat_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t piix4_nvr_device = {
@@ -1358,7 +1398,9 @@ const device_t piix4_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t ps_no_nmi_nvr_device = {
@@ -1372,7 +1414,9 @@ const device_t ps_no_nmi_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t amstrad_no_nmi_nvr_device = {
@@ -1386,7 +1430,9 @@ const device_t amstrad_no_nmi_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t ami_1992_nvr_device = {
@@ -1400,7 +1446,9 @@ const device_t ami_1992_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t ami_1994_nvr_device = {
@@ -1414,7 +1462,9 @@ const device_t ami_1994_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t ami_1995_nvr_device = {
@@ -1428,7 +1478,9 @@ const device_t ami_1995_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t via_nvr_device = {
@@ -1442,7 +1494,9 @@ const device_t via_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t p6rp4_nvr_device = {
@@ -1456,7 +1510,9 @@ const device_t p6rp4_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t amstrad_megapc_nvr_device = {
@@ -1470,7 +1526,9 @@ const device_t amstrad_megapc_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
 
 const device_t elt_nvr_device = {
@@ -1484,5 +1542,7 @@ const device_t elt_nvr_device = {
     .available     = NULL,
     .speed_changed = nvr_at_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nvr_at_state,
+    .load          = nvr_at_state
 };
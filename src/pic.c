@@ -19,6 +19,7 @@
  */
 #include <inttypes.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -38,6 +39,7 @@
 #include <86box/apm.h>
 #include <86box/nvr.h>
 #include <86box/acpi.h>
+#include <86box/savestate.h>
 #include <86box/plat_unused.h>
 
 enum {
@@ -280,6 +282,33 @@ pic_reset(void)
     pic_pci = 0;
 }
 
+/* Everything in pic_t up to the slave pointers is plain state. */
+void
+pic_save_state(savestate_t *state)
+{
+    savestate_write(state, &pic, offsetof(pic_t, slaves));
+    savestate_write(state, &pic2, offsetof(pic_t, slaves));
+    savestate_write_var(state, shadow);
+    savestate_write_var(state, pic_pci);
+    savestate_write_var(state, smi_irq_mask);
+    savestate_write_var(state, smi_irq_status);
+    savestate_write_var(state, latched_irqs);
+    savestate_write_timer(state, &pic_timer);
+}
+
+void
+pic_load_state(savestate_t *state)
+{
+    savestate_read(state, &pic, offsetof(pic_t, slaves));
+    savestate_read(state, &pic2, offsetof(pic_t, slaves));
+    savestate_read_var(state, shadow);
+    savestate_read_var(state, pic_pci);
+    savestate_read_var(state, smi_irq_mask);
+    savestate_read_var(state, smi_irq_status);
+    savestate_read_var(state, latched_irqs);
+    savestate_read_timer(state, &pic_timer);
+}
+
 void
 pic_set_shadow(int sh)
 {
@@ -18,6 +18,7 @@
 #include <inttypes.h>
 #include <math.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -37,6 +38,7 @@
 #include <86box/pit.h>
 #include <86box/pit_fast.h>
 #include <86box/ppi.h>
+#include <86box/savestate.h>
 #include <86box/machine.h>
 #include <86box/sound.h>
 #include <86box/snd_speaker.h>
@@ -927,6 +929,30 @@ pit_close(void *priv)
         free(dev);
 }
 
+/* Everything in ctr_t up to the callbacks is plain state; the PIT constant
+   follows the current CPU speed and is not restored. */
+static void
+pit_save(void *priv, savestate_t *state)
+{
+    pit_t *dev = (pit_t *) priv;
+
+    for (int i = 0; i < NUM_COUNTERS; i++)
+        savestate_write(state, &dev->counters[i], offsetof(ctr_t, load_func));
+    savestate_write_var(state, dev->ctrl);
+    savestate_write_timer(state, &dev->callback_timer);
+}
+
+static void
+pit_load(void *priv, savestate_t *state)
+{
+    pit_t *dev = (pit_t *) priv;
+
+    for (int i = 0; i < NUM_COUNTERS; i++)
+        savestate_read(state, &dev->counters[i], offsetof(ctr_t, load_func));
+    savestate_read_var(state, dev->ctrl);
+    savestate_read_timer(state, &dev->callback_timer);
+}
+
 static void *
 pit_init(const device_t *info)
 {
@@ -963,7 +989,9 @@ const device_t i8253_device = {
     .available     = NULL,
     .speed_changed = pit_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 const device_t i8253_ext_io_device = {
@@ -977,7 +1005,9 @@ const device_t i8253_ext_io_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 const device_t i8254_device = {
@@ -991,7 +1021,9 @@ const device_t i8254_device = {
     .available     = NULL,
     .speed_changed = pit_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 const device_t i8254_sec_device = {
@@ -1005,7 +1037,9 @@ const device_t i8254_sec_device = {
     .available     = NULL,
     .speed_changed = pit_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 const device_t i8254_ext_io_device = {
@@ -1019,7 +1053,9 @@ const device_t i8254_ext_io_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 const device_t i8254_ps2_device = {
@@ -1033,7 +1069,9 @@ const device_t i8254_ps2_device = {
     .available     = NULL,
     .speed_changed = pit_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pit_save,
+    .load          = pit_load
 };
 
 pit_t *
@@ -18,6 +18,7 @@
 #include <inttypes.h>
 #include <math.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -37,6 +38,7 @@
 #include <86box/pit.h>
 #include <86box/pit_fast.h>
 #include <86box/ppi.h>
+#include <86box/savestate.h>
 #include <86box/machine.h>
 #include <86box/sound.h>
 #include <86box/snd_speaker.h>
@@ -716,6 +718,30 @@ pitf_handler(int set, uint16_t base, int size, void *priv)
     io_handler(set, base, size, pitf_read, NULL, NULL, pitf_write, NULL, NULL, priv);
 }
 
+static void
+pitf_save(void *priv, savestate_t *state)
+{
+    pitf_t *dev = (pitf_t *) priv;
+
+    for (int i = 0; i < NUM_COUNTERS; i++) {
+        savestate_write(state, &dev->counters[i], offsetof(ctrf_t, pit_const));
+        savestate_write_timer(state, &dev->counters[i].timer);
+    }
+    savestate_write_var(state, dev->ctrl);
+}
+
+static void
+pitf_load(void *priv, savestate_t *state)
+{
+    pitf_t *dev = (pitf_t *) priv;
+
+    for (int i = 0; i < NUM_COUNTERS; i++) {
+        savestate_read(state, &dev->counters[i], offsetof(ctrf_t, pit_const));
+        savestate_read_timer(state, &dev->counters[i].timer);
+    }
+    savestate_read_var(state, dev->ctrl);
+}
+
 static void *
 pitf_init(const device_t *info)
 {
@@ -754,7 +780,9 @@ const device_t i8253_fast_device = {
     .available     = NULL,
     .speed_changed = pitf_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const device_t i8254_fast_device = {
@@ -768,7 +796,9 @@ const device_t i8254_fast_device = {
     .available     = NULL,
     .speed_changed = pitf_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const device_t i8254_sec_fast_device = {
@@ -782,7 +812,9 @@ const device_t i8254_sec_fast_device = {
     .available     = NULL,
     .speed_changed = pitf_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const device_t i8254_ext_io_fast_device = {
@@ -796,7 +828,9 @@ const device_t i8254_ext_io_fast_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const device_t i8254_ps2_fast_device = {
@@ -810,7 +844,9 @@ const device_t i8254_ps2_fast_device = {
     .available     = NULL,
     .speed_changed = pitf_speed_changed,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = pitf_save,
+    .load          = pitf_load
 };
 
 const pit_intf_t pit_fast_intf = {
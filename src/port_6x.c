@@ -38,6 +38,7 @@
 #include <86box/port_6x.h>
 #include <86box/plat_unused.h>
 #include <86box/random.h>
+#include <86box/savestate.h>
 
 #define PS2_REFRESH_TIME (16 * TIMER_USEC)
 
@@ -163,6 +164,19 @@ port_6x_refresh(void *priv)
     timer_advance_u64(&dev->refresh_timer, PS2_REFRESH_TIME);
 }
 
+/* Port 61h also holds the PPI port B latch and the speaker gates. */
+static void
+port_6x_state(void *priv, savestate_t *state)
+{
+    port_6x_t *dev = (port_6x_t *) priv;
+
+    SAVESTATE_VAR(state, ppi);
+    SAVESTATE_VAR(state, ppispeakon);
+    speaker_state(state);
+    SAVESTATE_VAR(state, dev->refresh);
+    savestate_timer(state, &dev->refresh_timer);
+}
+
 static void
 port_6x_close(void *priv)
 {
@@ -215,7 +229,9 @@ const device_t port_6x_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = port_6x_state,
+    .load          = port_6x_state
 };
 
 const device_t port_6x_xi8088_device = {
@@ -229,7 +245,9 @@ const device_t port_6x_xi8088_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = port_6x_state,
+    .load          = port_6x_state
 };
 
 const device_t port_6x_ps2_device = {
@@ -243,7 +261,9 @@ const device_t port_6x_ps2_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = port_6x_state,
+    .load          = port_6x_state
 };
 
 const device_t port_6x_olivetti_device = {
@@ -257,5 +277,7 @@ const device_t port_6x_olivetti_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = port_6x_state,
+    .load          = port_6x_state
 };
@@ -0,0 +1,256 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Host time profiler.
+ *
+ *
+ *
+ * Authors: The 86Box development team
+ *
+ *          Copyright 2026 The 86Box development team
+ */
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <86box/86box.h>
+#include <86box/timer.h>
+#include <86box/device.h>
+#include <86box/plat.h>
+#include <86box/prof.h>
+#ifdef MTR_ENABLED
+#    include <minitrace/minitrace.h>
+#endif
+
+#define PROF_STACK_MAX 32
+
+int prof_active = 0;
+
+/* Time in a frame outside of any other section. */
+static prof_section_t prof_other  = { .name = "Other" };
+static prof_section_t prof_timers = { .name = "Timers (no device)", .next = &prof_other };
+
+prof_section_t prof_disk    = { .name = "Disk I/O", .next = &prof_timers };
+prof_section_t prof_sound   = { .name = "Sound mixing", .next = &prof_disk };
+prof_section_t prof_video   = { .name = "Video render", .next = &prof_sound };
+prof_section_t prof_compile = { .name = "Dynarec compile", .next = &prof_video };
+prof_section_t prof_cpu     = { .name = "CPU", .next = &prof_compile };
+
+/* Device sections are only ever added at the head, after being filled in, so
+   the list can be walked from other threads without locking. */
+static prof_section_t *volatile prof_sections = &prof_cpu;
+
+static prof_section_t *prof_stack[PROF_STACK_MAX];
+static int             prof_depth;
+static uint64_t        prof_last;
+static uint64_t        prof_frame_start;
+static uint64_t        prof_total;
+static uint64_t        prof_frames;
+static volatile int    prof_request;
+static volatile int    prof_reset_pending;
+
+/* Charge the time since the last event to the innermost section. */
+static __inline void
+prof_charge(uint64_t now)
+{
+    prof_section_t *section = &prof_other;
+
+    if (prof_depth > 0)
+        section = prof_stack[MIN(prof_depth, PROF_STACK_MAX) - 1];
+
+    section->frame_ticks += now - prof_last;
+    prof_last = now;
+}
+
+void
+prof_enter(prof_section_t *section)
+{
+    prof_charge(plat_timer_read());
+
+    if (prof_depth < PROF_STACK_MAX) {
+        prof_stack[prof_depth] = section;
+        section->calls++;
+    }
+    prof_depth++;
+}
+
+void
+prof_leave(void)
+{
+    prof_charge(plat_timer_read());
+
+    if (prof_depth > 0)
+        prof_depth--;
+}
+
+prof_section_t *
+prof_device_section(const device_t *dev)
+{
+    prof_section_t *section;
+
+    if ((dev == NULL) || (dev->name == NULL))
+        return NULL;
+
+    for (section = prof_sections; section != &prof_cpu; section = section->next) {
+        if (!strcmp(section->name, dev->name))
+            return section;
+    }
+
+    section = (prof_section_t *) calloc(1, sizeof(prof_section_t));
+    if (section == NULL)
+        return NULL;
+    section->name = dev->name;
+    section->next = prof_sections;
+    prof_sections = section;
+
+    return section;
+}
+
+/* Timers added while a device is being initialized are attributed to that
+   device by timer_add(). The others are looked up by their private data once,
+   the first time they fire. */
+prof_section_t *
+prof_timer_section(pc_timer_t *timer)
+{
+    if (timer->prof == NULL) {
+        timer->prof = prof_device_section(device_get_by_priv(timer->priv));
+        if (timer->prof == NULL)
+            timer->prof = &prof_timers;
+    }
+
+    return timer->prof;
+}
+
+void
+prof_frame_begin(void)
+{
+    if (prof_reset_pending) {
+        for (prof_section_t *section = prof_sections; section != NULL; section = section->next) {
+            section->ticks = 0;
+            section->calls = 0;
+        }
+        prof_total         = 0;
+        prof_frames        = 0;
+        prof_reset_pending = 0;
+    }
+
+    prof_active = prof_request;
+    if (!prof_active)
+        return;
+
+    prof_depth       = 0;
+    prof_frame_start = prof_last = plat_timer_read();
+#ifdef MTR_ENABLED
+    MTR_BEGIN("prof", "frame");
+#endif
+}
+
+void
+prof_frame_end(void)
+{
+    uint64_t now;
+
+    if (!prof_active)
+        return;
+
+    now = plat_timer_read();
+    prof_charge(now);
+    prof_total += now - prof_frame_start;
+    prof_frames++;
+
+    for (prof_section_t *section = prof_sections; section != NULL; section = section->next) {
+        section->ticks += section->frame_ticks;
+#ifdef MTR_ENABLED
+        /* Microseconds, for the sections seen since the last reset. */
+        if (section->ticks)
+            MTR_COUNTER("prof", section->name, (int) ((section->frame_ticks * 1000000ULL) / timer_freq));
+#endif
+        section->frame_ticks = 0;
+    }
+#ifdef MTR_ENABLED
+    MTR_END("prof", "frame");
+#endif
+}
+
+void
+prof_start(void)
+{
+    prof_request = 1;
+}
+
+void
+prof_stop(void)
+{
+    prof_request = 0;
+}
+
+void
+prof_reset(void)
+{
+    prof_reset_pending = 1;
+}
+
+int
+prof_running(void)
+{
+    return prof_request;
+}
+
+static int
+prof_compare(const void *a, const void *b)
+{
+    const prof_section_t *sa = *(const prof_section_t *const *) a;
+    const prof_section_t *sb = *(const prof_section_t *const *) b;
+
+    if (sa->ticks != sb->ticks)
+        return (sa->ticks < sb->ticks) ? 1 : -1;
+    return strcmp(sa->name, sb->name);
+}
+
+void
+prof_summary(FILE *fp)
+{
+    prof_section_t **list;
+    prof_section_t  *head   = prof_sections;
+    prof_section_t  *section;
+    int              num    = 0;
+    int              i;
+    double           freq   = (double) timer_freq;
+    uint64_t         total  = prof_total;
+    uint64_t         frames = prof_frames;
+
+    for (section = head; section != NULL; section = section->next)
+        num++;
+
+    list = (prof_section_t **) malloc(num * sizeof(prof_section_t *));
+    if (list == NULL)
+        return;
+    num = 0;
+    for (section = head; section != NULL; section = section->next) {
+        if (section->ticks)
+            list[num++] = section;
+    }
+    qsort(list, num, sizeof(prof_section_t *), prof_compare);
+
+    fprintf(fp, "Host time over %" PRIu64 " frames: %.1f ms, %.3f ms per frame%s\n",
+            frames, (total * 1000.0) / freq, frames ? ((total * 1000.0) / freq) / frames : 0.0,
+            prof_request ? "" : " (stopped)");
+    fprintf(fp, "%-40s %12s %10s %7s %12s\n", "Section", "ms", "ms/frame", "%", "calls");
+    for (i = 0; i < num; i++) {
+        section = list[i];
+        fprintf(fp, "%-40s %12.1f %10.3f %6.1f%% %12" PRIu64 "\n", section->name,
+                (section->ticks * 1000.0) / freq,
+                frames ? ((section->ticks * 1000.0) / freq) / frames : 0.0,
+                total ? (section->ticks * 100.0) / total : 0.0,
+                section->calls);
+    }
+
+    free(list);
+}
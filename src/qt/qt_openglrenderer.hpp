@@ -77,7 +77,7 @@ signals:
     void errorInitializing();
 
 public slots:
-    void onBlit(int buf_idx, int x, int y, int w, int h);
+    void onBlit(int buf_idx, int x, int y, int w, int h, QRect dirty);
 
 protected:
     void exposeEvent(QExposeEvent *event) override;
@@ -94,6 +94,7 @@ private:
 
     bool isInitialized = false;
     bool isFinalized   = false;
+    bool uploadAll     = true; /* A blit was missed, upload everything. */
 
     int max_texture_size = 65536;
     int frameCounter     = 0;
@@ -61,6 +61,10 @@
 #ifdef Q_OS_UNIX
 #    include <pthread.h>
 #    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+#ifdef Q_OS_LINUX
+#    include <sys/syscall.h>
 #endif
 
 #ifdef Q_OS_OPENBSD
@@ -109,6 +113,7 @@ extern "C" {
 #        define NOMINMAX
 #    endif
 #    include <windows.h>
+#    include <io.h>
 #    include <86box/win.h>
 #else
 #    include <strings.h>
@@ -395,6 +400,205 @@ plat_munmap(void *ptr, size_t size)
 #endif
 }
 
+/* Map part of an open file, either read-only and shared with every other
+   process mapping it, or copy-on-write, which still shares the pages until
+   they are written to. The file can be closed afterwards. */
+void *
+plat_mmap_file(FILE *fp, uint64_t offset, size_t size, int copy)
+{
+    if (size == 0)
+        return nullptr;
+#if defined Q_OS_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    if (offset % info.dwAllocationGranularity)
+        return nullptr;
+
+    HANDLE file = (HANDLE) _get_osfhandle(_fileno(fp));
+    HANDLE map  = CreateFileMappingW(file, NULL, copy ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    if (map == NULL)
+        return nullptr;
+    void *ret = MapViewOfFile(map, copy ? FILE_MAP_COPY : FILE_MAP_READ,
+                              (DWORD) (offset >> 32), (DWORD) offset, size);
+    /* The view keeps the mapping alive. */
+    CloseHandle(map);
+    return ret;
+#elif defined Q_OS_UNIX
+    if (offset % sysconf(_SC_PAGESIZE))
+        return nullptr;
+
+    void *ret = mmap(0, size, copy ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                     copy ? MAP_PRIVATE : MAP_SHARED, fileno(fp), (off_t) offset);
+    return (ret == MAP_FAILED) ? nullptr : ret;
+#else
+    return nullptr;
+#endif
+}
+
+void
+plat_munmap_file(void *ptr, size_t size)
+{
+#if defined Q_OS_WINDOWS
+    UnmapViewOfFile(ptr);
+#else
+    munmap(ptr, size);
+#endif
+}
+
+/* Let the host merge identical pages of the block with those of other
+   processes. */
+void
+plat_mem_mergeable(void *ptr, size_t size)
+{
+#if defined Q_OS_UNIX && defined MADV_MERGEABLE
+    madvise(ptr, size, MADV_MERGEABLE);
+#endif
+}
+
+/* Size of the huge pages explicitly requested mappings get. */
+static size_t
+plat_huge_page_size()
+{
+    static size_t size = 0;
+
+    if (size != 0)
+        return size;
+
+    size = 2 << 20;
+#if defined Q_OS_WINDOWS
+    if (GetLargePageMinimum() != 0)
+        size = GetLargePageMinimum();
+#elif defined Q_OS_LINUX
+    if (FILE *fp = fopen("/proc/meminfo", "r")) {
+        char          line[128];
+        unsigned long kb;
+
+        while (fgets(line, sizeof(line), fp) != nullptr) {
+            if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) {
+                size = (size_t) kb << 10;
+                break;
+            }
+        }
+        fclose(fp);
+    }
+#endif
+
+    return size;
+}
+
+/* Allocate a block for the emulated RAM. With huge set, the block is backed
+   by transparent huge pages, or, at 2, by explicit ones if the host has any
+   reserved, and its size is rounded up to a whole number of huge pages, which
+   plat_munmap_ram() has to be given the same huge value to match. */
+void *
+plat_mmap_ram(size_t size, int huge)
+{
+    if (!huge)
+        return plat_mmap(size, 0);
+
+    size_t align = plat_huge_page_size();
+    size         = (size + align - 1) & ~(align - 1);
+
+#if defined Q_OS_WINDOWS
+    /* Large pages need the "Lock pages in memory" privilege. */
+    void *ret = nullptr;
+    if (huge >= 2)
+        ret = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    if (ret == nullptr)
+        ret = VirtualAlloc(NULL, size, MEM_COMMIT, PAGE_READWRITE);
+    return ret;
+#elif defined Q_OS_UNIX
+    void *ret = MAP_FAILED;
+#    ifdef MAP_HUGETLB
+    if (huge >= 2)
+        ret = mmap(0, size, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+#    endif
+    if (ret != MAP_FAILED)
+        return ret;
+
+    /* Transparent huge pages are only used for aligned ranges, so over-allocate
+       and trim the block to an aligned one. */
+    ret = mmap(0, size + align, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
+    if (ret == MAP_FAILED)
+        return nullptr;
+    auto   *ptr  = (uint8_t *) ret;
+    size_t  head = (align - ((uintptr_t) ptr & (align - 1))) & (align - 1);
+    if (head)
+        munmap(ptr, head);
+    munmap(ptr + head + size, align - head);
+    ptr += head;
+
+#    ifdef MADV_HUGEPAGE
+    madvise(ptr, size, MADV_HUGEPAGE);
+#    endif
+
+    return ptr;
+#endif
+}
+
+void
+plat_munmap_ram(void *ptr, size_t size, int huge)
+{
+#if defined Q_OS_WINDOWS
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    size_t align = plat_huge_page_size();
+
+    if (huge)
+        size = (size + align - 1) & ~(align - 1);
+
+    munmap(ptr, size);
+#endif
+}
+
+/* Place a block on the NUMA node of the CPU the calling thread runs on,
+   moving the pages already in place. Return the node, or -1 if the block
+   could not be placed. */
+int
+plat_mem_bind_node(void *ptr, size_t size)
+{
+#if defined Q_OS_LINUX && defined SYS_getcpu && defined SYS_mbind
+    unsigned int  cpu;
+    unsigned int  node;
+    unsigned long mask;
+
+    if ((syscall(SYS_getcpu, &cpu, &node, NULL) != 0) || (node >= (sizeof(mask) * 8)))
+        return -1;
+
+    /* MPOL_PREFERRED and MPOL_MF_MOVE, as they are not in libc headers. */
+    mask = 1UL << node;
+    if (syscall(SYS_mbind, ptr, size, 1, &mask, sizeof(mask) * 8 + 1, 1 << 1) != 0)
+        return -1;
+
+    return (int) node;
+#else
+    return -1;
+#endif
+}
+
+int
+plat_mem_usage(uint64_t *resident, uint64_t *shared)
+{
+#if defined Q_OS_LINUX
+    FILE              *fp = fopen("/proc/self/statm", "r");
+    unsigned long long pages[3];
+
+    if (fp == NULL)
+        return -1;
+    int ret = fscanf(fp, "%llu %llu %llu", &pages[0], &pages[1], &pages[2]);
+    fclose(fp);
+    if (ret != 3)
+        return -1;
+
+    *resident = pages[1] * sysconf(_SC_PAGESIZE);
+    *shared   = pages[2] * sysconf(_SC_PAGESIZE);
+
+    return 0;
+#else
+    return -1;
+#endif
+}
+
 extern bool cpu_thread_running;
 void
 plat_pause(int p)
@@ -759,6 +963,12 @@ plat_get_cpu_string(char *outbuf, uint8_t len) {
 
 }
 
+int
+plat_cpu_count(void)
+{
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
 void
 plat_set_thread_name(void *thread, const char *name)
 {
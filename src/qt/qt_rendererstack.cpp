@@ -297,6 +297,7 @@ RendererStack::switchRenderer(Renderer renderer)
 {
     //startblit();
     switchInProgress = true;
+    damageReset      = true;
     if (current) {
         rendererWindow->finalize();
         removeWidget(current.get());
@@ -432,8 +433,38 @@ RendererStack::blit(int x, int y, int w, int h)
 {
     if ((x < 0) || (y < 0) || (w <= 0) || (h <= 0) ||
         (w > 2048) || (h > 2048) || (switchInProgress) ||
-        (monitors[m_monitor_index].target_buffer == NULL) || imagebufs.empty() ||
-        std::get<std::atomic_flag *>(imagebufs[currentBuf])->test_and_set()) {
+        (monitors[m_monitor_index].target_buffer == NULL) || imagebufs.empty()) {
+        damageReset = true;
+        video_blit_complete_monitor(m_monitor_index);
+        return;
+    }
+
+    /* Every buffer is missing what changed, until it is next filled. */
+    const QRect area(x, y, w, h);
+    if (damageReset.exchange(false) || (bufDamage.size() != imagebufs.size()) || (area != blitArea)) {
+        blitArea = area;
+        bufDamage.assign(imagebufs.size(), QRegion(area));
+        pendingDamage = area;
+    } else {
+        video_rect_t rects[VIDEO_DAMAGE_MAX];
+        const int    num = video_blit_damage_monitor(rects, VIDEO_DAMAGE_MAX, m_monitor_index);
+
+        for (int i = 0; i < num; i++) {
+            const QRect rect(rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+
+            for (auto &damage : bufDamage)
+                damage += rect;
+            pendingDamage += rect;
+        }
+    }
+
+    /* Nothing changed since the last frame the renderer got. */
+    if (pendingDamage.isEmpty() && !monitors[m_monitor_index].mon_screenshots) {
+        video_blit_complete_monitor(m_monitor_index);
+        return;
+    }
+
+    if (std::get<std::atomic_flag *>(imagebufs[currentBuf])->test_and_set()) {
         video_blit_complete_monitor(m_monitor_index);
         return;
     }
@@ -442,17 +473,21 @@ RendererStack::blit(int x, int y, int w, int h)
     sw = this->w = w;
     sh = this->h       = h;
     uint8_t *imagebits = std::get<uint8_t *>(imagebufs[currentBuf]);
-    for (int y1 = y; y1 < (y + h); y1++) {
-        auto scanline = imagebits + (y1 * rendererWindow->getBytesPerRow()) + (x * 4);
-        video_copy(scanline, &(monitors[m_monitor_index].target_buffer->line[y1][x]), w * 4);
+    for (const QRect &rect : bufDamage[currentBuf] & area) {
+        for (int y1 = rect.top(); y1 <= rect.bottom(); y1++) {
+            auto scanline = imagebits + (y1 * rendererWindow->getBytesPerRow()) + (rect.x() * 4);
+            video_copy(scanline, &(monitors[m_monitor_index].target_buffer->line[y1][rect.x()]), rect.width() * 4);
+        }
     }
+    bufDamage[currentBuf] = QRegion();
 
     if (monitors[m_monitor_index].mon_screenshots && !rendererTakesScreenshots) {
         video_screenshot_monitor((uint32_t *) imagebits, x, y, 2048, m_monitor_index);
     }
     video_blit_complete_monitor(m_monitor_index);
-    emit blitToRenderer(currentBuf, sx, sy, sw, sh);
-    currentBuf = (currentBuf + 1) % imagebufs.size();
+    emit blitToRenderer(currentBuf, sx, sy, sw, sh, pendingDamage.boundingRect());
+    pendingDamage = QRegion();
+    currentBuf    = (currentBuf + 1) % imagebufs.size();
 }
 
 void
@@ -7,6 +7,7 @@
 #include <QStackedWidget>
 #include <QWidget>
 #include <QCursor>
+#include <QRegion>
 #include <QScreen>
 
 #include <atomic>
@@ -106,7 +107,7 @@ public:
     void (*mouse_exit_func)()                   = nullptr;
 
 signals:
-    void blitToRenderer(int buf_idx, int x, int y, int w, int h);
+    void blitToRenderer(int buf_idx, int x, int y, int w, int h, QRect dirty);
     void rendererChanged();
 
 public slots:
@@ -132,6 +133,13 @@ private:
 
     std::vector<std::tuple<uint8_t *, std::atomic_flag *>> imagebufs;
 
+    /* Areas each buffer is missing, and the area changed since the last
+       frame handed to the renderer. */
+    std::vector<QRegion> bufDamage;
+    QRegion              pendingDamage;
+    QRect                blitArea;
+    std::atomic_bool     damageReset { true };
+
     RendererCommon          *rendererWindow { nullptr };
     std::unique_ptr<QWidget> current;
 
@@ -22,6 +22,8 @@
 #include <QApplication>
 #include <QPainter>
 
+#include <cmath>
+
 extern "C" {
 #include <86box/86box.h>
 #include <86box/video.h>
@@ -55,7 +57,7 @@ SoftwareRenderer::paintEvent(QPaintEvent *event)
 }
 
 void
-SoftwareRenderer::onBlit(int buf_idx, int x, int y, int w, int h)
+SoftwareRenderer::onBlit(int buf_idx, int x, int y, int w, int h, QRect dirty)
 {
     /* TODO: should look into deleteLater() */
     auto  tval    = this;
@@ -69,9 +71,20 @@ SoftwareRenderer::onBlit(int buf_idx, int x, int y, int w, int h)
 
     source.setRect(x, y, w, h);
 
-    if (source != origSource)
+    if (source != origSource) {
         onResize(this->width(), this->height());
-    update();
+        update();
+        return;
+    }
+
+    if (dirty.isEmpty())
+        return;
+
+    /* Only repaint the lines that changed, with a line of margin for the filtering. */
+    const double scale  = (double) destination.height() / (double) h;
+    const int    top    = destination.y() + (int) floor((dirty.top() - y - 1) * scale);
+    const int    bottom = destination.y() + (int) ceil((dirty.bottom() - y + 2) * scale);
+    update(QRect(destination.x(), top, destination.width(), bottom - top));
 }
 
 void
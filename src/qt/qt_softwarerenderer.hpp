@@ -24,7 +24,7 @@ public:
     std::vector<std::tuple<uint8_t *, std::atomic_flag *>> getBuffers() override;
 
 public slots:
-    void onBlit(int buf_idx, int x, int y, int w, int h);
+    void onBlit(int buf_idx, int x, int y, int w, int h, QRect dirty);
 
 protected:
     std::array<std::unique_ptr<QImage>, 2> images;
@@ -0,0 +1,421 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Deterministic record/replay of the inputs of the emulated
+ *          system.
+ *
+ *
+ *
+ * Authors: The 86Box development team
+ *
+ *          Copyright 2026 The 86Box development team
+ */
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#define HAVE_STDARG_H
+#include <86box/86box.h>
+#include "cpu.h"
+#include <86box/timer.h>
+#include <86box/device.h>
+#include <86box/keyboard.h>
+#include <86box/machine.h>
+#include <86box/thread.h>
+#include <86box/network.h>
+#include <86box/plat.h>
+#include <86box/replay.h>
+#include <86box/savestate.h>
+
+#define REPLAY_MAGIC   "86BOXRP"
+#define REPLAY_VERSION 1
+
+#define REPLAY_EV_RESET 0 /* hard reset, no payload */
+#define REPLAY_EV_KEY   1 /* replay_key_t */
+#define REPLAY_EV_MOUSE 2 /* replay_mouse_t */
+#define REPLAY_EV_NET   3 /* uint16_t card number, then the packet */
+#define REPLAY_EV_TIME  4 /* int64_t host time */
+#define REPLAY_EV_END   0xffff
+
+#define REPLAY_PAYLOAD_MAX 2048
+#define REPLAY_KEYS_MAX    256
+
+typedef struct replay_header_t {
+    char     magic[8];
+    uint32_t version;
+    uint32_t pad;
+    char     machine[64];
+    char     state[256]; /* save state the log starts from, empty for a hard reset */
+} replay_header_t;
+
+typedef struct replay_event_t {
+    uint64_t tsc;
+    uint16_t type;
+    uint16_t len;
+    uint32_t pad;
+} replay_event_t;
+
+typedef struct replay_key_t {
+    uint16_t scan;
+    uint8_t  down;
+    uint8_t  pad;
+} replay_key_t;
+
+int replay_mode    = REPLAY_NONE;
+int replay_started = 0;
+
+static FILE    *replay_fp;
+static uint64_t replay_events;
+static int      replay_wait_reset; /* the log starts at the next hard reset */
+
+/* Playback: the next event in the log. */
+static replay_event_t replay_next;
+static uint8_t        replay_next_data[REPLAY_PAYLOAD_MAX];
+
+/* Recording: keystrokes from the UI thread, waiting for the next frame. */
+static mutex_t     *replay_keys_mutex;
+static replay_key_t replay_keys[REPLAY_KEYS_MAX];
+static int          replay_keys_num;
+static int32_t      replay_last_buttons;
+
+#ifdef ENABLE_REPLAY_LOG
+int replay_do_log = ENABLE_REPLAY_LOG;
+
+static void
+replay_log(const char *fmt, ...)
+{
+    va_list ap;
+
+    if (replay_do_log) {
+        va_start(ap, fmt);
+        pclog_ex(fmt, ap);
+        va_end(ap);
+    }
+}
+#else
+#    define replay_log(fmt, ...)
+#endif
+
+void
+replay_stop(void)
+{
+    if (replay_mode == REPLAY_NONE)
+        return;
+
+    if (replay_fp) {
+        if (fclose(replay_fp))
+            pclog("replay: error writing the log\n");
+        replay_fp = NULL;
+    }
+
+    pclog("replay: %s stopped after %" PRIu64 " events\n", (replay_mode == REPLAY_RECORD) ? "recording" : "playback", replay_events);
+    replay_mode = REPLAY_NONE;
+}
+
+static void
+replay_write(uint16_t type, const void *data, uint16_t len)
+{
+    replay_event_t ev;
+
+    memset(&ev, 0x00, sizeof(replay_event_t));
+    ev.tsc  = tsc;
+    ev.type = type;
+    ev.len  = len;
+
+    if (replay_wait_reset) {
+        if (type != REPLAY_EV_RESET)
+            return;
+        replay_wait_reset = 0;
+    }
+
+    if ((fwrite(&ev, sizeof(replay_event_t), 1, replay_fp) != 1) || (len && (fwrite(data, 1, len, replay_fp) != len))) {
+        pclog("replay: error writing the log\n");
+        replay_stop();
+        return;
+    }
+
+    replay_events++;
+}
+
+/* Reaching the end of the log ends playback; the machine then carries on with
+   live input. */
+static void
+replay_read_next(void)
+{
+    if ((fread(&replay_next, sizeof(replay_event_t), 1, replay_fp) != 1) || (replay_next.len > REPLAY_PAYLOAD_MAX) ||
+        (replay_next.len && (fread(replay_next_data, 1, replay_next.len, replay_fp) != replay_next.len))) {
+        replay_next.type = REPLAY_EV_END;
+        pclog("replay: end of the log reached at TSC %" PRIu64 "\n", tsc);
+        replay_stop();
+    }
+}
+
+/* An event is consumed at the point its kind of input is taken, once the TSC
+   has reached the value it was recorded at. Still finding it pending past that
+   value means the emulation took a different path. */
+static int
+replay_due(uint16_t type)
+{
+    if ((replay_mode != REPLAY_PLAY) || replay_wait_reset)
+        return 0;
+
+    if ((replay_next.type == type) && (replay_next.tsc == tsc))
+        return 1;
+
+    if ((replay_next.type != REPLAY_EV_RESET) && (replay_next.tsc < tsc)) {
+        pclog("replay: the machine diverged from the log at TSC %" PRIu64 " (event type %i at TSC %" PRIu64 ")\n",
+              tsc, replay_next.type, replay_next.tsc);
+        replay_stop();
+    }
+
+    return 0;
+}
+
+static void
+replay_consume(void)
+{
+    replay_events++;
+    replay_read_next();
+}
+
+static void
+replay_header_init(replay_header_t *header)
+{
+    memset(header, 0x00, sizeof(replay_header_t));
+    memcpy(header->magic, REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    header->version = REPLAY_VERSION;
+    strncpy(header->machine, machine_get_internal_name(), sizeof(header->machine) - 1);
+}
+
+int
+replay_record(const char *fn, const char *state)
+{
+    replay_header_t header;
+
+    replay_stop();
+
+    replay_header_init(&header);
+    if (state) {
+        if (strlen(state) >= sizeof(header.state))
+            return -1;
+        strcpy(header.state, state);
+
+        if (savestate_save(state))
+            return -1;
+    }
+
+    replay_fp = plat_fopen64(fn, "wb");
+    if (replay_fp == NULL) {
+        pclog("replay: unable to create %s\n", fn);
+        return -1;
+    }
+    if (fwrite(&header, sizeof(replay_header_t), 1, replay_fp) != 1) {
+        pclog("replay: error writing %s\n", fn);
+        fclose(replay_fp);
+        replay_fp = NULL;
+        return -1;
+    }
+
+    if (replay_keys_mutex == NULL)
+        replay_keys_mutex = thread_create_mutex();
+    replay_keys_num     = 0;
+    replay_last_buttons = 0;
+    replay_events       = 0;
+    replay_wait_reset   = (state == NULL);
+    replay_mode         = REPLAY_RECORD;
+    replay_started      = 1;
+
+    pclog("replay: recording to %s\n", fn);
+    return 0;
+}
+
+int
+replay_play(const char *fn)
+{
+    replay_header_t header;
+    replay_header_t current;
+
+    replay_stop();
+
+    replay_fp = plat_fopen64(fn, "rb");
+    if (replay_fp == NULL) {
+        pclog("replay: unable to open %s\n", fn);
+        return -1;
+    }
+
+    replay_header_init(&current);
+    if (fread(&header, sizeof(replay_header_t), 1, replay_fp) != 1)
+        memset(&header, 0x00, sizeof(replay_header_t));
+    header.state[sizeof(header.state) - 1] = '\0';
+    memcpy(current.state, header.state, sizeof(current.state));
+    if (memcmp(&header, &current, sizeof(replay_header_t))) {
+        pclog("replay: %s was not recorded by this build from this machine\n", fn);
+        fclose(replay_fp);
+        replay_fp = NULL;
+        return -1;
+    }
+
+    if (header.state[0] && savestate_load(header.state)) {
+        fclose(replay_fp);
+        replay_fp = NULL;
+        return -1;
+    }
+
+    replay_events     = 0;
+    replay_wait_reset = !header.state[0];
+    replay_mode       = REPLAY_PLAY;
+    replay_started    = 1;
+
+    pclog("replay: playing back %s\n", fn);
+    replay_read_next();
+    return 0;
+}
+
+int
+replay_waiting_reset(void)
+{
+    return (replay_mode != REPLAY_NONE) && replay_wait_reset;
+}
+
+void
+replay_reset(void)
+{
+    if (replay_mode == REPLAY_RECORD)
+        replay_write(REPLAY_EV_RESET, NULL, 0);
+    else if (replay_mode == REPLAY_PLAY) {
+        replay_wait_reset = 0;
+        if (replay_next.type == REPLAY_EV_RESET)
+            replay_consume();
+        else {
+            pclog("replay: unexpected hard reset at TSC %" PRIu64 "\n", tsc);
+            replay_stop();
+        }
+    }
+}
+
+/* Called between CPU slices; delivers the keystrokes of this frame. */
+void
+replay_frame(void)
+{
+    replay_key_t keys[REPLAY_KEYS_MAX];
+    int          keys_num;
+
+    if (replay_mode == REPLAY_RECORD) {
+        thread_wait_mutex(replay_keys_mutex);
+        keys_num = replay_keys_num;
+        memcpy(keys, replay_keys, keys_num * sizeof(replay_key_t));
+        replay_keys_num = 0;
+        thread_release_mutex(replay_keys_mutex);
+
+        for (int c = 0; c < keys_num; c++) {
+            replay_write(REPLAY_EV_KEY, &keys[c], sizeof(replay_key_t));
+            keyboard_input_deliver(keys[c].down, keys[c].scan);
+        }
+    } else {
+        while (replay_due(REPLAY_EV_KEY)) {
+            const replay_key_t *key = (const replay_key_t *) replay_next_data;
+
+            if (replay_next.len == sizeof(replay_key_t))
+                keyboard_input_deliver(key->down, key->scan);
+            replay_consume();
+        }
+    }
+}
+
+/* Returns 1 if the keystroke was taken, and must not be delivered directly. */
+int
+replay_queue_key(int down, uint16_t scan)
+{
+    if (replay_mode == REPLAY_NONE)
+        return 0;
+
+    if (replay_mode == REPLAY_RECORD) {
+        thread_wait_mutex(replay_keys_mutex);
+        if (replay_keys_num < REPLAY_KEYS_MAX) {
+            replay_keys[replay_keys_num].scan  = scan;
+            replay_keys[replay_keys_num].down  = !!down;
+            replay_keys[replay_keys_num++].pad = 0;
+        } else
+            replay_log("Replay: key queue full, dropping scan code %04X\n", scan);
+        thread_release_mutex(replay_keys_mutex);
+    }
+
+    return 1;
+}
+
+/* On recording, mouse holds the input the UI staged since the last poll; on
+   playback, it is filled in from the log. Returns 1 if it is to be applied. */
+int
+replay_mouse(replay_mouse_t *mouse)
+{
+    if (replay_mode == REPLAY_RECORD) {
+        if ((mouse->x == 0.0) && (mouse->y == 0.0) && !mouse->z && !mouse->w && (mouse->buttons == replay_last_buttons))
+            return 0;
+
+        mouse->pad          = 0;
+        replay_last_buttons = mouse->buttons;
+        replay_write(REPLAY_EV_MOUSE, mouse, sizeof(replay_mouse_t));
+        return 1;
+    }
+
+    if (!replay_due(REPLAY_EV_MOUSE) || (replay_next.len != sizeof(replay_mouse_t)))
+        return 0;
+
+    memcpy(mouse, replay_next_data, sizeof(replay_mouse_t));
+    replay_consume();
+    return 1;
+}
+
+/* res is whether pkt was taken from the host queue. On playback, host packets
+   are dropped and the card gets the recorded ones instead. */
+int
+replay_net_rx(int card_num, netpkt_t *pkt, int res)
+{
+    uint16_t num = card_num;
+    int      len;
+
+    if (replay_mode == REPLAY_RECORD) {
+        if (res) {
+            uint8_t data[sizeof(uint16_t) + NET_MAX_FRAME];
+
+            memcpy(data, &num, sizeof(uint16_t));
+            memcpy(data + sizeof(uint16_t), pkt->data, pkt->len);
+            replay_write(REPLAY_EV_NET, data, sizeof(uint16_t) + pkt->len);
+        }
+        return res;
+    }
+
+    pkt->len = 0;
+    if (!replay_due(REPLAY_EV_NET) || (replay_next.len < sizeof(uint16_t)) || memcmp(replay_next_data, &num, sizeof(uint16_t)))
+        return 0;
+
+    len = replay_next.len - sizeof(uint16_t);
+    if (len > NET_MAX_FRAME)
+        len = NET_MAX_FRAME;
+    memcpy(pkt->data, replay_next_data + sizeof(uint16_t), len);
+    pkt->len = len;
+    replay_consume();
+    return 1;
+}
+
+int64_t
+replay_host_time(int64_t now)
+{
+    if (replay_mode == REPLAY_RECORD)
+        replay_write(REPLAY_EV_TIME, &now, sizeof(int64_t));
+    else if (replay_due(REPLAY_EV_TIME)) {
+        if (replay_next.len == sizeof(int64_t))
+            memcpy(&now, replay_next_data, sizeof(int64_t));
+        replay_consume();
+    }
+
+    return now;
+}
@@ -0,0 +1,956 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Machine save state subsystem.
+ *
+ *
+ *
+ * Authors: The 86Box development team
+ *
+ *          Copyright 2026 The 86Box development team
+ */
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#define HAVE_STDARG_H
+#include <86box/86box.h>
+#include "cpu.h"
+#include "x86.h"
+#include "x87_sf.h"
+#include "x87.h"
+#include <86box/timer.h>
+#include <86box/device.h>
+#include <86box/dma.h>
+#include <86box/machine.h>
+#include <86box/mem.h>
+#include <86box/nmi.h>
+#include <86box/path.h>
+#include <86box/pic.h>
+#include <86box/plat.h>
+#include <86box/savestate.h>
+
+#define SAVESTATE_MAGIC     "86BOXSS"
+#define SAVESTATE_CHAIN_MAX 65536 /* guards against circular chains */
+
+typedef struct savestate_header_t {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t ptr_size;
+    uint32_t mem_size;
+    int32_t  cpu;
+    uint32_t pad;
+    char     machine[64];
+    char     cpu_family[64];
+    char     parent[256]; /* delta states: the state this one applies on top of */
+} savestate_header_t;
+
+typedef struct savestate_section_t {
+    char     name[56];
+    uint64_t len;
+} savestate_section_t;
+
+struct savestate_t {
+    FILE    *fp;
+    int      loading;
+    int      delta;
+    int      error;
+    int64_t  section_start; /* file offset of the current section's payload */
+    uint64_t section_len;   /* payload length, when loading */
+    uint64_t section_pos;   /* payload bytes written or read so far */
+};
+
+#ifdef ENABLE_SAVESTATE_LOG
+int savestate_do_log = ENABLE_SAVESTATE_LOG;
+
+static void
+savestate_log(const char *fmt, ...)
+{
+    va_list ap;
+
+    if (savestate_do_log) {
+        va_start(ap, fmt);
+        pclog_ex(fmt, ap);
+        va_end(ap);
+    }
+}
+#else
+#    define savestate_log(fmt, ...)
+#endif
+
+void
+savestate_set_error(savestate_t *state)
+{
+    state->error = 1;
+}
+
+int
+savestate_is_loading(savestate_t *state)
+{
+    return state->loading;
+}
+
+int
+savestate_is_delta(savestate_t *state)
+{
+    return state->delta;
+}
+
+void
+savestate_write(savestate_t *state, const void *data, size_t len)
+{
+    if (state->error)
+        return;
+
+    if (fwrite(data, 1, len, state->fp) != len)
+        state->error = 1;
+    state->section_pos += len;
+}
+
+/* On a short or out of section read the destination is left untouched. */
+void
+savestate_read(savestate_t *state, void *data, size_t len)
+{
+    if (state->error)
+        return;
+
+    if (((state->section_pos + len) > state->section_len) || (fread(data, 1, len, state->fp) != len)) {
+        state->error = 1;
+        return;
+    }
+    state->section_pos += len;
+}
+
+/* Timestamps are stored as they are, as the TSC itself is restored first. */
+void
+savestate_write_timer(savestate_t *state, pc_timer_t *timer)
+{
+    uint32_t flags = timer->flags & (TIMER_ENABLED | TIMER_SPLIT);
+
+    savestate_write_var(state, flags);
+    savestate_write_var(state, timer->ts.ts64);
+    savestate_write_var(state, timer->period);
+}
+
+void
+savestate_read_timer(savestate_t *state, pc_timer_t *timer)
+{
+    uint32_t flags;
+    uint64_t ts;
+    double   period;
+
+    savestate_read_var(state, flags);
+    savestate_read_var(state, ts);
+    savestate_read_var(state, period);
+    if (state->error)
+        return;
+
+    timer_disable(timer);
+    timer->ts.ts64 = ts;
+    timer->period  = period;
+    timer->flags   = (timer->flags & ~TIMER_SPLIT) | (flags & TIMER_SPLIT);
+    if (flags & TIMER_ENABLED)
+        timer_enable(timer);
+}
+
+void
+savestate_var(savestate_t *state, void *data, size_t len)
+{
+    if (state->loading)
+        savestate_read(state, data, len);
+    else
+        savestate_write(state, data, len);
+}
+
+void
+savestate_timer(savestate_t *state, pc_timer_t *timer)
+{
+    if (state->loading)
+        savestate_read_timer(state, timer);
+    else
+        savestate_write_timer(state, timer);
+}
+
+/* A minimal LZ77 packer for blocks of up to SAVESTATE_CHUNK bytes, in the
+   LZ4 sequence format: a token with the literal count in the high nibble and
+   the match length minus 4 in the low one, each extended by 255-valued bytes
+   from 15 up, then the literals, then a 16-bit match offset. The last
+   sequence has literals only. Returns the packed length, or 0 if the block
+   does not pack below cap bytes. */
+#define SAVESTATE_CHUNK     4096
+#define SAVESTATE_HASH_BITS 12
+
+static int
+savestate_pack_len(uint8_t *dst, int pos, int cap, int len)
+{
+    for (; len >= 255; len -= 255) {
+        if (pos >= cap)
+            return -1;
+        dst[pos++] = 255;
+    }
+    if (pos >= cap)
+        return -1;
+    dst[pos++] = len;
+    return pos;
+}
+
+static int
+savestate_pack_seq(uint8_t *dst, int pos, int cap, const uint8_t *lit, int lit_len, int offset, int match_len)
+{
+    int token = ((lit_len < 15) ? lit_len : 15) << 4;
+
+    if (offset)
+        token |= ((match_len - 4) < 15) ? (match_len - 4) : 15;
+
+    if (pos >= cap)
+        return -1;
+    dst[pos++] = token;
+    if ((lit_len >= 15) && ((pos = savestate_pack_len(dst, pos, cap, lit_len - 15)) < 0))
+        return -1;
+    if ((pos + lit_len) > cap)
+        return -1;
+    memcpy(&dst[pos], lit, lit_len);
+    pos += lit_len;
+
+    if (offset) {
+        if ((pos + 2) > cap)
+            return -1;
+        dst[pos++] = offset & 0xff;
+        dst[pos++] = offset >> 8;
+        if (((match_len - 4) >= 15) && ((pos = savestate_pack_len(dst, pos, cap, match_len - 4 - 15)) < 0))
+            return -1;
+    }
+
+    return pos;
+}
+
+static int
+savestate_pack(const uint8_t *src, int len, uint8_t *dst, int cap)
+{
+    uint16_t table[1 << SAVESTATE_HASH_BITS];
+    int      pos    = 0;
+    int      anchor = 0;
+    int      ip     = 0;
+
+    memset(table, 0xff, sizeof(table));
+
+    while ((ip + 4) <= len) {
+        uint32_t seq;
+        uint32_t hash;
+        int      cand;
+        int      match_len;
+
+        memcpy(&seq, &src[ip], 4);
+        hash        = (seq * 2654435761u) >> (32 - SAVESTATE_HASH_BITS);
+        cand        = table[hash];
+        table[hash] = ip;
+
+        if ((cand == 0xffff) || memcmp(&src[cand], &src[ip], 4)) {
+            ip++;
+            continue;
+        }
+
+        for (match_len = 4; ((ip + match_len) < len) && (src[cand + match_len] == src[ip + match_len]); match_len++)
+            ;
+
+        pos = savestate_pack_seq(dst, pos, cap, &src[anchor], ip - anchor, ip - cand, match_len);
+        if (pos < 0)
+            return 0;
+        ip += match_len;
+        anchor = ip;
+    }
+
+    pos = savestate_pack_seq(dst, pos, cap, &src[anchor], len - anchor, 0, 0);
+    return (pos < 0) ? 0 : pos;
+}
+
+static int
+savestate_unpack_len(const uint8_t *src, int *pos, int len, int *val)
+{
+    uint8_t c;
+
+    do {
+        if (*pos >= len)
+            return -1;
+        c = src[(*pos)++];
+        *val += c;
+    } while (c == 255);
+
+    return 0;
+}
+
+/* Returns 0 if src unpacks to exactly len bytes. */
+static int
+savestate_unpack(const uint8_t *src, int src_len, uint8_t *dst, int len)
+{
+    int pos = 0;
+    int op  = 0;
+
+    while (pos < src_len) {
+        int token   = src[pos++];
+        int lit_len = token >> 4;
+        int match_len;
+        int offset;
+
+        if ((lit_len == 15) && savestate_unpack_len(src, &pos, src_len, &lit_len))
+            return -1;
+        if (((pos + lit_len) > src_len) || ((op + lit_len) > len))
+            return -1;
+        memcpy(&dst[op], &src[pos], lit_len);
+        pos += lit_len;
+        op += lit_len;
+
+        if (pos == src_len)
+            break;
+
+        if ((pos + 2) > src_len)
+            return -1;
+        offset = src[pos] | (src[pos + 1] << 8);
+        pos += 2;
+        match_len = token & 15;
+        if ((match_len == 15) && savestate_unpack_len(src, &pos, src_len, &match_len))
+            return -1;
+        match_len += 4;
+        if (!offset || (offset > op) || ((op + match_len) > len))
+            return -1;
+        for (int c = 0; c < match_len; c++, op++)
+            dst[op] = dst[op - offset];
+    }
+
+    return (op == len) ? 0 : -1;
+}
+
+/* Large blocks are stored in chunks, each prefixed with its packed length, or
+   with 0 if it did not pack and is stored as it is. */
+void
+savestate_write_block(savestate_t *state, const void *data, size_t len)
+{
+    const uint8_t *src = (const uint8_t *) data;
+    uint8_t        packed[SAVESTATE_CHUNK];
+    uint16_t       packed_len;
+
+    while (len && !state->error) {
+        int chunk = (len > SAVESTATE_CHUNK) ? SAVESTATE_CHUNK : (int) len;
+
+        packed_len = savestate_pack(src, chunk, packed, chunk - 1);
+        savestate_write_var(state, packed_len);
+        if (packed_len)
+            savestate_write(state, packed, packed_len);
+        else
+            savestate_write(state, src, chunk);
+
+        src += chunk;
+        len -= chunk;
+    }
+}
+
+void
+savestate_read_block(savestate_t *state, void *data, size_t len)
+{
+    uint8_t *dst = (uint8_t *) data;
+    uint8_t  packed[SAVESTATE_CHUNK];
+    uint16_t packed_len;
+
+    while (len && !state->error) {
+        int chunk = (len > SAVESTATE_CHUNK) ? SAVESTATE_CHUNK : (int) len;
+
+        savestate_read_var(state, packed_len);
+        if (packed_len >= chunk)
+            state->error = 1;
+        else if (!packed_len)
+            savestate_read(state, dst, chunk);
+        else {
+            savestate_read(state, packed, packed_len);
+            if (!state->error && savestate_unpack(packed, packed_len, dst, chunk))
+                state->error = 1;
+        }
+
+        dst += chunk;
+        len -= chunk;
+    }
+}
+
+void
+savestate_block(savestate_t *state, void *data, size_t len)
+{
+    if (state->loading)
+        savestate_read_block(state, data, len);
+    else
+        savestate_write_block(state, data, len);
+}
+
+int
+savestate_section(savestate_t *state, const char *name)
+{
+    savestate_section_t section;
+
+    if (state->error)
+        return 0;
+
+    memset(&section, 0x00, sizeof(savestate_section_t));
+
+    if (state->loading) {
+        if ((fread(&section, sizeof(savestate_section_t), 1, state->fp) != 1) ||
+            strncmp(section.name, name, sizeof(section.name) - 1)) {
+            state->error = 1;
+            return 0;
+        }
+        state->section_len = section.len;
+    } else {
+        strncpy(section.name, name, sizeof(section.name) - 1);
+        if (fwrite(&section, sizeof(savestate_section_t), 1, state->fp) != 1) {
+            state->error = 1;
+            return 0;
+        }
+    }
+
+    state->section_start = ftello64(state->fp);
+    state->section_pos   = 0;
+
+    savestate_log("Save state: section \"%s\" at %" PRIi64 "\n", name, state->section_start);
+
+    return 1;
+}
+
+/* A section that was not consumed exactly means the layout of the saving
+   build differs, so that is treated as an error as well. */
+void
+savestate_section_end(savestate_t *state)
+{
+    int64_t end;
+
+    if (state->error)
+        return;
+
+    if (state->loading) {
+        if (state->section_pos != state->section_len)
+            state->error = 1;
+        return;
+    }
+
+    end = ftello64(state->fp);
+    if (fseeko64(state->fp, state->section_start - (int64_t) sizeof(uint64_t), SEEK_SET) ||
+        (fwrite(&state->section_pos, sizeof(uint64_t), 1, state->fp) != 1) || fseeko64(state->fp, end, SEEK_SET))
+        state->error = 1;
+}
+
+static void
+savestate_header_init(savestate_header_t *header)
+{
+    memset(header, 0x00, sizeof(savestate_header_t));
+    memcpy(header->magic, SAVESTATE_MAGIC, sizeof(SAVESTATE_MAGIC));
+    header->version    = SAVESTATE_VERSION;
+    header->byte_order = 0x01020304;
+    header->ptr_size   = sizeof(void *);
+    header->mem_size   = mem_size;
+    header->cpu        = cpu;
+    strncpy(header->machine, machine_get_internal_name(), sizeof(header->machine) - 1);
+    strncpy(header->cpu_family, cpu_f->internal_name, sizeof(header->cpu_family) - 1);
+}
+
+/* cpu_state.ea_seg points at one of the segment caches in cpu_state, so it is
+   stored as an offset. */
+static void
+savestate_cpu(savestate_t *state)
+{
+    uint32_t ea_seg = (uint32_t) ((uintptr_t) cpu_state.ea_seg - (uintptr_t) &cpu_state);
+    uint64_t new_tsc = tsc;
+
+    if (state->loading) {
+        savestate_read_var(state, cpu_state);
+        savestate_read_var(state, ea_seg);
+        if (ea_seg > (sizeof(cpu_state_t) - sizeof(x86seg)))
+            ea_seg = (uint32_t) ((uintptr_t) &cpu_state.seg_ds - (uintptr_t) &cpu_state);
+        cpu_state.ea_seg = (x86seg *) ((uintptr_t) &cpu_state + ea_seg);
+        savestate_read_var(state, new_tsc);
+    } else {
+        savestate_write_var(state, cpu_state);
+        savestate_write_var(state, ea_seg);
+        savestate_write_var(state, new_tsc);
+    }
+
+    SAVESTATE_VAR(state, cr2);
+    SAVESTATE_VAR(state, cr3);
+    SAVESTATE_VAR(state, cr4);
+    SAVESTATE_VAR(state, dr);
+    SAVESTATE_VAR(state, msr);
+    SAVESTATE_VAR(state, gdt);
+    SAVESTATE_VAR(state, ldt);
+    SAVESTATE_VAR(state, idt);
+    SAVESTATE_VAR(state, tr);
+    SAVESTATE_VAR(state, cpu_cur_status);
+    SAVESTATE_VAR(state, use32);
+    SAVESTATE_VAR(state, stack32);
+    SAVESTATE_VAR(state, codegen_flat_ds);
+    SAVESTATE_VAR(state, codegen_flat_ss);
+    SAVESTATE_VAR(state, x87_pc_off);
+    SAVESTATE_VAR(state, x87_op_off);
+    SAVESTATE_VAR(state, x87_pc_seg);
+    SAVESTATE_VAR(state, x87_op_seg);
+    SAVESTATE_VAR(state, fpu_state);
+    SAVESTATE_VAR(state, XMM);
+    SAVESTATE_VAR(state, mxcsr);
+    SAVESTATE_VAR(state, amd_efer);
+    SAVESTATE_VAR(state, star);
+    SAVESTATE_VAR(state, cs_msr);
+    SAVESTATE_VAR(state, esp_msr);
+    SAVESTATE_VAR(state, eip_msr);
+    SAVESTATE_VAR(state, ccr0);
+    SAVESTATE_VAR(state, ccr1);
+    SAVESTATE_VAR(state, ccr2);
+    SAVESTATE_VAR(state, ccr3);
+    SAVESTATE_VAR(state, ccr4);
+    SAVESTATE_VAR(state, ccr5);
+    SAVESTATE_VAR(state, ccr6);
+    SAVESTATE_VAR(state, ccr7);
+    SAVESTATE_VAR(state, cpu_cache_int_enabled);
+    SAVESTATE_VAR(state, cpu_cache_ext_enabled);
+    SAVESTATE_VAR(state, cpu_old_paging);
+    SAVESTATE_VAR(state, smi_latched);
+    SAVESTATE_VAR(state, smm_in_hlt);
+    SAVESTATE_VAR(state, smi_block);
+    SAVESTATE_VAR(state, nmi);
+    SAVESTATE_VAR(state, nmi_mask);
+    SAVESTATE_VAR(state, trap);
+
+    /* Rebase the timers that are not part of the state onto the saved TSC;
+       the ones that are get their saved timestamps afterwards. */
+    if (state->loading && !state->error)
+        timer_set_new_tsc(new_tsc);
+}
+
+static void
+savestate_core(savestate_t *state)
+{
+    if (savestate_section(state, "cpu")) {
+        savestate_cpu(state);
+        savestate_section_end(state);
+    }
+
+    if (savestate_section(state, "mem")) {
+        if (state->loading)
+            mem_load_state(state);
+        else
+            mem_save_state(state);
+        savestate_section_end(state);
+    }
+
+    if (savestate_section(state, "pic")) {
+        if (state->loading)
+            pic_load_state(state);
+        else
+            pic_save_state(state);
+        savestate_section_end(state);
+    }
+
+    if (savestate_section(state, "dma")) {
+        if (state->loading)
+            dma_load_state(state);
+        else
+            dma_save_state(state);
+        savestate_section_end(state);
+    }
+}
+
+/* The file the next checkpoint is a delta of; only meaningful while the memory
+   subsystem is tracking dirty pages, which stops on a hard reset. */
+static char checkpoint_parent[1024];
+
+/* A parent in the same directory is referenced by name only, so that a chain
+   can be moved around as a whole. */
+static int
+savestate_set_parent(savestate_header_t *header, const char *fn, const char *parent)
+{
+    char  fn_dir[1024];
+    char  parent_dir[1024];
+    char *name;
+
+    path_get_dirname(fn_dir, fn);
+    path_get_dirname(parent_dir, parent);
+    name = (char *) parent;
+    if (!strcmp(fn_dir, parent_dir))
+        name = path_get_filename(name);
+    else if (!path_abs(name) && (path_get_filename(name) == name))
+        return -1; /* would be looked up next to fn */
+
+    if (strlen(name) >= sizeof(header->parent))
+        return -1;
+
+    strcpy(header->parent, name);
+    return 0;
+}
+
+static int
+savestate_save_file(const char *fn, const char *parent)
+{
+    savestate_header_t header;
+    savestate_t        state;
+
+    if (device_check_state()) {
+        pclog("savestate_save: the machine has devices without save state support\n");
+        return -1;
+    }
+
+    memset(&state, 0x00, sizeof(savestate_t));
+
+    savestate_header_init(&header);
+    if (parent) {
+        if (savestate_set_parent(&header, fn, parent)) {
+            pclog("savestate_save: %s can not be referenced from %s\n", parent, fn);
+            return -1;
+        }
+        state.delta = 1;
+    }
+
+    state.fp = plat_fopen64(fn, "wb");
+    if (state.fp == NULL) {
+        pclog("savestate_save: unable to create %s\n", fn);
+        return -1;
+    }
+
+    if (fwrite(&header, sizeof(savestate_header_t), 1, state.fp) != 1)
+        state.error = 1;
+
+    savestate_core(&state);
+    device_save_state(&state);
+
+    if (fclose(state.fp))
+        state.error = 1;
+
+    if (state.error) {
+        pclog("savestate_save: error writing %s\n", fn);
+        remove(fn);
+        return -1;
+    }
+
+    if (parent)
+        pclog("savestate_save: saved %s as a delta of %s\n", fn, parent);
+    else
+        pclog("savestate_save: saved %s\n", fn);
+    return 0;
+}
+
+int
+savestate_save(const char *fn)
+{
+    return savestate_save_file(fn, NULL);
+}
+
+/* Checks the header of fn against the running machine and returns the path of
+   its parent in parent, or an empty string for a full state. */
+static int
+savestate_read_header(FILE *fp, const char *fn, char *parent, size_t size)
+{
+    savestate_header_t header;
+    savestate_header_t current;
+    char               name[sizeof(header.parent)];
+
+    savestate_header_init(&current);
+    if (fread(&header, sizeof(savestate_header_t), 1, fp) != 1)
+        return -1;
+
+    memcpy(name, header.parent, sizeof(name));
+    name[sizeof(name) - 1] = '\0';
+    memset(header.parent, 0x00, sizeof(header.parent));
+    if (memcmp(&header, &current, sizeof(savestate_header_t)))
+        return -1;
+
+    if (!name[0] || path_abs(name) || (path_get_filename(name) != name)) {
+        strcpy(parent, name);
+        return 0;
+    }
+
+    if ((strlen(fn) + strlen(name) + 2) > size)
+        return -1;
+    path_get_dirname(parent, fn);
+    if (parent[0])
+        path_append_filename(parent, parent, name);
+    else
+        strcpy(parent, name);
+
+    return 0;
+}
+
+/* Returns whether name is fn or one of the states fn is a delta of. A chain
+   that can not be followed any further is taken to end there. */
+static int
+savestate_chain_contains(const char *fn, const char *name)
+{
+    char  path[1024];
+    char  parent[1024];
+    FILE *fp;
+    int   ret;
+
+    if (strlen(fn) >= sizeof(path))
+        return 0;
+
+    strcpy(path, fn);
+    for (int c = 0; path[0] && (c < SAVESTATE_CHAIN_MAX); c++) {
+        if (!strcmp(path, name))
+            return 1;
+
+        fp = plat_fopen64(path, "rb");
+        if (fp == NULL)
+            break;
+        ret = savestate_read_header(fp, path, parent, sizeof(parent));
+        fclose(fp);
+        if (ret)
+            break;
+        strcpy(path, parent);
+    }
+
+    return 0;
+}
+
+/* The first checkpoint is a full state; each following one only carries the
+   RAM pages written since the previous one, and names it as its parent. A
+   checkpoint written over its own parent starts a new chain; one written over
+   an older state of the chain is refused, as the chain would then loop back
+   on itself. */
+int
+savestate_checkpoint(const char *fn)
+{
+    const char *parent = NULL;
+
+    if (strlen(fn) >= sizeof(checkpoint_parent)) {
+        pclog("savestate_checkpoint: path %s is too long\n", fn);
+        return -1;
+    }
+
+    if (mem_dirty_active() && checkpoint_parent[0] && strcmp(fn, checkpoint_parent)) {
+        if (savestate_chain_contains(checkpoint_parent, fn)) {
+            pclog("savestate_checkpoint: %s is already part of the chain of %s\n", fn, checkpoint_parent);
+            return -1;
+        }
+        parent = checkpoint_parent;
+    }
+
+    if (savestate_save_file(fn, parent))
+        return -1;
+
+    strcpy(checkpoint_parent, fn);
+    mem_dirty_start();
+    return 0;
+}
+
+/* A delta state is restored by restoring its chain of parents first, oldest
+   first. All headers are checked before anything is touched. */
+int
+savestate_load(const char *fn)
+{
+    char       (*chain)[1024] = NULL;
+    char       (*new_chain)[1024];
+    char         parent[1024];
+    int          chain_len = 0;
+    int          ret       = -1;
+    savestate_t  state;
+    FILE        *fp;
+
+    if (device_check_state()) {
+        pclog("savestate_load: the machine has devices without save state support\n");
+        return -1;
+    }
+
+    if (strlen(fn) >= sizeof(parent)) {
+        pclog("savestate_load: path %s is too long\n", fn);
+        return -1;
+    }
+
+    strcpy(parent, fn);
+    while (parent[0]) {
+        if (chain_len == SAVESTATE_CHAIN_MAX) {
+            pclog("savestate_load: the chain of %s is too long\n", fn);
+            goto done;
+        }
+        if (!(chain_len & 63)) {
+            new_chain = realloc(chain, (chain_len + 64) * sizeof(chain[0]));
+            if (new_chain == NULL)
+                goto done;
+            chain = new_chain;
+        }
+        strcpy(chain[chain_len], parent);
+
+        fp = plat_fopen64(chain[chain_len], "rb");
+        if (fp == NULL) {
+            pclog("savestate_load: unable to open %s\n", chain[chain_len]);
+            goto done;
+        }
+        if (savestate_read_header(fp, chain[chain_len], parent, sizeof(parent))) {
+            pclog("savestate_load: %s was not saved by this build from this machine configuration\n", chain[chain_len]);
+            fclose(fp);
+            goto done;
+        }
+        fclose(fp);
+        chain_len++;
+
+        for (int c = 0; parent[0] && (c < chain_len); c++) {
+            if (!strcmp(chain[c], parent)) {
+                pclog("savestate_load: the chain of %s loops back to %s\n", fn, parent);
+                goto done;
+            }
+        }
+    }
+
+    memset(&state, 0x00, sizeof(savestate_t));
+    state.loading = 1;
+
+    for (int c = chain_len - 1; c >= 0; c--) {
+        state.fp    = plat_fopen64(chain[c], "rb");
+        state.delta = (c != (chain_len - 1));
+        if ((state.fp == NULL) || fseeko64(state.fp, sizeof(savestate_header_t), SEEK_SET))
+            state.error = 1;
+        else {
+            savestate_log("Save state: restoring %s\n", chain[c]);
+            savestate_core(&state);
+            device_load_state(&state);
+        }
+
+        if (state.fp)
+            fclose(state.fp);
+        if (state.error)
+            break;
+    }
+
+    /* Cached translations and compiled code refer to the old RAM contents. */
+    cpu_state.abrt = 0;
+    flushmmucache();
+#ifdef USE_DYNAREC
+    codegen_reset();
+#endif
+    cpu_update_waitstates();
+
+    if (state.error) {
+        /* The machine has been partially overwritten by now. */
+        pclog("savestate_load: error reading %s, resetting the machine\n", fn);
+        pc_reset_hard();
+        goto done;
+    }
+
+    /* Further checkpoints continue the chain from the restored state. */
+    if (mem_dirty_active()) {
+        strcpy(checkpoint_parent, fn);
+        mem_dirty_start();
+    }
+
+    pclog("savestate_load: restored %s\n", fn);
+    ret = 0;
+
+done:
+    free(chain);
+    return ret;
+}
+
+/* Walks two states section by section, and logs the first one that differs
+   along with the offset into its payload. */
+static int
+savestate_compare(const char *fn1, const char *fn2)
+{
+    savestate_section_t sec1;
+    savestate_section_t sec2;
+    uint8_t            *buf1 = malloc(65536);
+    uint8_t            *buf2 = malloc(65536);
+    FILE               *fp1  = plat_fopen64(fn1, "rb");
+    FILE               *fp2  = plat_fopen64(fn2, "rb");
+    uint64_t            pos;
+    size_t              len;
+    int                 ret = -1;
+
+    if ((buf1 == NULL) || (buf2 == NULL) || (fp1 == NULL) || (fp2 == NULL) ||
+        (fread(buf1, 1, sizeof(savestate_header_t), fp1) != sizeof(savestate_header_t)) ||
+        (fread(buf2, 1, sizeof(savestate_header_t), fp2) != sizeof(savestate_header_t)) ||
+        memcmp(buf1, buf2, sizeof(savestate_header_t))) {
+        pclog("savestate_verify: the headers of %s and %s differ\n", fn1, fn2);
+        goto done;
+    }
+
+    while (fread(&sec1, sizeof(savestate_section_t), 1, fp1) == 1) {
+        if ((fread(&sec2, sizeof(savestate_section_t), 1, fp2) != 1) ||
+            memcmp(&sec1, &sec2, sizeof(savestate_section_t))) {
+            pclog("savestate_verify: section %.56s is missing or of a different length\n", sec1.name);
+            goto done;
+        }
+
+        for (pos = 0; pos < sec1.len; pos += len) {
+            len = ((sec1.len - pos) > 65536) ? 65536 : (size_t) (sec1.len - pos);
+            if ((fread(buf1, 1, len, fp1) != len) || (fread(buf2, 1, len, fp2) != len)) {
+                pclog("savestate_verify: section %.56s is truncated\n", sec1.name);
+                goto done;
+            }
+            if (memcmp(buf1, buf2, len)) {
+                for (size_t i = 0; i < len; i++) {
+                    if (buf1[i] != buf2[i]) {
+                        pclog("savestate_verify: section %.56s differs at offset %" PRIu64 "\n",
+                              sec1.name, pos + i);
+                        break;
+                    }
+                }
+                goto done;
+            }
+        }
+    }
+
+    if (fread(&sec2, sizeof(savestate_section_t), 1, fp2) == 1)
+        pclog("savestate_verify: %s has an extra section %.56s\n", fn2, sec2.name);
+    else
+        ret = 0;
+
+done:
+    if (fp1)
+        fclose(fp1);
+    if (fp2)
+        fclose(fp2);
+    free(buf1);
+    free(buf2);
+    return ret;
+}
+
+/* Round-trip check: the machine is saved to fn and restored from it, and then
+   has to save to exactly the same state again. With checkpoint set, fn is
+   taken as a checkpoint instead, so that restoring it goes through the whole
+   chain it is part of, and the result is checked against a full state taken
+   just before. */
+int
+savestate_verify(const char *fn, int checkpoint)
+{
+    char        ref[1024];
+    char        check[1024];
+    const char *before = fn;
+    int         ret    = -1;
+
+    if ((snprintf(ref, sizeof(ref), "%s.ref", fn) >= (int) sizeof(ref)) ||
+        (snprintf(check, sizeof(check), "%s.check", fn) >= (int) sizeof(check))) {
+        pclog("savestate_verify: path %s is too long\n", fn);
+        return -1;
+    }
+
+    if (checkpoint) {
+        if (savestate_save(ref))
+            return -1;
+        before = ref;
+    }
+
+    if (checkpoint ? savestate_checkpoint(fn) : savestate_save(fn))
+        goto done;
+    if (savestate_load(fn) || savestate_save(check))
+        goto done;
+
+    ret = savestate_compare(before, check);
+    remove(check);
+
+    if (ret == 0)
+        pclog("savestate_verify: %s restores to the state it was saved from\n", fn);
+
+done:
+    if (checkpoint)
+        remove(ref);
+    return ret;
+}
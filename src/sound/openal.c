@@ -126,7 +126,7 @@ inital(void)
 
     int         init_midi = 0;
 
-    if (initialized)
+    if (initialized || headless)
         return;
 
     alutInit(0, 0);
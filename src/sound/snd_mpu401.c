@@ -18,6 +18,7 @@
  */
 #include <inttypes.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -33,6 +34,7 @@
 #include <86box/midi.h>
 #include <86box/pic.h>
 #include <86box/plat.h>
+#include <86box/savestate.h>
 #include <86box/timer.h>
 #include <86box/snd_mpu401.h>
 #include <86box/sound.h>
@@ -1672,6 +1674,23 @@ mpu401_change_addr(mpu_t *mpu, uint16_t addr)
                       mpu401_read, NULL, NULL, mpu401_write, NULL, NULL, mpu);
 }
 
+/* Everything up to the timers, for the sound cards that carry one to save
+   along with their own state. */
+void
+mpu401_state(mpu_t *mpu, savestate_t *state)
+{
+    uint16_t addr = mpu->addr;
+
+    savestate_var(state, &mpu->uart_mode, offsetof(mpu_t, mpu401_event_callback) - offsetof(mpu_t, uart_mode));
+    savestate_timer(state, &mpu->mpu401_event_callback);
+    savestate_timer(state, &mpu->mpu401_eoi_callback);
+    savestate_timer(state, &mpu->mpu401_reset_callback);
+    SAVESTATE_VAR(state, addr);
+
+    if (savestate_is_loading(state) && (addr != mpu->addr))
+        mpu401_change_addr(mpu, addr);
+}
+
 void
 mpu401_init(mpu_t *mpu, uint16_t addr, int irq, int mode, int receive_input)
 {
@@ -1793,6 +1812,12 @@ mpu401_standalone_init(const device_t *info)
     return mpu;
 }
 
+static void
+mpu401_standalone_state(void *priv, savestate_t *state)
+{
+    mpu401_state((mpu_t *) priv, state);
+}
+
 static void
 mpu401_standalone_close(void *priv)
 {
@@ -1909,7 +1934,9 @@ const device_t mpu401_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = mpu401_standalone_config
+    .config        = mpu401_standalone_config,
+    .save          = mpu401_standalone_state,
+    .load          = mpu401_standalone_state
 };
 
 const device_t mpu401_mca_device = {
@@ -1923,5 +1950,7 @@ const device_t mpu401_mca_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = mpu401_standalone_mca_config
+    .config        = mpu401_standalone_mca_config,
+    .save          = mpu401_standalone_state,
+    .load          = mpu401_standalone_state
 };
@@ -38,6 +38,7 @@
  *          Copyright 2013-2020 Alexey Khokholov (Nuke.YKT)
  */
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -49,8 +50,10 @@
 #include "cpu.h"
 #include <86box/timer.h>
 #include <86box/device.h>
+#include <86box/thread.h>
 #include <86box/snd_opl.h>
 #include <86box/snd_opl_nuked.h>
+#include <86box/savestate.h>
 
 
 #if OPL_ENABLE_STEREOEXT && !defined OPL_SIN
@@ -1525,6 +1528,102 @@ nuked_drv_set_do_cycles(void *priv, int8_t do_cycles)
         dev->flags &= ~FLAG_CYCLES;
 }
 
+/* Synthesis runs on a thread of its own.  The CPU side only queues register
+   writes, stamped with the sample position they happened at, so the chip is
+   fed exactly what it would have been fed inline; the end of each frame is
+   queued the same way.  A frame is handed to the mixer one frame after it was
+   queued, which gives the render thread a whole frame to finish it in. */
+#define NUKED_FIFO_FRAME 0xffff
+
+#define NUKED_FIFO_ENTRIES (atomic_load(&dev->fifo_write_idx) - atomic_load(&dev->fifo_read_idx))
+#define NUKED_FIFO_FULL    (NUKED_FIFO_ENTRIES >= NUKED_FIFO_SIZE)
+#define NUKED_FIFO_EMPTY   (NUKED_FIFO_ENTRIES == 0)
+
+static void
+nuked_render_to(nuked_drv_t *dev, int pos)
+{
+    if (dev->pos >= pos)
+        return;
+
+    OPL3_GenerateStream(&dev->opl,
+                          &dev->buffer[dev->pos * 2],
+                          pos - dev->pos);
+
+    for (; dev->pos < pos; dev->pos++) {
+        dev->buffer[dev->pos * 2] /= 2;
+        dev->buffer[(dev->pos * 2) + 1] /= 2;
+    }
+}
+
+static void
+nuked_render_thread(void *priv)
+{
+    nuked_drv_t *dev = (nuked_drv_t *) priv;
+
+    while (dev->render_on) {
+        thread_wait_event(dev->wake_render_thread, -1);
+        thread_reset_event(dev->wake_render_thread);
+
+        while (!NUKED_FIFO_EMPTY) {
+            int      idx = atomic_load(&dev->fifo_read_idx);
+            int      pos = dev->fifo[idx & NUKED_FIFO_MASK].pos;
+            uint16_t reg = dev->fifo[idx & NUKED_FIFO_MASK].reg;
+            uint8_t  val = dev->fifo[idx & NUKED_FIFO_MASK].val;
+
+            nuked_render_to(dev, pos);
+
+            if (reg == NUKED_FIFO_FRAME) {
+                int frame = atomic_load(&dev->frames_done);
+
+                memcpy(dev->frames[frame & 1], dev->buffer, sizeof(dev->buffer));
+                dev->pos = 0;
+                atomic_store(&dev->frames_done, frame + 1);
+            } else {
+                OPL3_WriteRegBuffered(&dev->opl, reg, val);
+                if (reg == 0x105)
+                    dev->opl.newm = val & 0x01;
+            }
+
+            atomic_store(&dev->fifo_read_idx, idx + 1);
+
+            if (reg == NUKED_FIFO_FRAME)
+                thread_set_event(dev->render_done_event);
+        }
+
+        thread_set_event(dev->render_done_event);
+    }
+}
+
+static void
+nuked_fifo_queue(nuked_drv_t *dev, uint16_t reg, uint8_t val)
+{
+    int idx = atomic_load(&dev->fifo_write_idx);
+
+    while (NUKED_FIFO_FULL) {
+        thread_reset_event(dev->render_done_event);
+        if (NUKED_FIFO_FULL)
+            thread_wait_event(dev->render_done_event, 1); /* Wait for room in the FIFO. */
+    }
+
+    dev->fifo[idx & NUKED_FIFO_MASK].pos = music_pos_global;
+    dev->fifo[idx & NUKED_FIFO_MASK].reg = reg;
+    dev->fifo[idx & NUKED_FIFO_MASK].val = val;
+    atomic_store(&dev->fifo_write_idx, idx + 1);
+
+    thread_set_event(dev->wake_render_thread);
+}
+
+/* Waits until the render thread has caught up with everything queued. */
+static void
+nuked_fifo_drain(nuked_drv_t *dev)
+{
+    while (!NUKED_FIFO_EMPTY) {
+        thread_reset_event(dev->render_done_event);
+        if (!NUKED_FIFO_EMPTY)
+            thread_wait_event(dev->render_done_event, 1);
+    }
+}
+
 static void *
 nuked_drv_init(const device_t *info)
 {
@@ -1541,6 +1640,15 @@ nuked_drv_init(const device_t *info)
     timer_add(&dev->timers[0], nuked_timer_1, dev, 0);
     timer_add(&dev->timers[1], nuked_timer_2, dev, 0);
 
+    atomic_init(&dev->fifo_read_idx, 0);
+    atomic_init(&dev->fifo_write_idx, 0);
+    atomic_init(&dev->frames_done, 0);
+
+    dev->render_on          = 1;
+    dev->wake_render_thread = thread_create_event();
+    dev->render_done_event  = thread_create_event();
+    dev->render_thread      = thread_create(nuked_render_thread, dev);
+
     return dev;
 }
 
@@ -1548,27 +1656,31 @@ static void
 nuked_drv_close(void *priv)
 {
     nuked_drv_t *dev = (nuked_drv_t *) priv;
+
+    dev->render_on = 0;
+    thread_set_event(dev->wake_render_thread);
+    thread_wait(dev->render_thread);
+
+    thread_destroy_event(dev->wake_render_thread);
+    thread_destroy_event(dev->render_done_event);
+
     free(dev);
 }
 
+/* Returns the frame queued by the last reset_buffer(), which the render
+   thread has normally long finished by the time the next one is due. */
 static int32_t *
 nuked_drv_update(void *priv)
 {
     nuked_drv_t *dev = (nuked_drv_t *) priv;
 
-    if (dev->pos >= music_pos_global)
-        return dev->buffer;
-
-    OPL3_GenerateStream(&dev->opl,
-                          &dev->buffer[dev->pos * 2],
-                          music_pos_global - dev->pos);
-
-    for (; dev->pos < music_pos_global; dev->pos++) {
-        dev->buffer[dev->pos * 2] /= 2;
-        dev->buffer[(dev->pos * 2) + 1] /= 2;
+    while (atomic_load(&dev->frames_done) != dev->frames_queued) {
+        thread_reset_event(dev->render_done_event);
+        if (atomic_load(&dev->frames_done) != dev->frames_queued)
+            thread_wait_event(dev->render_done_event, 1);
     }
 
-    return dev->buffer;
+    return dev->frames[(dev->frames_queued - 1) & 1];
 }
 
 static uint8_t
@@ -1579,8 +1691,6 @@ nuked_drv_read(uint16_t port, void *priv)
     if (dev->flags & FLAG_CYCLES)
         cycles -= ((int) (isa_timing * 8));
 
-    nuked_drv_update(dev);
-
     uint8_t ret = 0xff;
 
     if ((port & 0x0003) == 0x0000) {
@@ -1598,10 +1708,10 @@ static void
 nuked_drv_write(uint16_t port, uint8_t val, void *priv)
 {
     nuked_drv_t *dev = (nuked_drv_t *) priv;
-    nuked_drv_update(dev);
 
     if ((port & 0x0001) == 0x0001) {
-        OPL3_WriteRegBuffered(&dev->opl, dev->port, val);
+        nuked_fifo_queue(dev, dev->port, val);
+        dev->regs[dev->port] = val;
 
         switch (dev->port) {
             case 0x002: /* Timer 1 */
@@ -1626,15 +1736,15 @@ nuked_drv_write(uint16_t port, uint8_t val, void *priv)
                 }
                 break;
 
-            case 0x105:
-                dev->opl.newm = val & 0x01;
-                break;
-
             default:
                 break;
         }
     } else {
-        dev->port = nuked_write_addr(&dev->opl, port, val) & 0x01ff;
+        /* The chip belongs to the render thread, so decode NEW from the
+           shadow registers rather than from its newm. */
+        dev->port = val;
+        if ((port & 0x0002) && ((val == 0x05) || (dev->regs[0x105] & 0x01)))
+            dev->port |= 0x0100;
 
         if (!(dev->flags & FLAG_OPL3))
             dev->port &= 0x00ff;
@@ -1646,7 +1756,45 @@ nuked_drv_reset_buffer(void *priv)
 {
     nuked_drv_t *dev = (nuked_drv_t *) priv;
 
-    dev->pos = 0;
+    nuked_fifo_queue(dev, NUKED_FIFO_FRAME, 0x00);
+    dev->frames_queued++;
+}
+
+/* The chip itself is full of pointers into itself, so it is not stored, but
+   reset and given its registers again, mode bits first; notes that were
+   sounding start over from their attack. */
+static void
+nuked_drv_state(void *priv, savestate_t *state)
+{
+    nuked_drv_t *dev = (nuked_drv_t *) priv;
+
+    /* Let the render thread finish, so that it leaves the chip alone. */
+    nuked_fifo_drain(dev);
+
+    savestate_var(state, &dev->flags, offsetof(nuked_drv_t, timers) - offsetof(nuked_drv_t, flags));
+    savestate_timer(state, &dev->timers[0]);
+    savestate_timer(state, &dev->timers[1]);
+    SAVESTATE_VAR(state, dev->pos);
+    SAVESTATE_VAR(state, dev->buffer);
+    SAVESTATE_VAR(state, dev->frames);
+    SAVESTATE_VAR(state, dev->frames_queued);
+
+    if (savestate_is_loading(state)) {
+        atomic_store(&dev->frames_done, dev->frames_queued);
+
+        OPL3_Reset(&dev->opl, FREQ_49716);
+
+        if (dev->flags & FLAG_OPL3) {
+            OPL3_WriteReg(&dev->opl, 0x105, dev->regs[0x105]);
+            OPL3_WriteReg(&dev->opl, 0x104, dev->regs[0x104]);
+        }
+
+        for (uint16_t i = 0x020; i < 0x200; i++) {
+            if ((i & 0xff) >= 0x20)
+                OPL3_WriteReg(&dev->opl, i, dev->regs[i]);
+        }
+        OPL3_WriteReg(&dev->opl, 0x008, dev->regs[0x008]);
+    }
 }
 
 const device_t ym3812_nuked_device = {
@@ -1660,7 +1808,9 @@ const device_t ym3812_nuked_device = {
     .available     = NULL ,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nuked_drv_state,
+    .load          = nuked_drv_state
 };
 
 const device_t ymf262_nuked_device = {
@@ -1674,7 +1824,9 @@ const device_t ymf262_nuked_device = {
     .available     = NULL,
     .speed_changed = NULL,
     .force_redraw  = NULL,
-    .config        = NULL
+    .config        = NULL,
+    .save          = nuked_drv_state,
+    .load          = nuked_drv_state
 };
 
 const fm_drv_t nuked_opl_drv = {
@@ -38,6 +38,7 @@
 #include <86box/midi.h>
 #include <86box/pic.h>
 #include <86box/rom.h>
+#include <86box/savestate.h>
 #include <86box/sound.h>
 #include "cpu.h"
 #include <86box/timer.h>
@@ -3232,6 +3233,18 @@ sb_16_init(UNUSED(const device_t *info))
     return sb;
 }
 
+/* The OPL and the game port are devices of their own, and save themselves. */
+static void
+sb_16_state(void *priv, savestate_t *state)
+{
+    sb_t *sb = (sb_t *) priv;
+
+    sb_dsp_state(&sb->dsp, state);
+    SAVESTATE_VAR(state, sb->mixer_sb16);
+    if (sb->mpu != NULL)
+        mpu401_state(sb->mpu, state);
+}
+
 static void *
 sb_16_reply_mca_init(UNUSED(const device_t *info))
 {
@@ -5528,7 +5541,9 @@ const device_t sb_16_device = {
     .available     = NULL,
     .speed_changed = sb_speed_changed,
     .force_redraw  = NULL,
-    .config        = sb_16_config
+    .config        = sb_16_config,
+    .save          = sb_16_state,
+    .load          = sb_16_state
 };
 
 const device_t sb_vibra16c_onboard_device = {
@@ -5598,7 +5613,9 @@ const device_t sb_vibra16s_onboard_device = {
     .available     = NULL,
     .speed_changed = sb_speed_changed,
     .force_redraw  = NULL,
-    .config        = sb_16_config
+    .config        = sb_16_config,
+    .save          = sb_16_state,
+    .load          = sb_16_state
 };
 
 const device_t sb_vibra16s_device = {
@@ -5612,7 +5629,9 @@ const device_t sb_vibra16s_device = {
     .available     = NULL,
     .speed_changed = sb_speed_changed,
     .force_redraw  = NULL,
-    .config        = sb_16_config
+    .config        = sb_16_config,
+    .save          = sb_16_state,
+    .load          = sb_16_state
 };
 
 const device_t sb_vibra16xv_onboard_device = {
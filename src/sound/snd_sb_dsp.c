@@ -8,6 +8,7 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -22,6 +23,7 @@
 #include <86box/io.h>
 #include <86box/midi.h>
 #include <86box/pic.h>
+#include <86box/savestate.h>
 #include <86box/snd_azt2316a.h>
 #include <86box/sound.h>
 #include <86box/timer.h>
@@ -3058,6 +3060,33 @@ sb_dsp_update(sb_dsp_t *dsp)
     }
 }
 
+/* Everything but the callbacks set up by the card, in the ranges between
+   them; the card saves its mixer, and the MPU-401 attached, itself. */
+void
+sb_dsp_state(sb_dsp_t *dsp, savestate_t *state)
+{
+#define SB_DSP_RANGE(from, to) \
+    savestate_var(state, &dsp->from, offsetof(sb_dsp_t, to) - offsetof(sb_dsp_t, from))
+
+    SB_DSP_RANGE(sb_8_length, dma_readb);
+    SB_DSP_RANGE(sb_read_data, irq_update);
+    SB_DSP_RANGE(sbe2, output_timer);
+    savestate_timer(state, &dsp->output_timer);
+    savestate_timer(state, &dsp->input_timer);
+    SB_DSP_RANGE(sblatcho, wb_timer);
+    savestate_timer(state, &dsp->wb_timer);
+    SAVESTATE_VAR(state, dsp->wb_full);
+    savestate_timer(state, &dsp->irq_timer);
+    savestate_timer(state, &dsp->irq16_timer);
+    SB_DSP_RANGE(busy_count, record_buffer);
+    savestate_block(state, dsp->record_buffer, sizeof(dsp->record_buffer));
+    SB_DSP_RANGE(buffer, espcm_fifo);
+    fifo_state(dsp->espcm_fifo, state);
+    SB_DSP_RANGE(espcm_fifo_reset, mpu);
+
+#undef SB_DSP_RANGE
+}
+
 void
 sb_dsp_close(UNUSED(sb_dsp_t *dsp))
 {
@@ -26,6 +26,7 @@
 #include <86box/pit.h>
 #include <86box/snd_speaker.h>
 #include <86box/sound.h>
+#include <86box/savestate.h>
 #include <86box/plat_unused.h>
 
 int speaker_mute       = 0;
@@ -108,6 +109,20 @@ speaker_get_buffer(int32_t *buffer, int len, UNUSED(void *priv))
     speaker_pos = 0;
 }
 
+/* The buffered output is not kept, only what shapes the next samples. */
+void
+speaker_state(savestate_t *state)
+{
+    SAVESTATE_VAR(state, speaker_gated);
+    SAVESTATE_VAR(state, speaker_enable);
+    SAVESTATE_VAR(state, was_speaker_enable);
+    SAVESTATE_VAR(state, gated);
+    SAVESTATE_VAR(state, speakval);
+    SAVESTATE_VAR(state, speakon);
+    SAVESTATE_VAR(state, speaker_mode);
+    SAVESTATE_VAR(state, speaker_count);
+}
+
 void
 speaker_init(void)
 {
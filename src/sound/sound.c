@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #define HAVE_STDARG_H
 
 #include <86box/86box.h>
@@ -31,6 +32,7 @@
 #include <86box/machine.h>
 #include <86box/midi.h>
 #include <86box/plat.h>
+#include <86box/prof.h>
 #include <86box/thread.h>
 #include <86box/snd_ac97.h>
 #include <86box/timer.h>
@@ -63,14 +65,8 @@ static thread_t  *sound_cd_thread_h;
 static event_t   *sound_cd_event;
 static event_t   *sound_cd_start_event;
 static int32_t   *outbuffer;
-static float     *outbuffer_ex;
-static int16_t   *outbuffer_ex_int16;
 static int32_t   *outbuffer_m;
-static float     *outbuffer_m_ex;
-static int16_t   *outbuffer_m_ex_int16;
 static int32_t   *outbuffer_w;
-static float     *outbuffer_w_ex;
-static int16_t   *outbuffer_w_ex_int16;
 static int        sound_handlers_num;
 static int        music_handlers_num;
 static int        wavetable_handlers_num;
@@ -90,6 +86,35 @@ static int          cd_buf_update    = CD_BUFLEN / SOUNDBUFLEN;
 static volatile int cdaudioon        = 0;
 static int          cd_thread_enable = 0;
 
+/* Mixed buffers are handed to the output thread through a single-producer,
+   single-consumer ring, which keeps the conversion to the output format and
+   the calls into the audio backend off the emulation thread. The mixing
+   itself stays on the emulation thread, in the poll timers: the handlers'
+   get_buffer callbacks read device state that the CPU thread keeps
+   changing, and none of them lock it. */
+#define SOUND_OUT_SOUND     0
+#define SOUND_OUT_MUSIC     1
+#define SOUND_OUT_WAVETABLE 2
+
+#define SOUND_OUT_SLOTS  8
+#define SOUND_OUT_MAXLEN (MAX(SOUNDBUFLEN, MAX(MUSICBUFLEN, WTBUFLEN)) * 2)
+
+typedef struct sound_out_slot_t {
+    int     src;
+    int     len;
+    int32_t buf[SOUND_OUT_MAXLEN];
+} sound_out_slot_t;
+
+static sound_out_slot_t sound_out_slots[SOUND_OUT_SLOTS];
+static atomic_uint      sound_out_head; /* Written by the emulation thread. */
+static atomic_uint      sound_out_tail; /* Written by the output thread. */
+static float            sound_out_float[SOUND_OUT_MAXLEN];
+static int16_t          sound_out_int16[SOUND_OUT_MAXLEN];
+static thread_t        *sound_out_thread_h;
+static event_t         *sound_out_event;
+static event_t         *sound_out_start_event;
+static volatile int     sound_out_on = 0;
+
 static void (*filter_cd_audio)(int channel, double *buffer, void *priv) = NULL;
 static void *filter_cd_audio_p                                          = NULL;
 
@@ -368,70 +393,104 @@ sound_cd_thread(UNUSED(void *param))
     }
 }
 
+/* Convert a mixed buffer to the output format and pass it to the backend. */
 static void
-sound_realloc_buffers(void)
+sound_out_give(int src, const int32_t *buf, int len)
 {
-    if (outbuffer_ex != NULL) {
-        free(outbuffer_ex);
-        outbuffer_ex = NULL;
+    for (int c = 0; c < len; c++) {
+        if (sound_is_float)
+            sound_out_float[c] = ((float) buf[c]) / (float) 32768.0;
+        else if (buf[c] > 32767)
+            sound_out_int16[c] = 32767;
+        else if (buf[c] < -32768)
+            sound_out_int16[c] = -32768;
+        else
+            sound_out_int16[c] = (int16_t) buf[c];
     }
 
-    if (outbuffer_ex_int16 != NULL) {
-        free(outbuffer_ex_int16);
-        outbuffer_ex_int16 = NULL;
+    switch (src) {
+        case SOUND_OUT_SOUND:
+            givealbuffer(sound_is_float ? (void *) sound_out_float : (void *) sound_out_int16);
+            break;
+        case SOUND_OUT_MUSIC:
+            givealbuffer_music(sound_is_float ? (void *) sound_out_float : (void *) sound_out_int16);
+            break;
+        case SOUND_OUT_WAVETABLE:
+            givealbuffer_wt(sound_is_float ? (void *) sound_out_float : (void *) sound_out_int16);
+            break;
+        default:
+            break;
     }
+}
+
+static void
+sound_out_thread(UNUSED(void *param))
+{
+    sound_out_slot_t *slot;
+    unsigned int      tail;
 
-    if (sound_is_float) {
-        outbuffer_ex = calloc(SOUNDBUFLEN * 2, sizeof(float));
-        memset(outbuffer_ex, 0x00, SOUNDBUFLEN * 2 * sizeof(float));
-    } else {
-        outbuffer_ex_int16 = calloc(SOUNDBUFLEN * 2, sizeof(int16_t));
-        memset(outbuffer_ex_int16, 0x00, SOUNDBUFLEN * 2 * sizeof(int16_t));
+    thread_set_event(sound_out_start_event);
+
+    while (sound_out_on) {
+        thread_wait_event(sound_out_event, -1);
+        thread_reset_event(sound_out_event);
+
+        tail = atomic_load_explicit(&sound_out_tail, memory_order_relaxed);
+        while (sound_out_on && (tail != atomic_load_explicit(&sound_out_head, memory_order_acquire))) {
+            slot = &sound_out_slots[tail % SOUND_OUT_SLOTS];
+            sound_out_give(slot->src, slot->buf, slot->len);
+            atomic_store_explicit(&sound_out_tail, ++tail, memory_order_release);
+        }
     }
 }
 
 static void
-music_realloc_buffers(void)
+sound_out_queue(int src, const int32_t *buf, int len)
 {
-    if (outbuffer_m_ex != NULL) {
-        free(outbuffer_m_ex);
-        outbuffer_m_ex = NULL;
-    }
+    sound_out_slot_t *slot;
+    unsigned int      head;
 
-    if (outbuffer_m_ex_int16 != NULL) {
-        free(outbuffer_m_ex_int16);
-        outbuffer_m_ex_int16 = NULL;
+    if (!sound_out_on) {
+        sound_out_give(src, buf, len);
+        return;
     }
 
-    if (sound_is_float) {
-        outbuffer_m_ex = calloc(MUSICBUFLEN * 2, sizeof(float));
-        memset(outbuffer_m_ex, 0x00, MUSICBUFLEN * 2 * sizeof(float));
-    } else {
-        outbuffer_m_ex_int16 = calloc(MUSICBUFLEN * 2, sizeof(int16_t));
-        memset(outbuffer_m_ex_int16, 0x00, MUSICBUFLEN * 2 * sizeof(int16_t));
-    }
+    /* If the output thread has fallen behind, drop the buffer, as the
+       backend does when its own queue is full. */
+    head = atomic_load_explicit(&sound_out_head, memory_order_relaxed);
+    if ((head - atomic_load_explicit(&sound_out_tail, memory_order_acquire)) >= SOUND_OUT_SLOTS)
+        return;
+
+    slot      = &sound_out_slots[head % SOUND_OUT_SLOTS];
+    slot->src = src;
+    slot->len = len;
+    memcpy(slot->buf, buf, len * sizeof(int32_t));
+    atomic_store_explicit(&sound_out_head, head + 1, memory_order_release);
+
+    thread_set_event(sound_out_event);
 }
 
+/* Started by sound_reset() once the backend is up, and stopped again before
+   a hard reset closes the backend, so the thread never calls into it while
+   it is being torn down. */
 static void
-wavetable_realloc_buffers(void)
+sound_out_thread_start(void)
 {
-    if (outbuffer_w_ex != NULL) {
-        free(outbuffer_w_ex);
-        outbuffer_w_ex = NULL;
-    }
+    if (sound_out_on)
+        return;
 
-    if (outbuffer_w_ex_int16 != NULL) {
-        free(outbuffer_w_ex_int16);
-        outbuffer_w_ex_int16 = NULL;
-    }
+    atomic_store(&sound_out_head, 0);
+    atomic_store(&sound_out_tail, 0);
 
-    if (sound_is_float) {
-        outbuffer_w_ex = calloc(WTBUFLEN * 2, sizeof(float));
-        memset(outbuffer_w_ex, 0x00, WTBUFLEN * 2 * sizeof(float));
-    } else {
-        outbuffer_w_ex_int16 = calloc(WTBUFLEN * 2, sizeof(int16_t));
-        memset(outbuffer_w_ex_int16, 0x00, WTBUFLEN * 2 * sizeof(int16_t));
-    }
+    sound_out_on = 1;
+
+    sound_out_start_event = thread_create_event();
+
+    sound_out_event    = thread_create_event();
+    sound_out_thread_h = thread_create(sound_out_thread, NULL);
+
+    thread_wait_event(sound_out_start_event, -1);
+    thread_reset_event(sound_out_start_event);
 }
 
 void
@@ -439,15 +498,6 @@ sound_init(void)
 {
     int available_cdrom_drives = 0;
 
-    outbuffer_ex       = NULL;
-    outbuffer_ex_int16 = NULL;
-
-    outbuffer_m_ex       = NULL;
-    outbuffer_m_ex_int16 = NULL;
-
-    outbuffer_w_ex       = NULL;
-    outbuffer_w_ex_int16 = NULL;
-
     outbuffer = NULL;
     outbuffer = calloc(SOUNDBUFLEN * 2, sizeof(int32_t));
     memset(outbuffer, 0x00, SOUNDBUFLEN * 2 * sizeof(int32_t));
@@ -549,28 +599,13 @@ sound_poll(UNUSED(void *priv))
     if (sound_pos_global == SOUNDBUFLEN) {
         int c;
 
+        PROF_ENTER(&prof_sound);
         memset(outbuffer, 0x00, SOUNDBUFLEN * 2 * sizeof(int32_t));
 
         for (c = 0; c < sound_handlers_num; c++)
             sound_handlers[c].get_buffer(outbuffer, SOUNDBUFLEN, sound_handlers[c].priv);
 
-        for (c = 0; c < SOUNDBUFLEN * 2; c++) {
-            if (sound_is_float)
-                outbuffer_ex[c] = ((float) outbuffer[c]) / (float) 32768.0;
-            else {
-                if (outbuffer[c] > 32767)
-                    outbuffer[c] = 32767;
-                if (outbuffer[c] < -32768)
-                    outbuffer[c] = -32768;
-
-                outbuffer_ex_int16[c] = (int16_t) outbuffer[c];
-            }
-        }
-
-        if (sound_is_float)
-            givealbuffer(outbuffer_ex);
-        else
-            givealbuffer(outbuffer_ex_int16);
+        sound_out_queue(SOUND_OUT_SOUND, outbuffer, SOUNDBUFLEN * 2);
 
         if (cd_thread_enable) {
             cd_buf_update--;
@@ -579,6 +614,7 @@ sound_poll(UNUSED(void *priv))
                 thread_set_event(sound_cd_event);
             }
         }
+        PROF_LEAVE();
 
         sound_pos_global = 0;
     }
@@ -593,28 +629,14 @@ music_poll(UNUSED(void *priv))
     if (music_pos_global == MUSICBUFLEN) {
         int c;
 
+        PROF_ENTER(&prof_sound);
         memset(outbuffer_m, 0x00, MUSICBUFLEN * 2 * sizeof(int32_t));
 
         for (c = 0; c < music_handlers_num; c++)
             music_handlers[c].get_buffer(outbuffer_m, MUSICBUFLEN, music_handlers[c].priv);
 
-        for (c = 0; c < MUSICBUFLEN * 2; c++) {
-            if (sound_is_float)
-                outbuffer_m_ex[c] = ((float) outbuffer_m[c]) / (float) 32768.0;
-            else {
-                if (outbuffer_m[c] > 32767)
-                    outbuffer_m[c] = 32767;
-                if (outbuffer_m[c] < -32768)
-                    outbuffer_m[c] = -32768;
-
-                outbuffer_m_ex_int16[c] = (int16_t) outbuffer_m[c];
-            }
-        }
-
-        if (sound_is_float)
-            givealbuffer_music(outbuffer_m_ex);
-        else
-            givealbuffer_music(outbuffer_m_ex_int16);
+        sound_out_queue(SOUND_OUT_MUSIC, outbuffer_m, MUSICBUFLEN * 2);
+        PROF_LEAVE();
 
         music_pos_global = 0;
     }
@@ -629,28 +651,14 @@ wavetable_poll(UNUSED(void *priv))
     if (wavetable_pos_global == WTBUFLEN) {
         int c;
 
+        PROF_ENTER(&prof_sound);
         memset(outbuffer_w, 0x00, WTBUFLEN * 2 * sizeof(int32_t));
 
         for (c = 0; c < wavetable_handlers_num; c++)
             wavetable_handlers[c].get_buffer(outbuffer_w, WTBUFLEN, wavetable_handlers[c].priv);
 
-        for (c = 0; c < WTBUFLEN * 2; c++) {
-            if (sound_is_float)
-                outbuffer_w_ex[c] = ((float) outbuffer_w[c]) / (float) 32768.0;
-            else {
-                if (outbuffer_w[c] > 32767)
-                    outbuffer_w[c] = 32767;
-                if (outbuffer_w[c] < -32768)
-                    outbuffer_w[c] = -32768;
-
-                outbuffer_w_ex_int16[c] = (int16_t) outbuffer_w[c];
-            }
-        }
-
-        if (sound_is_float)
-            givealbuffer_wt(outbuffer_w_ex);
-        else
-            givealbuffer_wt(outbuffer_w_ex_int16);
+        sound_out_queue(SOUND_OUT_WAVETABLE, outbuffer_w, WTBUFLEN * 2);
+        PROF_LEAVE();
 
         wavetable_pos_global = 0;
     }
@@ -669,17 +677,13 @@ sound_speed_changed(void)
 void
 sound_reset(void)
 {
-    sound_realloc_buffers();
-
-    music_realloc_buffers();
-
-    wavetable_realloc_buffers();
-
     midi_out_device_init();
     midi_in_device_init();
 
     inital();
 
+    sound_out_thread_start();
+
     timer_add(&sound_poll_timer, sound_poll, NULL, 1);
 
     sound_handlers_num = 0;
@@ -741,6 +745,31 @@ sound_cd_thread_end(void)
     }
 }
 
+void
+sound_out_thread_end(void)
+{
+    if (sound_out_on) {
+        sound_out_on = 0;
+
+        sound_log("Waiting for sound output thread to terminate...\n");
+        thread_set_event(sound_out_event);
+        thread_wait(sound_out_thread_h);
+        sound_log("Sound output thread terminated...\n");
+
+        /* Drop whatever the thread had not handed to the backend yet; it
+           belongs to the machine being closed. */
+        atomic_store(&sound_out_head, 0);
+        atomic_store(&sound_out_tail, 0);
+
+        thread_destroy_event(sound_out_event);
+        sound_out_event    = NULL;
+        sound_out_thread_h = NULL;
+
+        thread_destroy_event(sound_out_start_event);
+        sound_out_start_event = NULL;
+    }
+}
+
 void
 sound_cd_thread_reset(void)
 {
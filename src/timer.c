@@ -1,90 +1,142 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 #include <86box/86box.h>
 #include "cpu.h"
 #include <86box/timer.h>
+#include <86box/device.h>
+#include <86box/prof.h>
 #include <86box/nv/vid_nv_rivatimer.h>
 
 uint64_t TIMER_USEC;
 uint32_t timer_target;
 
-/*Enabled timers are stored in a linked list, with the first timer to expire at
-  the head.*/
-pc_timer_t *timer_head = NULL;
+/*Enabled timers are stored in a binary min-heap, with the first timer to
+  expire at the root (timer_heap[0]). Each timer records its own position in
+  the heap (plus one, so that zero means "not queued"), which makes removal of
+  an arbitrary timer O(log n) instead of a list walk.
+
+  Timers with identical timestamps are ordered by enable sequence, most recent
+  first, matching the behaviour of the old sorted linked list.*/
+static pc_timer_t **timer_heap      = NULL;
+static uint32_t     timer_heap_num  = 0;
+static uint32_t     timer_heap_size = 0;
+static uint32_t     timer_seq       = 0;
 
 /* Are we initialized? */
 int timer_inited = 0;
 
 static void timer_advance_ex(pc_timer_t *timer, int start);
 
+/*True if timer a should be processed before timer b*/
+static __inline int
+timer_heap_before(pc_timer_t *a, pc_timer_t *b)
+{
+    int64_t diff = (int64_t) (a->ts.ts64 - b->ts.ts64);
+
+    if (diff != 0)
+        return diff < 0;
+
+    return (int32_t) (a->seq - b->seq) > 0;
+}
+
+static __inline void
+timer_heap_place(pc_timer_t *timer, uint32_t pos)
+{
+    timer_heap[pos] = timer;
+    timer->heap_pos = pos + 1;
+}
+
+static void
+timer_heap_sift_up(uint32_t pos)
+{
+    pc_timer_t *timer = timer_heap[pos];
+
+    while (pos > 0) {
+        uint32_t parent = (pos - 1) >> 1;
+
+        if (!timer_heap_before(timer, timer_heap[parent]))
+            break;
+
+        timer_heap_place(timer_heap[parent], pos);
+        pos = parent;
+    }
+
+    timer_heap_place(timer, pos);
+}
+
+static void
+timer_heap_sift_down(uint32_t pos)
+{
+    pc_timer_t *timer = timer_heap[pos];
+
+    while (1) {
+        uint32_t child = (pos << 1) + 1;
+
+        if (child >= timer_heap_num)
+            break;
+
+        if (((child + 1) < timer_heap_num) && timer_heap_before(timer_heap[child + 1], timer_heap[child]))
+            child++;
+
+        if (!timer_heap_before(timer_heap[child], timer))
+            break;
+
+        timer_heap_place(timer_heap[child], pos);
+        pos = child;
+    }
+
+    timer_heap_place(timer, pos);
+}
+
+static void
+timer_heap_remove(pc_timer_t *timer)
+{
+    uint32_t    pos  = timer->heap_pos - 1;
+    pc_timer_t *last = timer_heap[--timer_heap_num];
+
+    timer->heap_pos = 0;
+
+    if (last == timer)
+        return;
+
+    timer_heap_place(last, pos);
+    if ((pos > 0) && timer_heap_before(last, timer_heap[(pos - 1) >> 1]))
+        timer_heap_sift_up(pos);
+    else
+        timer_heap_sift_down(pos);
+}
+
 void
 timer_enable(pc_timer_t *timer)
 {
-    pc_timer_t *timer_node = timer_head;
-    int ret = 0;
-
     if (!timer_inited || (timer == NULL))
         return;
 
     if (timer->flags & TIMER_ENABLED)
         timer_disable(timer);
 
-    if (timer->next || timer->prev)
-        fatal("timer_disable(): Attempting to enable a non-isolated "
+    if (timer->heap_pos)
+        fatal("timer_enable(): Attempting to enable a queued "
               "timer incorrectly marked as disabled\n");
 
-    /*List currently empty - add to head*/
-    if (!timer_head) {
-        timer_head  = timer;
-        timer->next = timer->prev = NULL;
-        timer_target              = timer_head->ts.ts32.integer;
-        ret = 1;
-    } else if (TIMER_LESS_THAN(timer, timer_head)) {
-        timer->next      = timer_head;
-        timer->prev      = NULL;
-        timer_head->prev = timer;
-        timer_head       = timer;
-        timer_target     = timer_head->ts.ts32.integer;
-        ret = 1;
-    } else if (!timer_head->next) {
-        timer_head->next = timer;
-        timer->prev      = timer_head;
-        ret = 1;
+    if (timer_heap_num == timer_heap_size) {
+        timer_heap_size = timer_heap_size ? (timer_heap_size << 1) : 64;
+        timer_heap      = (pc_timer_t **) realloc(timer_heap, timer_heap_size * sizeof(pc_timer_t *));
+        if (timer_heap == NULL)
+            fatal("timer_enable(): Unable to grow the timer heap to %u entries\n", timer_heap_size);
     }
 
-    if (ret == 0) {
-        pc_timer_t *prev = timer_head;
-        timer_node       = timer_head->next;
-
-        while (1) {
-            /*Timer expires before timer_node. Add to list in front of timer_node*/
-            if (TIMER_LESS_THAN(timer, timer_node)) {
-                timer->next      = timer_node;
-                timer->prev      = prev;
-                timer_node->prev = timer;
-                prev->next       = timer;
-                ret = 1;
-                break;
-            }
-
-            /*timer_node is last in the list. Add timer to end of list*/
-            if (!timer_node->next) {
-                timer_node->next = timer;
-                timer->prev      = timer_node;
-                ret = 1;
-                break;
-            }
-
-            prev       = timer_node;
-            timer_node = timer_node->next;
-        }
-    }
+    timer->seq = timer_seq++;
+    timer_heap_place(timer, timer_heap_num++);
+    timer_heap_sift_up(timer->heap_pos - 1);
+
+    if (timer_heap[0] == timer)
+        timer_target = timer->ts.ts32.integer;
 
-    /* Do not mark it as enabled if it has failed every single condition. */
-    if (ret == 1)
-        timer->flags |= TIMER_ENABLED;
+    timer->flags |= TIMER_ENABLED;
 }
 
 void
@@ -93,20 +145,14 @@ timer_disable(pc_timer_t *timer)
     if (!timer_inited || (timer == NULL) || !(timer->flags & TIMER_ENABLED))
         return;
 
-    if (!timer->next && !timer->prev && timer != timer_head)
-        fatal("timer_disable(): Attempting to disable an isolated "
-              "non-head timer incorrectly marked as enabled\n");
+    if (!timer->heap_pos || (timer_heap[timer->heap_pos - 1] != timer))
+        fatal("timer_disable(): Attempting to disable an unqueued "
+              "timer incorrectly marked as enabled\n");
 
     timer->flags &= ~TIMER_ENABLED;
     timer->in_callback = 0;
 
-    if (timer->prev)
-        timer->prev->next = timer->next;
-    else
-        timer_head = timer->next;
-    if (timer->next)
-        timer->next->prev = timer->prev;
-    timer->prev = timer->next = NULL;
+    timer_heap_remove(timer);
 }
 
 void
@@ -114,20 +160,16 @@ timer_process(void)
 {
     pc_timer_t *timer;
 
-    if (!timer_head)
+    if (!timer_heap_num)
         return;
 
-    while (1) {
-        timer = timer_head;
+    while (timer_heap_num) {
+        timer = timer_heap[0];
 
         if (!TIMER_LESS_THAN_VAL(timer, (uint32_t) tsc))
             break;
 
-        timer_head = timer->next;
-        if (timer_head)
-            timer_head->prev = NULL;
-
-        timer->next = timer->prev = NULL;
+        timer_heap_remove(timer);
         timer->flags &= ~TIMER_ENABLED;
 
         if (timer->flags & TIMER_SPLIT)
@@ -138,30 +180,35 @@ timer_process(void)
                have a NULL callback when no operation
                is needed. */
             timer->in_callback = 1;
-            timer->callback(timer->priv);
+#ifdef USE_PROFILER
+            if (prof_active) {
+                prof_enter(prof_timer_section(timer));
+                timer->callback(timer->priv);
+                prof_leave();
+            } else
+#endif
+                timer->callback(timer->priv);
             timer->in_callback = 0;
         }
     }
 
-    timer_target = timer_head->ts.ts32.integer;
+    if (timer_heap_num)
+        timer_target = timer_heap[0]->ts.ts32.integer;
 }
 
 void
 timer_close(void)
 {
-    pc_timer_t *t = timer_head;
-    pc_timer_t *r;
-
-    /* Set all timers' prev and next to NULL so it is assured that
-       timers that are not in malloc'd structs don't keep pointing
-       to timers that may be in malloc'd structs. */
-    while (t != NULL) {
-        r       = t;
-        r->prev = r->next = NULL;
-        t                 = r->next;
-    }
+    /* Clear every queued timer's heap position so it is assured that
+       timers that are not in malloc'd structs don't keep claiming to
+       be queued in a heap that no longer exists. */
+    for (uint32_t i = 0; i < timer_heap_num; i++)
+        timer_heap[i]->heap_pos = 0;
 
-    timer_head = NULL;
+    free(timer_heap);
+    timer_heap      = NULL;
+    timer_heap_num  = 0;
+    timer_heap_size = 0;
 
     timer_inited = 0;
 }
@@ -171,6 +218,7 @@ timer_init(void)
 {
     timer_target = 0ULL;
     tsc          = 0;
+    timer_seq    = 0;
 
     /* Initialise the CPU-independent timer */
     rivatimer_init();
@@ -187,7 +235,10 @@ timer_add(pc_timer_t *timer, void (*callback)(void *priv), void *priv, int start
     timer->in_callback = 0;
     timer->priv        = priv;
     timer->flags       = 0;
-    timer->prev        = timer->next = NULL;
+    timer->heap_pos    = 0;
+#ifdef USE_PROFILER
+    timer->prof = prof_device_section(device_context_get_device());
+#endif
     if (start_timer)
         timer_set_delay_u64(timer, 0);
 }
@@ -264,26 +315,24 @@ timer_on_auto(pc_timer_t *timer, double period)
 void
 timer_set_new_tsc(uint64_t new_tsc)
 {
-    pc_timer_t *timer = NULL;
     /* Run timers already expired. */
 #ifdef USE_DYNAREC
     if (cpu_use_dynarec)
         update_tsc();
 #endif
 
-    if (!timer_head) {
+    if (!timer_heap_num) {
         tsc = new_tsc;
         return;
     }
 
-    timer = timer_head;
-    timer_target = new_tsc + (int32_t)(timer_get_ts_int(timer_head) - (uint32_t)tsc);
+    timer_target = new_tsc + (int32_t)(timer_get_ts_int(timer_heap[0]) - (uint32_t)tsc);
 
-    while (timer) {
+    /* Every timer is rebased by the same offset, so the heap order holds. */
+    for (uint32_t i = 0; i < timer_heap_num; i++) {
+        pc_timer_t *timer = timer_heap[i];
         int32_t offset_from_current_tsc = (int32_t)(timer_get_ts_int(timer) - (uint32_t)tsc);
         timer->ts.ts32.integer = new_tsc + offset_from_current_tsc;
-
-        timer = timer->next;
     }
 
     tsc = new_tsc;
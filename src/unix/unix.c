@@ -27,6 +27,9 @@
 #ifdef __APPLE__
 #    include "macOSXGlue.h"
 #endif
+#ifdef __linux__
+#    include <sys/syscall.h>
+#endif
 
 #include <86box/86box.h>
 #include <86box/mem.h>
@@ -44,10 +47,19 @@
 #include "cpu.h"
 #include <86box/timer.h>
 #include <86box/nvr.h>
+#include <86box/prof.h>
+#include <86box/replay.h>
+#include <86box/savestate.h>
 #include <86box/version.h>
 #include <86box/video.h>
 #include <86box/ui.h>
 #include <86box/gdbstub.h>
+#ifdef USE_DYNAREC
+#    include "codegen_public.h"
+#endif
+#ifdef MTR_ENABLED
+#    include <minitrace/minitrace.h>
+#endif
 
 #define __USE_GNU 1 /* shouldn't be done, yet it is */
 #include <pthread.h>
@@ -424,6 +436,172 @@ plat_munmap(void *ptr, size_t size)
     munmap(ptr, size);
 }
 
+/* Map part of an open file, either read-only and shared with every other
+   process mapping it, or copy-on-write, which still shares the pages until
+   they are written to. The file can be closed afterwards. */
+void *
+plat_mmap_file(FILE *fp, uint64_t offset, size_t size, int copy)
+{
+    void *ret;
+
+    if ((size == 0) || (offset % sysconf(_SC_PAGESIZE)))
+        return NULL;
+
+    ret = mmap(0, size, copy ? (PROT_READ | PROT_WRITE) : PROT_READ,
+               copy ? MAP_PRIVATE : MAP_SHARED, fileno(fp), (off_t) offset);
+
+    return (ret == MAP_FAILED) ? NULL : ret;
+}
+
+void
+plat_munmap_file(void *ptr, size_t size)
+{
+    munmap(ptr, size);
+}
+
+/* Let the host merge identical pages of the block with those of other
+   processes. */
+void
+plat_mem_mergeable(void *ptr, size_t size)
+{
+#ifdef MADV_MERGEABLE
+    madvise(ptr, size, MADV_MERGEABLE);
+#endif
+}
+
+/* Size of the huge pages explicitly requested mappings get. */
+static size_t
+plat_huge_page_size(void)
+{
+    static size_t size = 0;
+#ifdef __linux__
+    FILE         *fp;
+    char          line[128];
+    unsigned long kb;
+#endif
+
+    if (size != 0)
+        return size;
+
+    size = 2 << 20;
+#ifdef __linux__
+    if ((fp = fopen("/proc/meminfo", "r")) != NULL) {
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1) {
+                size = (size_t) kb << 10;
+                break;
+            }
+        }
+        fclose(fp);
+    }
+#endif
+
+    return size;
+}
+
+/* Allocate a block for the emulated RAM. With huge set, the block is backed
+   by transparent huge pages, or, at 2, by explicit ones if the host has any
+   reserved, and its size is rounded up to a whole number of huge pages, which
+   plat_munmap_ram() has to be given the same huge value to match. */
+void *
+plat_mmap_ram(size_t size, int huge)
+{
+    size_t   align = plat_huge_page_size();
+    void    *ret   = MAP_FAILED;
+    uint8_t *ptr;
+    size_t   head;
+
+    if (!huge)
+        return plat_mmap(size, 0);
+
+    size = (size + align - 1) & ~(align - 1);
+
+#ifdef MAP_HUGETLB
+    if (huge >= 2)
+        ret = mmap(0, size, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+#endif
+    if (ret != MAP_FAILED)
+        return ret;
+
+    /* Transparent huge pages are only used for aligned ranges, so over-allocate
+       and trim the block to an aligned one. */
+    ret = mmap(0, size + align, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
+    if (ret == MAP_FAILED)
+        return NULL;
+    ptr  = (uint8_t *) ret;
+    head = (align - ((uintptr_t) ptr & (align - 1))) & (align - 1);
+    if (head)
+        munmap(ptr, head);
+    munmap(ptr + head + size, align - head);
+    ptr += head;
+
+#ifdef MADV_HUGEPAGE
+    madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+
+    return ptr;
+}
+
+void
+plat_munmap_ram(void *ptr, size_t size, int huge)
+{
+    size_t align = plat_huge_page_size();
+
+    if (huge)
+        size = (size + align - 1) & ~(align - 1);
+
+    munmap(ptr, size);
+}
+
+/* Place a block on the NUMA node of the CPU the calling thread runs on,
+   moving the pages already in place. Return the node, or -1 if the block
+   could not be placed. */
+int
+plat_mem_bind_node(void *ptr, size_t size)
+{
+#if defined(__linux__) && defined(SYS_getcpu) && defined(SYS_mbind)
+    unsigned int  cpu;
+    unsigned int  node;
+    unsigned long mask;
+
+    if ((syscall(SYS_getcpu, &cpu, &node, NULL) != 0) || (node >= (sizeof(mask) * 8)))
+        return -1;
+
+    /* MPOL_PREFERRED and MPOL_MF_MOVE, as they are not in libc headers. */
+    mask = 1UL << node;
+    if (syscall(SYS_mbind, ptr, size, 1, &mask, sizeof(mask) * 8 + 1, 1 << 1) != 0)
+        return -1;
+
+    return (int) node;
+#else
+    return -1;
+#endif
+}
+
+int
+plat_mem_usage(uint64_t *resident, uint64_t *shared)
+{
+#ifdef __linux__
+    FILE              *fp = fopen("/proc/self/statm", "r");
+    unsigned long long pages[3];
+    int                ret;
+
+    if (fp == NULL)
+        return -1;
+    ret = fscanf(fp, "%llu %llu %llu", &pages[0], &pages[1], &pages[2]);
+    fclose(fp);
+    if (ret != 3)
+        return -1;
+
+    *resident = pages[1] * sysconf(_SC_PAGESIZE);
+    *shared   = pages[2] * sysconf(_SC_PAGESIZE);
+
+    return 0;
+#else
+    return -1;
+#endif
+}
+
 uint64_t
 plat_timer_read(void)
 {
@@ -540,6 +718,13 @@ strnicmp(const char *s1, const char *s2, size_t n)
     return strncasecmp(s1, s2, n);
 }
 
+/* Nothing is shown in headless mode; frames are released straight away. */
+static void
+headless_blit(UNUSED(int x), UNUSED(int y), UNUSED(int w), UNUSED(int h), int monitor_index)
+{
+    video_blit_complete_monitor(monitor_index);
+}
+
 void
 main_thread(UNUSED(void *param))
 {
@@ -556,11 +741,15 @@ main_thread(UNUSED(void *param))
     while (!is_quit && cpu_thread_run) {
         /* See if it is time to run a frame of code. */
         new_time = SDL_GetTicks();
+        /* In turbo mode frames run back to back. All emulated timers count
+           emulated time, so the guest does not notice. */
+        if (turbo_mode)
+            drawits = 10;
 #ifdef USE_GDBSTUB
-        if (gdbstub_next_asap && (drawits <= 0))
+        else if (gdbstub_next_asap && (drawits <= 0))
             drawits = 10;
-        else
 #endif
+        else
             drawits += (new_time - old_time);
         old_time = new_time;
         if (drawits > 0 && !dopause) {
@@ -582,7 +771,7 @@ main_thread(UNUSED(void *param))
             SDL_Delay(1);
 
         /* If needed, handle a screen resize. */
-        if (atomic_load(&doresize_monitors[0]) && !video_fullscreen && !is_quit) {
+        if (atomic_load(&doresize_monitors[0]) && !video_fullscreen && !headless && !is_quit) {
             if (vid_resize & 2)
                 plat_resize(fixed_size_x, fixed_size_y, 0);
             else
@@ -980,10 +1169,36 @@ monitor_thread(UNUSED(void *param))
                         "zipeject <id> - eject ZIP image from ZIP drive <id>.\n"
                         "carteject <id> - eject cartridge from drive <id>.\n"
                         "moeject <id> - eject image from MO drive <id>.\n\n"
+                        "savestate <filename> - save the state of the emulated system.\n"
+                        "checkpoint <filename> - save the state of the emulated system, as a delta\n"
+                        "                        of the previous checkpoint if there is one.\n"
+                        "loadstate <filename> - restore a saved state of the emulated system.\n"
+                        "verifystate <filename> - save the state, restore it and check that it\n"
+                        "                         saves the same again.\n"
+                        "verifycheckpoint <filename> - the same with a checkpoint, restoring the\n"
+                        "                              whole chain it is part of.\n"
+                        "record <log> [state] - record the inputs of the emulated system to <log>,\n"
+                        "                       from a save state or else from a hard reset.\n"
+                        "replay <log> - replay the inputs recorded in <log>.\n"
+                        "replaystop - stop recording or replaying.\n"
                         "hardreset - hard reset the emulated system.\n"
                         "pause - pause the the emulated system.\n"
                         "fullscreen - toggle fullscreen.\n"
                         "version - print version and license information.\n"
+#if defined(USE_NEW_DYNAREC) && defined(USE_DYNAREC_STATS)
+                        "dynarecstats [reset] - log dynarec block cache statistics.\n"
+#endif
+                        "mmustats [reset] - log MMU lookup cache statistics.\n"
+                        "idlestats - print the share of the last second the emulated CPU was idle.\n"
+                        "memstats - print the host memory used by this instance.\n"
+#ifdef USE_PROFILER
+#    ifdef MTR_ENABLED
+                        "profile start [trace] - start profiling host time, and tracing to <trace>.\n"
+#    else
+                        "profile start - start profiling host time.\n"
+#    endif
+                        "profile [stop|reset] - print the host time profile, then stop or reset it.\n"
+#endif
                         "exit - exit 86Box.\n");
                 } else if (strncasecmp(xargv[0], "exit", 4) == 0) {
                     exit_event = 1;
@@ -1031,6 +1246,107 @@ monitor_thread(UNUSED(void *param))
                     printf("%s", dopause ? "Paused.\n" : "Unpaused.\n");
                 } else if (strncasecmp(xargv[0], "hardreset", 9) == 0) {
                     pc_reset_hard();
+#if defined(USE_NEW_DYNAREC) && defined(USE_DYNAREC_STATS)
+                } else if (strncasecmp(xargv[0], "dynarecstats", 12) == 0) {
+                    startblit();
+                    codegen_stats_dump();
+                    if ((cmdargc >= 2) && (strncasecmp(xargv[1], "reset", 5) == 0))
+                        codegen_stats_reset();
+                    endblit();
+#endif
+                } else if (strncasecmp(xargv[0], "savestate", 9) == 0 && cmdargc >= 2) {
+                    startblit();
+                    if (savestate_save(xargv[1]))
+                        printf("Unable to save state to %s, see the log for details.\n", xargv[1]);
+                    endblit();
+                } else if (strncasecmp(xargv[0], "checkpoint", 10) == 0 && cmdargc >= 2) {
+                    startblit();
+                    if (savestate_checkpoint(xargv[1]))
+                        printf("Unable to save checkpoint to %s, see the log for details.\n", xargv[1]);
+                    endblit();
+                } else if (strncasecmp(xargv[0], "record", 6) == 0 && cmdargc >= 2) {
+                    startblit();
+                    if (replay_record(xargv[1], (cmdargc >= 3) ? xargv[2] : NULL))
+                        printf("Unable to record to %s, see the log for details.\n", xargv[1]);
+                    else if (replay_waiting_reset())
+                        pc_reset_hard();
+                    endblit();
+                } else if (strncasecmp(xargv[0], "replaystop", 10) == 0) {
+                    startblit();
+                    replay_stop();
+                    endblit();
+                } else if (strncasecmp(xargv[0], "replay", 6) == 0 && cmdargc >= 2) {
+                    startblit();
+                    if (replay_play(xargv[1]))
+                        printf("Unable to replay %s, see the log for details.\n", xargv[1]);
+                    else if (replay_waiting_reset())
+                        pc_reset_hard();
+                    endblit();
+                } else if (strncasecmp(xargv[0], "loadstate", 9) == 0 && cmdargc >= 2) {
+                    startblit();
+                    if (savestate_load(xargv[1]))
+                        printf("Unable to load state from %s, see the log for details.\n", xargv[1]);
+                    endblit();
+                } else if (strncasecmp(xargv[0], "verifystate", 11) == 0 && cmdargc >= 2) {
+                    startblit();
+                    if (savestate_verify(xargv[1], 0))
+                        printf("State of %s did not survive a round trip, see the log for details.\n", xargv[1]);
+                    else
+                        printf("State of %s survived a round trip.\n", xargv[1]);
+                    endblit();
+                } else if (strncasecmp(xargv[0], "verifycheckpoint", 16) == 0 && cmdargc >= 2) {
+                    startblit();
+                    if (savestate_verify(xargv[1], 1))
+                        printf("Checkpoint chain of %s did not survive a round trip, see the log for details.\n", xargv[1]);
+                    else
+                        printf("Checkpoint chain of %s survived a round trip.\n", xargv[1]);
+                    endblit();
+                } else if (strncasecmp(xargv[0], "memstats", 8) == 0) {
+                    uint64_t resident;
+                    uint64_t shared;
+
+                    if (plat_mem_usage(&resident, &shared) == 0)
+                        printf("Host memory: %" PRIu64 " KB resident, %" PRIu64 " KB of it shared (density mode %s)\n",
+                               resident >> 10, shared >> 10, density_mode ? "on" : "off");
+                    else
+                        printf("Host memory usage is not available on this platform.\n");
+                } else if (strncasecmp(xargv[0], "idlestats", 9) == 0) {
+                    printf("CPU idle: %i%% (idle skipping %s)\n", cpu_idle_percent,
+                           (cpu_idle_skip >= 2) ? "on HLT and polling" : (cpu_idle_skip ? "on HLT" : "off"));
+                } else if (strncasecmp(xargv[0], "mmustats", 8) == 0) {
+                    startblit();
+                    mem_mmu_stats_dump();
+                    if ((cmdargc >= 2) && (strncasecmp(xargv[1], "reset", 5) == 0))
+                        mem_mmu_stats_reset();
+                    endblit();
+#ifdef USE_PROFILER
+                } else if (strncasecmp(xargv[0], "profile", 7) == 0) {
+                    if ((cmdargc >= 2) && (strncasecmp(xargv[1], "start", 5) == 0)) {
+#    ifdef MTR_ENABLED
+                        if ((cmdargc >= 3) && !tracing_on) {
+                            mtr_init(xargv[2]);
+                            mtr_start();
+                            tracing_on = 1;
+                        }
+#    endif
+                        prof_start();
+                    } else {
+                        startblit();
+                        prof_summary(stdout);
+                        if ((cmdargc >= 2) && (strncasecmp(xargv[1], "stop", 4) == 0))
+                            prof_stop();
+                        else if ((cmdargc >= 2) && (strncasecmp(xargv[1], "reset", 5) == 0))
+                            prof_reset();
+                        endblit();
+#    ifdef MTR_ENABLED
+                        if ((cmdargc >= 2) && (strncasecmp(xargv[1], "stop", 4) == 0) && tracing_on) {
+                            mtr_stop();
+                            mtr_shutdown();
+                            tracing_on = 0;
+                        }
+#    endif
+                    }
+#endif
                 } else if (strncasecmp(xargv[0], "cdload", 6) == 0 && cmdargc >= 3) {
                     uint8_t id;
                     bool    err = false;
@@ -1219,9 +1535,12 @@ main(int argc, char **argv)
     } else
         fprintf(stderr, "libedit not found, line editing will be limited.\n");
     mousemutex = SDL_CreateMutex();
-    sdl_initho();
+    if (headless)
+        video_setblit(headless_blit);
+    else
+        sdl_initho();
 
-    if (start_in_fullscreen) {
+    if (start_in_fullscreen && !headless) {
         video_fullscreen = 1;
         sdl_set_fs(1);
     }
@@ -1364,6 +1683,8 @@ main(int argc, char **argv)
             do_stop();
             break;
         }
+        if (headless)
+            SDL_Delay(1);
     }
     printf("\n");
     SDL_DestroyMutex(blitmtx);
@@ -1394,6 +1715,12 @@ plat_get_cpu_string(char *outbuf, uint8_t len) {
     strncpy(outbuf, cpu_string, len);
 }
 
+int
+plat_cpu_count(void)
+{
+    return SDL_GetCPUCount();
+}
+
 void
 plat_set_thread_name(void *thread, const char *name)
 {
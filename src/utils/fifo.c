@@ -13,6 +13,7 @@
  *          Copyright 2023-2025 Miran Grca.
  */
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -26,6 +27,7 @@
 #define HAVE_STDARG_H
 #include <86box/86box.h>
 #include <86box/fifo.h>
+#include <86box/savestate.h>
 #endif
 
 #ifdef ENABLE_FIFO_LOG
@@ -507,6 +509,24 @@ fifo_reset_evt(void *priv)
         fifo->d_ready_evt(fifo->priv);
 }
 
+#ifndef FIFO_STANDALONE
+/* The counters, then the contents up to the length, which can not grow past
+   the size the FIFO was allocated with. */
+void
+fifo_state(void *priv, savestate_t *state)
+{
+    fifo_t *fifo = (fifo_t *) priv;
+
+    savestate_var(state, fifo, offsetof(fifo_t, priv));
+    if ((fifo->len < 0) || (fifo->len > 64)) {
+        savestate_set_error(state);
+        return;
+    }
+    SAVESTATE_VAR(state, fifo->tag);
+    savestate_var(state, fifo->buf, fifo->len);
+}
+#endif
+
 void
 fifo_close(void *priv)
 {
@@ -21,6 +21,7 @@
  */
 #include <inttypes.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -37,6 +38,8 @@
 #include <86box/mem.h>
 #include <86box/rom.h>
 #include <86box/plat.h>
+#include <86box/prof.h>
+#include <86box/savestate.h>
 #include <86box/ui.h>
 #include <86box/video.h>
 #include <86box/vid_8514a.h>
@@ -45,8 +48,9 @@
 #include <86box/vid_svga_render.h>
 #include <86box/vid_xga_device.h>
 
-void svga_doblit(int wx, int wy, svga_t *svga);
-void svga_poll(void *priv);
+void        svga_doblit(int wx, int wy, svga_t *svga);
+static void svga_doblit_common(int wx, int wy, svga_t *svga, int damage);
+void        svga_poll(void *priv);
 
 svga_t *svga_8514;
 
@@ -172,6 +176,33 @@ svga_set_override(svga_t *svga, int val)
 #endif
 }
 
+/* Map the memory window selected by GDC register 6. */
+static void
+svga_set_window(svga_t *svga, uint8_t val)
+{
+    switch (val & 0xc) {
+        case 0x0: /*128k at A0000*/
+            mem_mapping_set_addr(&svga->mapping, 0xa0000, 0x20000);
+            svga->banked_mask = 0xffff;
+            break;
+        case 0x4: /*64k at A0000*/
+            mem_mapping_set_addr(&svga->mapping, 0xa0000, 0x10000);
+            svga->banked_mask = 0xffff;
+            break;
+        case 0x8: /*32k at B0000*/
+            mem_mapping_set_addr(&svga->mapping, 0xb0000, 0x08000);
+            svga->banked_mask = 0x7fff;
+            break;
+        case 0xC: /*32k at B8000*/
+            mem_mapping_set_addr(&svga->mapping, 0xb8000, 0x08000);
+            svga->banked_mask = 0x7fff;
+            break;
+
+        default:
+            break;
+    }
+}
+
 void
 svga_out(uint16_t addr, uint8_t val, void *priv)
 {
@@ -393,29 +424,8 @@ svga_out(uint16_t addr, uint8_t val, void *priv)
                     svga->chain2_read = val & 0x10;
                     break;
                 case 6:
-                    if ((svga->gdcreg[6] & 0xc) != (val & 0xc)) {
-                        switch (val & 0xc) {
-                            case 0x0: /*128k at A0000*/
-                                mem_mapping_set_addr(&svga->mapping, 0xa0000, 0x20000);
-                                svga->banked_mask = 0xffff;
-                                break;
-                            case 0x4: /*64k at A0000*/
-                                mem_mapping_set_addr(&svga->mapping, 0xa0000, 0x10000);
-                                svga->banked_mask = 0xffff;
-                                break;
-                            case 0x8: /*32k at B0000*/
-                                mem_mapping_set_addr(&svga->mapping, 0xb0000, 0x08000);
-                                svga->banked_mask = 0x7fff;
-                                break;
-                            case 0xC: /*32k at B8000*/
-                                mem_mapping_set_addr(&svga->mapping, 0xb8000, 0x08000);
-                                svga->banked_mask = 0x7fff;
-                                break;
-
-                            default:
-                                break;
-                        }
-                    }
+                    if ((svga->gdcreg[6] & 0xc) != (val & 0xc))
+                        svga_set_window(svga, val);
                     break;
                 case 7:
                     svga->colournocare = val;
@@ -1166,18 +1176,58 @@ svga_recalctimings(svga_t *svga)
         video_force_resize_set_monitor(1, svga->monitor_index);
 }
 
+/* Add a target buffer line to the damage of this frame. */
+static void
+svga_damage_line(svga_t *svga, int line)
+{
+    video_rect_t *run;
+
+    if (svga->damage_num) {
+        run = &svga->damage[svga->damage_num - 1];
+
+        /* Interlaced fields only draw every other line. */
+        if ((line >= run->y) && (line <= (run->y + run->h + 1))) {
+            if (line >= (run->y + run->h))
+                run->h = line - run->y + 1;
+            return;
+        }
+
+        if (svga->damage_num == VIDEO_DAMAGE_MAX) {
+            /* Out of runs, extend the last one. */
+            if (line < run->y) {
+                run->h += run->y - line;
+                run->y = line;
+            } else
+                run->h = line - run->y + 1;
+            return;
+        }
+    }
+
+    run    = &svga->damage[svga->damage_num++];
+    run->y = line;
+    run->h = 1;
+}
+
 static void
 svga_do_render(svga_t *svga)
 {
+    const int firstline_draw = svga->firstline_draw;
+    const int lastline_draw  = svga->lastline_draw;
+
     /* Always render a blank screen and nothing else while in DPMS mode. */
     if (svga->dpms) {
         svga_render_blank(svga);
+        svga_damage_line(svga, svga->displine + svga->y_add);
         return;
     }
 
     if (!svga->override) {
         svga->render(svga);
 
+        /* The renderers skip lines whose VRAM has not changed. */
+        if ((svga->firstline_draw != firstline_draw) || (svga->lastline_draw != lastline_draw))
+            svga_damage_line(svga, svga->displine + svga->y_add);
+
         svga->x_add = (svga->monitor->mon_overscan_x >> 1);
         svga_render_overscan_left(svga);
         svga_render_overscan_right(svga);
@@ -1185,24 +1235,30 @@ svga_do_render(svga_t *svga)
     }
 
     if (svga->overlay_on) {
-        if (!svga->override && svga->overlay_draw)
+        if (!svga->override && svga->overlay_draw) {
             svga->overlay_draw(svga, svga->displine + svga->y_add);
+            svga_damage_line(svga, svga->displine + svga->y_add);
+        }
         svga->overlay_on--;
         if (svga->overlay_on && svga->interlace)
             svga->overlay_on--;
     }
 
     if (svga->dac_hwcursor_on) {
-        if (!svga->override && svga->dac_hwcursor_draw)
+        if (!svga->override && svga->dac_hwcursor_draw) {
             svga->dac_hwcursor_draw(svga, (svga->displine + svga->y_add + ((svga->dac_hwcursor_latch.y >= 0) ? 0 : svga->dac_hwcursor_latch.y)) & 2047);
+            svga_damage_line(svga, (svga->displine + svga->y_add + ((svga->dac_hwcursor_latch.y >= 0) ? 0 : svga->dac_hwcursor_latch.y)) & 2047);
+        }
         svga->dac_hwcursor_on--;
         if (svga->dac_hwcursor_on && svga->interlace)
             svga->dac_hwcursor_on--;
     }
 
     if (svga->hwcursor_on) {
-        if (!svga->override && svga->hwcursor_draw)
+        if (!svga->override && svga->hwcursor_draw) {
             svga->hwcursor_draw(svga, (svga->displine + svga->y_add + ((svga->hwcursor_latch.y >= 0) ? 0 : svga->hwcursor_latch.y)) & 2047);
+            svga_damage_line(svga, (svga->displine + svga->y_add + ((svga->hwcursor_latch.y >= 0) ? 0 : svga->hwcursor_latch.y)) & 2047);
+        }
 
         svga->hwcursor_on--;
         if (svga->hwcursor_on && svga->interlace)
@@ -1269,6 +1325,7 @@ svga_poll(void *priv)
             if (svga->hwcursor_on || svga->dac_hwcursor_on || svga->overlay_on)
                 svga->changedvram[svga->ma >> 12] = svga->changedvram[(svga->ma >> 12) + 1] = svga->interlace ? 3 : 2;
 
+            PROF_ENTER(&prof_video);
             if (svga->vertical_linedbl) {
                 old_ma = svga->ma;
 
@@ -1287,6 +1344,7 @@ svga_poll(void *priv)
                 svga->displine >>= 1;
             } else
                 svga_do_render(svga);
+            PROF_LEAVE();
 
             if (svga->lastline < svga->displine)
                 svga->lastline = svga->displine;
@@ -1406,11 +1464,11 @@ svga_poll(void *priv)
                 if (svga->vertical_linedbl) {
                     wy = (svga->lastline - svga->firstline) << 1;
                     svga->vdisp = wy + 1;
-                    svga_doblit(wx, wy, svga);
+                    svga_doblit_common(wx, wy, svga, 1);
                 } else {
                     wy = svga->lastline - svga->firstline;
                     svga->vdisp = wy + 1;
-                    svga_doblit(wx, wy, svga);
+                    svga_doblit_common(wx, wy, svga, 1);
                 }
             }
 
@@ -1419,6 +1477,7 @@ svga_poll(void *priv)
 
             svga->firstline_draw = 2000;
             svga->lastline_draw  = 0;
+            svga->damage_num     = 0;
 
             svga->oddeven ^= 1;
 
@@ -1503,6 +1562,7 @@ svga_init(const device_t *info, svga_t *svga, void *priv, int memsize,
     svga->priv          = priv;
     svga->monitor_index = monitor_index_global;
     svga->monitor       = &monitors[svga->monitor_index];
+    svga->damage_full   = 1;
 
     for (int c = 0; c < 256; c++) {
         e = c;
@@ -1599,6 +1659,34 @@ svga_init(const device_t *info, svga_t *svga, void *priv, int memsize,
     return 0;
 }
 
+/* The state of the core, for the cards that build on it to save along with
+   their own. Video memory is stored packed, and is all redrawn on restore;
+   the memory window follows GDC register 6, so a card that moves or banks it
+   by other means has to redo that itself after this. */
+void
+svga_state(svga_t *svga, savestate_t *state)
+{
+    savestate_var(state, &svga->fast, offsetof(svga_t, map8) - offsetof(svga_t, fast));
+    SAVESTATE_VAR(state, svga->pallook);
+    SAVESTATE_VAR(state, svga->vgapal);
+    SAVESTATE_VAR(state, svga->dispontime);
+    SAVESTATE_VAR(state, svga->dispofftime);
+    SAVESTATE_VAR(state, svga->latch);
+    savestate_timer(state, &svga->timer);
+    savestate_var(state, &svga->hwcursor, offsetof(svga_t, render) - offsetof(svga_t, hwcursor));
+    savestate_var(state, svga->crtc, offsetof(svga_t, vram) - offsetof(svga_t, crtc));
+    savestate_var(state, &svga->crtcreg, offsetof(svga_t, remap_func) - offsetof(svga_t, crtcreg));
+    savestate_block(state, svga->vram, svga->vram_max);
+
+    if (savestate_is_loading(state)) {
+        svga_set_window(svga, svga->gdcreg[6]);
+
+        memset(svga->changedvram, 0xff, (svga->vram_max >> 12) + 1);
+        svga->fullchange = changeframecount;
+        svga_recalctimings(svga);
+    }
+}
+
 void
 svga_close(svga_t *svga)
 {
@@ -1959,8 +2047,10 @@ svga_read_linear(uint32_t addr, void *priv)
     return svga_read_common(addr, 1, priv);
 }
 
-void
-svga_doblit(int wx, int wy, svga_t *svga)
+/* With damage set, pass the lines drawn by svga_poll() this frame on as the
+   changed areas, rather than the whole screen. */
+static void
+svga_doblit_common(int wx, int wy, svga_t *svga, int damage)
 {
     int       y_add;
     int       x_add;
@@ -1985,8 +2075,10 @@ svga_doblit(int wx, int wy, svga_t *svga)
         bottom <<= 1;
     }
 
-    if ((wx <= 0) || (wy <= 0))
+    if ((wx <= 0) || (wy <= 0)) {
+        svga->damage_full = 1;
         return;
+    }
 
     if (svga->vertical_linedbl)
         svga->y_add <<= 1;
@@ -2021,6 +2113,8 @@ svga_doblit(int wx, int wy, svga_t *svga)
 
         if (video_force_resize_get_monitor(svga->monitor_index))
             video_force_resize_set_monitor(0, svga->monitor_index);
+
+        svga->damage_full = 1;
     }
 
     if ((wx >= 160) && ((wy + 1) >= 120)) {
@@ -2040,12 +2134,40 @@ svga_doblit(int wx, int wy, svga_t *svga)
         }
     }
 
-    video_blit_memtoscreen_monitor(x_start, y_start, svga->monitor->mon_xsize + x_add, svga->monitor->mon_ysize + y_add, svga->monitor_index);
+    /* The overscan is redrawn every line, and not tracked. */
+    if ((svga->dpms != svga->damage_dpms) || (svga->y_add != svga->damage_y_add) ||
+        (svga->scrollcache != svga->damage_scrollcache) || (svga->overscan_color != svga->damage_overscan_color)) {
+        svga->damage_dpms           = svga->dpms;
+        svga->damage_y_add          = svga->y_add;
+        svga->damage_scrollcache    = svga->scrollcache;
+        svga->damage_overscan_color = svga->overscan_color;
+        svga->damage_full           = 1;
+    }
+
+    if (damage && !svga->damage_full) {
+        for (i = 0; i < svga->damage_num; i++) {
+            svga->damage[i].x = x_start;
+            svga->damage[i].w = svga->monitor->mon_xsize + x_add;
+        }
+        video_blit_memtoscreen_damage_monitor(x_start, y_start, svga->monitor->mon_xsize + x_add, svga->monitor->mon_ysize + y_add,
+                                              svga->damage, svga->damage_num, svga->monitor_index);
+    } else
+        video_blit_memtoscreen_monitor(x_start, y_start, svga->monitor->mon_xsize + x_add, svga->monitor->mon_ysize + y_add, svga->monitor_index);
+
+    /* Other callers draw the screen themselves, so the next frame from
+       svga_poll() has to go out whole. */
+    svga->damage_full = !damage;
 
     if (svga->vertical_linedbl)
         svga->vertical_linedbl >>= 1;
 }
 
+void
+svga_doblit(int wx, int wy, svga_t *svga)
+{
+    svga_doblit_common(wx, wy, svga, 0);
+}
+
 void
 svga_writeb_linear(uint32_t addr, uint8_t val, void *priv)
 {
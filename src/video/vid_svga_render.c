@@ -670,6 +670,19 @@ svga_render_2bpp_headland_highres(svga_t *svga)
     }
 }
 
+/* Return the next bytes of the current line in VRAM for the line converters,
+   or NULL if they wrap around the display mask. */
+static __inline const uint8_t *
+svga_render_span(svga_t *svga, uint32_t bytes)
+{
+    uint32_t addr = svga->ma & svga->vram_display_mask;
+
+    if ((addr + bytes) > (svga->vram_display_mask + 1))
+        return NULL;
+
+    return &svga->vram[addr];
+}
+
 static void
 svga_render_indexed_gfx(svga_t *svga, bool highres, bool combine8bits)
 {
@@ -748,6 +761,22 @@ svga_render_indexed_gfx(svga_t *svga, bool highres, bool combine8bits)
         svga->firstline_draw = svga->displine;
     svga->lastline_draw = svga->displine;
 
+    /* Linear 8bpp, one byte per pixel in address order. */
+    if (highres8bpp && !svga->force_old_addr && !svga->remap_required && !svga->packed_4bpp &&
+        !svga->ati_4color && (incbypow2 == 0) && (incevery == 1) && (loadevery == 1) &&
+        (planemask == 0xffffffff) && !blinkmask) {
+        const int      n   = ((svga->hdisp + svga->scrollcache) / 4 + 1) * 4;
+        const uint8_t *src = svga_render_span(svga, n);
+
+        if (src != NULL) {
+            for (x = 0; x < n; x++)
+                p[x] = svga->map8[src[x] & svga->dac_mask];
+
+            svga->ma = (svga->ma + n) & svga->vram_display_mask;
+            return;
+        }
+    }
+
     uint32_t incr_counter = 0;
     uint32_t load_counter = 0;
     uint32_t edat         = 0;
@@ -1375,7 +1404,13 @@ svga_render_15bpp_highres(svga_t *svga)
                 svga->firstline_draw = svga->displine;
             svga->lastline_draw = svga->displine;
 
-            if (!svga->remap_required) {
+            const int      n   = ((svga->hdisp + svga->scrollcache) / 8 + 1) * 8;
+            const uint8_t *src = svga_render_span(svga, n << 1);
+
+            if (!svga->remap_required && (svga->conv_16to32 == svga_conv_16to32) && (src != NULL)) {
+                svga_conv_line_15to32(p, src, n);
+                svga->ma += n << 1;
+            } else if (!svga->remap_required) {
                 for (x = 0; x <= (svga->hdisp + svga->scrollcache); x += 8) {
                     dat  = *(uint32_t *) (&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
                     *p++ = svga->conv_16to32(svga, dat & 0xffff, 15);
@@ -1607,7 +1642,13 @@ svga_render_16bpp_highres(svga_t *svga)
                 svga->firstline_draw = svga->displine;
             svga->lastline_draw = svga->displine;
 
-            if (!svga->remap_required) {
+            const int      n   = ((svga->hdisp + svga->scrollcache) / 8 + 1) * 8;
+            const uint8_t *src = svga_render_span(svga, n << 1);
+
+            if (!svga->remap_required && (svga->conv_16to32 == svga_conv_16to32) && (src != NULL)) {
+                svga_conv_line_16to32(p, src, n);
+                svga->ma += n << 1;
+            } else if (!svga->remap_required) {
                 for (x = 0; x <= (svga->hdisp + svga->scrollcache); x += 8) {
                     dat  = *(uint32_t *) (&svga->vram[(svga->ma + (x << 1)) & svga->vram_display_mask]);
                     *p++ = svga->conv_16to32(svga, dat & 0xffff, 16);
@@ -1768,7 +1809,13 @@ svga_render_24bpp_highres(svga_t *svga)
                 svga->firstline_draw = svga->displine;
             svga->lastline_draw = svga->displine;
 
-            if (!svga->remap_required) {
+            const int      n   = ((svga->hdisp + svga->scrollcache) / 4 + 1) * 4;
+            const uint8_t *src = svga_render_span(svga, n * 3);
+
+            if (!svga->remap_required && !svga->lut_map && (src != NULL)) {
+                svga_conv_line_24to32(p, src, n);
+                svga->ma += n * 3;
+            } else if (!svga->remap_required) {
                 for (x = 0; x <= (svga->hdisp + svga->scrollcache); x += 4) {
                     dat0 = *(uint32_t *) (&svga->vram[svga->ma & svga->vram_display_mask]);
                     dat1 = *(uint32_t *) (&svga->vram[(svga->ma + 4) & svga->vram_display_mask]);
@@ -1896,7 +1943,13 @@ svga_render_32bpp_highres(svga_t *svga)
                 svga->firstline_draw = svga->displine;
             svga->lastline_draw = svga->displine;
 
-            if (!svga->remap_required) {
+            const int      n   = svga->hdisp + svga->scrollcache + 1;
+            const uint8_t *src = svga_render_span(svga, n << 2);
+
+            if (!svga->remap_required && !svga->lut_map && (src != NULL)) {
+                svga_conv_line_32to32(p, src, n);
+                svga->ma += n << 2;
+            } else if (!svga->remap_required) {
                 for (x = 0; x <= (svga->hdisp + svga->scrollcache); x++) {
                     dat  = *(uint32_t *) (&svga->vram[(svga->ma + (x << 2)) & svga->vram_display_mask]);
                     *p++ = lookup_lut(dat & 0xffffff);
@@ -0,0 +1,399 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          SVGA scanline converters, with SSE2, AVX2 and NEON versions.
+ *
+ *
+ *
+ * Authors: The 86Box development team
+ *
+ *          Copyright 2026 The 86Box development team
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+#include <86box/86box.h>
+#include <86box/device.h>
+#include <86box/mem.h>
+#include <86box/timer.h>
+#include <86box/video.h>
+#include <86box/vid_svga.h>
+#include <86box/vid_svga_render.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#    define SVGA_SIMD_X86
+#    include <immintrin.h>
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#        define SVGA_TARGET(t)
+#    else
+#        define SVGA_TARGET(t) __attribute__((target(t)))
+#    endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    define SVGA_SIMD_NEON
+#    include <arm_neon.h>
+#endif
+
+/*
+   The 5 and 6-bit channels are widened the way video_15to32[] and
+   video_16to32[] do, (c * 255) / 31 and (c * 255) / 63, which is exactly
+   the high half of the product of the channel, masked in place at the bit
+   positions below, with these constants.
+ */
+#define CONV_B5_SHIFT 4 /* b << 4, in bits 4-8 */
+#define CONV_B5_MUL   33693
+#define CONV_G5_MUL   16847 /* 15bpp g, in bits 5-9 */
+#define CONV_G6_MUL   8290  /* 16bpp g, in bits 5-10 */
+#define CONV_R5_MUL   1053  /* r, moved to bits 9-13 */
+
+const char *svga_conv_line_name = "scalar";
+
+/* Scalar versions, also used for the tails of the SIMD ones. */
+static void
+conv_line_15to32_c(uint32_t *dst, const uint8_t *src, int n)
+{
+    const uint16_t *s = (const uint16_t *) src;
+
+    for (int i = 0; i < n; i++)
+        dst[i] = video_15to32[s[i]];
+}
+
+static void
+conv_line_16to32_c(uint32_t *dst, const uint8_t *src, int n)
+{
+    const uint16_t *s = (const uint16_t *) src;
+
+    for (int i = 0; i < n; i++)
+        dst[i] = video_16to32[s[i]];
+}
+
+static void
+conv_line_24to32_c(uint32_t *dst, const uint8_t *src, int n)
+{
+    for (int i = 0; i < n; i++, src += 3)
+        dst[i] = src[0] | (src[1] << 8) | (src[2] << 16);
+}
+
+static void
+conv_line_32to32_c(uint32_t *dst, const uint8_t *src, int n)
+{
+    const uint32_t *s = (const uint32_t *) src;
+
+    for (int i = 0; i < n; i++)
+        dst[i] = s[i] & 0xffffff;
+}
+
+void (*svga_conv_line_15to32)(uint32_t *dst, const uint8_t *src, int n) = conv_line_15to32_c;
+void (*svga_conv_line_16to32)(uint32_t *dst, const uint8_t *src, int n) = conv_line_16to32_c;
+void (*svga_conv_line_24to32)(uint32_t *dst, const uint8_t *src, int n) = conv_line_24to32_c;
+void (*svga_conv_line_32to32)(uint32_t *dst, const uint8_t *src, int n) = conv_line_32to32_c;
+
+#ifdef SVGA_SIMD_X86
+SVGA_TARGET("sse2")
+static __inline void
+conv_16to32_sse2(uint32_t *dst, __m128i c, int bpp)
+{
+    __m128i b = _mm_mulhi_epu16(_mm_and_si128(_mm_slli_epi16(c, CONV_B5_SHIFT), _mm_set1_epi16(0x1f0)),
+                                _mm_set1_epi16((short) CONV_B5_MUL));
+    __m128i g;
+    __m128i r;
+    __m128i bg;
+
+    if (bpp == 15) {
+        g = _mm_mulhi_epu16(_mm_and_si128(c, _mm_set1_epi16(0x3e0)), _mm_set1_epi16(CONV_G5_MUL));
+        r = _mm_srli_epi16(c, 1);
+    } else {
+        g = _mm_mulhi_epu16(_mm_and_si128(c, _mm_set1_epi16(0x7e0)), _mm_set1_epi16(CONV_G6_MUL));
+        r = _mm_srli_epi16(c, 2);
+    }
+    r = _mm_mulhi_epu16(_mm_and_si128(r, _mm_set1_epi16(0x3e00)), _mm_set1_epi16(CONV_R5_MUL));
+
+    /* Blue and green in one word, and red in the one that follows it. */
+    bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+    _mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi16(bg, r));
+    _mm_storeu_si128((__m128i *) &dst[4], _mm_unpackhi_epi16(bg, r));
+}
+
+SVGA_TARGET("sse2")
+static void
+conv_line_15to32_sse2(uint32_t *dst, const uint8_t *src, int n)
+{
+    int i = 0;
+
+    for (; (i + 8) <= n; i += 8)
+        conv_16to32_sse2(&dst[i], _mm_loadu_si128((const __m128i *) (src + (i << 1))), 15);
+
+    conv_line_15to32_c(&dst[i], src + (i << 1), n - i);
+}
+
+SVGA_TARGET("sse2")
+static void
+conv_line_16to32_sse2(uint32_t *dst, const uint8_t *src, int n)
+{
+    int i = 0;
+
+    for (; (i + 8) <= n; i += 8)
+        conv_16to32_sse2(&dst[i], _mm_loadu_si128((const __m128i *) (src + (i << 1))), 16);
+
+    conv_line_16to32_c(&dst[i], src + (i << 1), n - i);
+}
+
+SVGA_TARGET("sse2")
+static void
+conv_line_32to32_sse2(uint32_t *dst, const uint8_t *src, int n)
+{
+    const __m128i mask = _mm_set1_epi32(0xffffff);
+    int           i    = 0;
+
+    for (; (i + 4) <= n; i += 4)
+        _mm_storeu_si128((__m128i *) &dst[i],
+                         _mm_and_si128(_mm_loadu_si128((const __m128i *) (src + (i << 2))), mask));
+
+    conv_line_32to32_c(&dst[i], src + (i << 2), n - i);
+}
+
+SVGA_TARGET("avx2")
+static __inline __m256i
+conv_16to32_avx2(__m256i c, int bpp, __m256i *r)
+{
+    __m256i b = _mm256_mulhi_epu16(_mm256_and_si256(_mm256_slli_epi16(c, CONV_B5_SHIFT), _mm256_set1_epi16(0x1f0)),
+                                   _mm256_set1_epi16((short) CONV_B5_MUL));
+    __m256i g;
+
+    if (bpp == 15) {
+        g  = _mm256_mulhi_epu16(_mm256_and_si256(c, _mm256_set1_epi16(0x3e0)), _mm256_set1_epi16(CONV_G5_MUL));
+        *r = _mm256_srli_epi16(c, 1);
+    } else {
+        g  = _mm256_mulhi_epu16(_mm256_and_si256(c, _mm256_set1_epi16(0x7e0)), _mm256_set1_epi16(CONV_G6_MUL));
+        *r = _mm256_srli_epi16(c, 2);
+    }
+    *r = _mm256_mulhi_epu16(_mm256_and_si256(*r, _mm256_set1_epi16(0x3e00)), _mm256_set1_epi16(CONV_R5_MUL));
+
+    return _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+}
+
+/* The unpacks work within each 128-bit lane, so put the pixels back in order
+   on the way out. */
+SVGA_TARGET("avx2")
+static __inline void
+conv_store_avx2(uint32_t *dst, __m256i bg, __m256i r)
+{
+    __m256i lo = _mm256_unpacklo_epi16(bg, r);
+    __m256i hi = _mm256_unpackhi_epi16(bg, r);
+
+    _mm256_storeu_si256((__m256i *) dst, _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i *) &dst[8], _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+SVGA_TARGET("avx2")
+static void
+conv_line_15to32_avx2(uint32_t *dst, const uint8_t *src, int n)
+{
+    int i = 0;
+
+    for (; (i + 16) <= n; i += 16) {
+        __m256i r;
+        __m256i bg = conv_16to32_avx2(_mm256_loadu_si256((const __m256i *) (src + (i << 1))), 15, &r);
+
+        conv_store_avx2(&dst[i], bg, r);
+    }
+
+    conv_line_15to32_sse2(&dst[i], src + (i << 1), n - i);
+}
+
+SVGA_TARGET("avx2")
+static void
+conv_line_16to32_avx2(uint32_t *dst, const uint8_t *src, int n)
+{
+    int i = 0;
+
+    for (; (i + 16) <= n; i += 16) {
+        __m256i r;
+        __m256i bg = conv_16to32_avx2(_mm256_loadu_si256((const __m256i *) (src + (i << 1))), 16, &r);
+
+        conv_store_avx2(&dst[i], bg, r);
+    }
+
+    conv_line_16to32_sse2(&dst[i], src + (i << 1), n - i);
+}
+
+/* Each lane takes 4 pixels from its own 16-byte load, 12 bytes apart, so 4
+   bytes past the last pixel are read; the loop stops early enough for those
+   to still be part of the line. */
+SVGA_TARGET("avx2")
+static void
+conv_line_24to32_avx2(uint32_t *dst, const uint8_t *src, int n)
+{
+    const __m256i shuf = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                          0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    int           i    = 0;
+
+    for (; (i + 10) <= n; i += 8) {
+        __m256i c = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) (src + (i * 3)))),
+                                            _mm_loadu_si128((const __m128i *) (src + (i * 3) + 12)), 1);
+
+        _mm256_storeu_si256((__m256i *) &dst[i], _mm256_shuffle_epi8(c, shuf));
+    }
+
+    conv_line_24to32_c(&dst[i], src + (i * 3), n - i);
+}
+
+SVGA_TARGET("avx2")
+static void
+conv_line_32to32_avx2(uint32_t *dst, const uint8_t *src, int n)
+{
+    const __m256i mask = _mm256_set1_epi32(0xffffff);
+    int           i    = 0;
+
+    for (; (i + 8) <= n; i += 8)
+        _mm256_storeu_si256((__m256i *) &dst[i],
+                            _mm256_and_si256(_mm256_loadu_si256((const __m256i *) (src + (i << 2))), mask));
+
+    conv_line_32to32_sse2(&dst[i], src + (i << 2), n - i);
+}
+
+static int
+svga_cpu_has(int avx2)
+{
+#    ifdef _MSC_VER
+    int regs[4];
+    int max;
+
+    __cpuid(regs, 0);
+    max = regs[0];
+    __cpuid(regs, 1);
+    if (!avx2)
+        return !!(regs[3] & (1 << 26));
+    if (max < 7)
+        return 0;
+    /* AVX and OSXSAVE, with the OS saving the YMM state. */
+    if ((regs[2] & 0x18000000) != 0x18000000)
+        return 0;
+    if ((_xgetbv(0) & 6) != 6)
+        return 0;
+    __cpuidex(regs, 7, 0);
+    return !!(regs[1] & (1 << 5));
+#    else
+    __builtin_cpu_init();
+    return avx2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("sse2");
+#    endif
+}
+#endif
+
+#ifdef SVGA_SIMD_NEON
+static __inline uint16x8_t
+conv_mulhi_neon(uint16x8_t a, uint16_t k)
+{
+    uint32x4_t lo = vmull_n_u16(vget_low_u16(a), k);
+    uint32x4_t hi = vmull_n_u16(vget_high_u16(a), k);
+
+    return vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+}
+
+static __inline void
+conv_16to32_neon(uint32_t *dst, uint16x8_t c, int bpp)
+{
+    uint16x8_t b = conv_mulhi_neon(vandq_u16(vshlq_n_u16(c, CONV_B5_SHIFT), vdupq_n_u16(0x1f0)), CONV_B5_MUL);
+    uint16x8_t g;
+    uint16x8_t r;
+
+    if (bpp == 15) {
+        g = conv_mulhi_neon(vandq_u16(c, vdupq_n_u16(0x3e0)), CONV_G5_MUL);
+        r = vshrq_n_u16(c, 1);
+    } else {
+        g = conv_mulhi_neon(vandq_u16(c, vdupq_n_u16(0x7e0)), CONV_G6_MUL);
+        r = vshrq_n_u16(c, 2);
+    }
+    r = conv_mulhi_neon(vandq_u16(r, vdupq_n_u16(0x3e00)), CONV_R5_MUL);
+
+    uint16x8x2_t out = vzipq_u16(vorrq_u16(b, vshlq_n_u16(g, 8)), r);
+    vst1q_u16((uint16_t *) dst, out.val[0]);
+    vst1q_u16((uint16_t *) &dst[4], out.val[1]);
+}
+
+static void
+conv_line_15to32_neon(uint32_t *dst, const uint8_t *src, int n)
+{
+    int i = 0;
+
+    for (; (i + 8) <= n; i += 8)
+        conv_16to32_neon(&dst[i], vld1q_u16((const uint16_t *) (src + (i << 1))), 15);
+
+    conv_line_15to32_c(&dst[i], src + (i << 1), n - i);
+}
+
+static void
+conv_line_16to32_neon(uint32_t *dst, const uint8_t *src, int n)
+{
+    int i = 0;
+
+    for (; (i + 8) <= n; i += 8)
+        conv_16to32_neon(&dst[i], vld1q_u16((const uint16_t *) (src + (i << 1))), 16);
+
+    conv_line_16to32_c(&dst[i], src + (i << 1), n - i);
+}
+
+static void
+conv_line_24to32_neon(uint32_t *dst, const uint8_t *src, int n)
+{
+    int i = 0;
+
+    for (; (i + 8) <= n; i += 8) {
+        uint8x8x3_t c = vld3_u8(src + (i * 3));
+        uint8x8x4_t out;
+
+        out.val[0] = c.val[0];
+        out.val[1] = c.val[1];
+        out.val[2] = c.val[2];
+        out.val[3] = vdup_n_u8(0);
+        vst4_u8((uint8_t *) &dst[i], out);
+    }
+
+    conv_line_24to32_c(&dst[i], src + (i * 3), n - i);
+}
+
+static void
+conv_line_32to32_neon(uint32_t *dst, const uint8_t *src, int n)
+{
+    const uint32x4_t mask = vdupq_n_u32(0xffffff);
+    int              i    = 0;
+
+    for (; (i + 4) <= n; i += 4)
+        vst1q_u32(&dst[i], vandq_u32(vld1q_u32((const uint32_t *) (src + (i << 2))), mask));
+
+    conv_line_32to32_c(&dst[i], src + (i << 2), n - i);
+}
+#endif
+
+/* Pick the converters for the host CPU. */
+void
+svga_render_simd_init(void)
+{
+#ifdef SVGA_SIMD_X86
+    if (svga_cpu_has(1)) {
+        svga_conv_line_15to32 = conv_line_15to32_avx2;
+        svga_conv_line_16to32 = conv_line_16to32_avx2;
+        svga_conv_line_24to32 = conv_line_24to32_avx2;
+        svga_conv_line_32to32 = conv_line_32to32_avx2;
+        svga_conv_line_name   = "AVX2";
+    } else if (svga_cpu_has(0)) {
+        svga_conv_line_15to32 = conv_line_15to32_sse2;
+        svga_conv_line_16to32 = conv_line_16to32_sse2;
+        svga_conv_line_32to32 = conv_line_32to32_sse2;
+        svga_conv_line_name   = "SSE2";
+    }
+#elif defined(SVGA_SIMD_NEON)
+    svga_conv_line_15to32 = conv_line_15to32_neon;
+    svga_conv_line_16to32 = conv_line_16to32_neon;
+    svga_conv_line_24to32 = conv_line_24to32_neon;
+    svga_conv_line_32to32 = conv_line_32to32_neon;
+    svga_conv_line_name   = "NEON";
+#endif
+}
@@ -27,6 +27,7 @@
 #include <86box/rom.h>
 #include <86box/device.h>
 #include <86box/timer.h>
+#include <86box/savestate.h>
 #include <86box/video.h>
 #include <86box/vid_svga.h>
 #include <86box/vid_vga.h>
@@ -191,6 +192,14 @@ vga_available(void)
     return rom_present("roms/video/vga/ibm_vga.bin");
 }
 
+static void
+vga_state(void *priv, savestate_t *state)
+{
+    vga_t *vga = (vga_t *) priv;
+
+    svga_state(&vga->svga, state);
+}
+
 void
 vga_close(void *priv)
 {
@@ -228,7 +237,9 @@ const device_t vga_device = {
     .available     = vga_available,
     .speed_changed = vga_speed_changed,
     .force_redraw  = vga_force_redraw,
-    .config        = NULL
+    .config        = NULL,
+    .save          = vga_state,
+    .load          = vga_state
 };
 
 const device_t ps1vga_device = {
@@ -242,7 +253,9 @@ const device_t ps1vga_device = {
     .available     = NULL,
     .speed_changed = vga_speed_changed,
     .force_redraw  = vga_force_redraw,
-    .config        = NULL
+    .config        = NULL,
+    .save          = vga_state,
+    .load          = vga_state
 };
 
 const device_t ps1vga_mca_device = {
@@ -256,5 +269,7 @@ const device_t ps1vga_mca_device = {
     .available     = NULL,
     .speed_changed = vga_speed_changed,
     .force_redraw  = vga_force_redraw,
-    .config        = NULL
+    .config        = NULL,
+    .save          = vga_state,
+    .load          = vga_state
 };
@@ -1105,7 +1105,7 @@ banshee_status(banshee_t *banshee)
     int           fifo_entries = FIFO_ENTRIES;
     int           swap_count   = voodoo->swap_count;
     int           written      = voodoo->cmd_written + voodoo->cmd_written_fifo;
-    int           busy         = (written - voodoo->cmd_read) || (voodoo->cmdfifo_depth_rd != voodoo->cmdfifo_depth_wr) || (voodoo->cmdfifo_depth_rd_2 != voodoo->cmdfifo_depth_wr_2) || voodoo->render_voodoo_busy[0] || voodoo->render_voodoo_busy[1] || voodoo->render_voodoo_busy[2] || voodoo->render_voodoo_busy[3] || voodoo->voodoo_busy;
+    int           busy         = (written - voodoo->cmd_read) || (voodoo->cmdfifo_depth_rd != voodoo->cmdfifo_depth_wr) || (voodoo->cmdfifo_depth_rd_2 != voodoo->cmdfifo_depth_wr_2) || voodoo_render_threads_busy(voodoo) || voodoo->voodoo_busy;
     uint32_t      ret          = 0;
 
     if (fifo_entries < 0x20)
@@ -3714,6 +3714,23 @@ static const device_config_t banshee_sgram_config[] = {
         .selection      = { { 0 } },
         .bios           = { { 0 } }
     },
+    {
+        .name           = "texture_cache",
+        .description    = "Texture cache size",
+        .type           = CONFIG_SELECTION,
+        .default_string = NULL,
+        .default_int    = 64,
+        .file_filter    = NULL,
+        .spinner        = { 0 },
+        .selection      = {
+            { .description = "32 MB",  .value = 32  },
+            { .description = "64 MB",  .value = 64  },
+            { .description = "128 MB", .value = 128 },
+            { .description = "256 MB", .value = 256 },
+            { .description = ""                     }
+        },
+        .bios           = { { 0 } }
+    },
     {
         .name           = "render_threads",
         .description    = "Render threads",
@@ -3723,10 +3740,13 @@ static const device_config_t banshee_sgram_config[] = {
         .file_filter    = NULL,
         .spinner        = { 0 },
         .selection      = {
-            { .description = "1", .value = 1 },
-            { .description = "2", .value = 2 },
-            { .description = "4", .value = 4 },
-            { .description = ""              }
+            { .description = "Auto", .value = 0  },
+            { .description = "1",    .value = 1  },
+            { .description = "2",    .value = 2  },
+            { .description = "4",    .value = 4  },
+            { .description = "8",    .value = 8  },
+            { .description = "16",   .value = 16 },
+            { .description = ""                  }
         },
         .bios           = { { 0 } }
     },
@@ -3742,6 +3762,19 @@ static const device_config_t banshee_sgram_config[] = {
         .selection      = { { 0 } },
         .bios           = { { 0 } }
     },
+#if defined __amd64__ || defined _M_X64
+    {
+        .name           = "recompiler_avx2",
+        .description    = "Use AVX2 in the Recompiler",
+        .type           = CONFIG_BINARY,
+        .default_string = NULL,
+        .default_int    = 1,
+        .file_filter    = NULL,
+        .spinner        = { 0 },
+        .selection      = { { 0 } },
+        .bios           = { { 0 } }
+    },
+#endif
 #endif
     { .name = "", .description = "", .type = CONFIG_END }
 };
@@ -3780,6 +3813,23 @@ static const device_config_t banshee_sgram_16mbonly_config[] = {
         .selection      = { { 0 } },
         .bios           = { { 0 } }
     },
+    {
+        .name           = "texture_cache",
+        .description    = "Texture cache size",
+        .type           = CONFIG_SELECTION,
+        .default_string = NULL,
+        .default_int    = 64,
+        .file_filter    = NULL,
+        .spinner        = { 0 },
+        .selection      = {
+            { .description = "32 MB",  .value = 32  },
+            { .description = "64 MB",  .value = 64  },
+            { .description = "128 MB", .value = 128 },
+            { .description = "256 MB", .value = 256 },
+            { .description = ""                     }
+        },
+        .bios           = { { 0 } }
+    },
     {
         .name           = "render_threads",
         .description    = "Render threads",
@@ -3789,10 +3839,13 @@ static const device_config_t banshee_sgram_16mbonly_config[] = {
         .file_filter    = NULL,
         .spinner        = { 0 },
         .selection      = {
-            { .description = "1", .value = 1 },
-            { .description = "2", .value = 2 },
-            { .description = "4", .value = 4 },
-            { .description = ""              }
+            { .description = "Auto", .value = 0  },
+            { .description = "1",    .value = 1  },
+            { .description = "2",    .value = 2  },
+            { .description = "4",    .value = 4  },
+            { .description = "8",    .value = 8  },
+            { .description = "16",   .value = 16 },
+            { .description = ""                  }
         },
         .bios           = { { 0 } }
     },
@@ -3808,6 +3861,19 @@ static const device_config_t banshee_sgram_16mbonly_config[] = {
         .selection      = { { 0 } },
         .bios           = { { 0 } }
     },
+#if defined __amd64__ || defined _M_X64
+    {
+        .name           = "recompiler_avx2",
+        .description    = "Use AVX2 in the Recompiler",
+        .type           = CONFIG_BINARY,
+        .default_string = NULL,
+        .default_int    = 1,
+        .file_filter    = NULL,
+        .spinner        = { 0 },
+        .selection      = { { 0 } },
+        .bios           = { { 0 } }
+    },
+#endif
 #endif
     { .name = "", .description = "", .type = CONFIG_END }
 };
@@ -3846,6 +3912,23 @@ static const device_config_t banshee_sdram_config[] = {
         .selection      = { { 0 } },
         .bios           = { { 0 } }
     },
+    {
+        .name           = "texture_cache",
+        .description    = "Texture cache size",
+        .type           = CONFIG_SELECTION,
+        .default_string = NULL,
+        .default_int    = 64,
+        .file_filter    = NULL,
+        .spinner        = { 0 },
+        .selection      = {
+            { .description = "32 MB",  .value = 32  },
+            { .description = "64 MB",  .value = 64  },
+            { .description = "128 MB", .value = 128 },
+            { .description = "256 MB", .value = 256 },
+            { .description = ""                     }
+        },
+        .bios           = { { 0 } }
+    },
     {
         .name           = "render_threads",
         .description    = "Render threads",
@@ -3855,10 +3938,13 @@ static const device_config_t banshee_sdram_config[] = {
         .file_filter    = NULL,
         .spinner        = { 0 },
         .selection      = {
-            { .description = "1", .value = 1 },
-            { .description = "2", .value = 2 },
-            { .description = "4", .value = 4 },
-            { .description = ""              }
+            { .description = "Auto", .value = 0  },
+            { .description = "1",    .value = 1  },
+            { .description = "2",    .value = 2  },
+            { .description = "4",    .value = 4  },
+            { .description = "8",    .value = 8  },
+            { .description = "16",   .value = 16 },
+            { .description = ""                  }
         },
         .bios           = { { 0 } }
     },
@@ -3874,6 +3960,19 @@ static const device_config_t banshee_sdram_config[] = {
         .selection      = { { 0 } },
         .bios           = { { 0 } }
     },
+#if defined __amd64__ || defined _M_X64
+    {
+        .name           = "recompiler_avx2",
+        .description    = "Use AVX2 in the Recompiler",
+        .type           = CONFIG_BINARY,
+        .default_string = NULL,
+        .default_int    = 1,
+        .file_filter    = NULL,
+        .spinner        = { 0 },
+        .selection      = { { 0 } },
+        .bios           = { { 0 } }
+    },
+#endif
 #endif
     { .name = "", .description = "", .type = CONFIG_END }
 };
@@ -17,6 +17,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stddef.h>
@@ -697,7 +698,7 @@ voodoo_half_triangle(voodoo_t *voodoo, voodoo_params_t *params, voodoo_state_t *
     uint8_t (*voodoo_draw)(voodoo_state_t * state, voodoo_params_t * params, int x, int real_y);
 #endif
     int y_diff   = SLI_ENABLED ? 2 : 1;
-    int y_origin = (voodoo->type >= VOODOO_BANSHEE) ? voodoo->y_origin_swap : (voodoo->v_disp - 1);
+    int y_origin = params->y_origin;
 
     if ((params->textureMode[0] & TEXTUREMODE_MASK) == TEXTUREMODE_PASSTHROUGH || (params->textureMode[0] & TEXTUREMODE_LOCAL_MASK) == TEXTUREMODE_LOCAL)
         texels = 1;
@@ -829,13 +830,8 @@ voodoo_half_triangle(voodoo_t *voodoo, voodoo_params_t *params, voodoo_state_t *
         else
             real_y >>= 4;
 
-        if (SLI_ENABLED) {
-            if (((real_y >> 1) & voodoo->odd_even_mask) != odd_even)
-                goto next_line;
-        } else {
-            if ((real_y & voodoo->odd_even_mask) != odd_even)
-                goto next_line;
-        }
+        if (voodoo_band_thread(voodoo, SLI_ENABLED ? (real_y >> 1) : real_y) != odd_even)
+            goto next_line;
 
         start_x = x;
 
@@ -1392,9 +1388,6 @@ next_line:
         state->xstart += state->dx1;
         state->xend += state->dx2;
     }
-
-    voodoo->texture_cache[0][params->tex_entry[0]].refcount_r[odd_even]++;
-    voodoo->texture_cache[1][params->tex_entry[1]].refcount_r[odd_even]++;
 }
 
 void
@@ -1414,8 +1407,6 @@ voodoo_triangle(voodoo_t *voodoo, voodoo_params_t *params, int odd_even)
 
     state.dx1 = state.dx2 = 0;
 
-    voodoo->tri_count++;
-
     dx = 8 - (params->vertexAx & 0xf);
     if ((params->vertexAx & 0xf) > 8)
         dx += 16;
@@ -1549,9 +1540,10 @@ voodoo_render_log("voodoo_triangle %i %i %i : vA %f, %f  vB %f, %f  vC %f, %f f
 }
 
 static void
-render_thread(void *param, int odd_even)
+render_thread(void *param)
 {
-    voodoo_t *voodoo = (voodoo_t *) param;
+    voodoo_t *voodoo   = ((voodoo_render_thread_params_t *) param)->voodoo;
+    int       odd_even = ((voodoo_render_thread_params_t *) param)->index;
 
     while (voodoo->render_thread_run[odd_even]) {
         thread_set_event(voodoo->render_not_full_event[odd_even]);
@@ -1564,7 +1556,13 @@ render_thread(void *param, int odd_even)
             uint64_t         end_time;
             voodoo_params_t *params = &voodoo->params_buffer[voodoo->params_read_idx[odd_even] & PARAM_MASK];
 
-            voodoo_triangle(voodoo, params, odd_even);
+            /*Every thread walks the whole buffer in order, but only renders
+              the triangles touching one of its bands*/
+            if (params->render_mask & (1 << odd_even))
+                voodoo_triangle(voodoo, params, odd_even);
+
+            voodoo->texture_cache[0][params->tex_entry[0]].refcount_r[odd_even]++;
+            voodoo->texture_cache[1][params->tex_entry[1]].refcount_r[odd_even]++;
 
             voodoo->params_read_idx[odd_even]++;
 
@@ -1580,24 +1578,84 @@ render_thread(void *param, int odd_even)
 }
 
 void
-voodoo_render_thread_1(void *param)
+voodoo_render_threads_init(voodoo_t *voodoo)
 {
-    render_thread(param, 0);
-}
-void
-voodoo_render_thread_2(void *param)
-{
-    render_thread(param, 1);
+    /*Auto uses one thread per host CPU*/
+    if (voodoo->render_threads <= 0)
+        voodoo->render_threads = plat_cpu_count();
+    voodoo->render_threads = MAX(1, MIN(voodoo->render_threads, VOODOO_RENDER_THREADS_MAX));
+
+    for (int c = 0; c < VOODOO_RENDER_THREADS_MAX; c++) {
+        voodoo->wake_render_thread[c]    = thread_create_event();
+        voodoo->render_not_full_event[c] = thread_create_event();
+    }
+
+    for (int c = 0; c < voodoo->render_threads; c++) {
+        voodoo->render_thread_params[c].voodoo = voodoo;
+        voodoo->render_thread_params[c].index  = c;
+        voodoo->render_thread_run[c]           = 1;
+        voodoo->render_thread[c]               = thread_create(render_thread, &voodoo->render_thread_params[c]);
+    }
 }
+
 void
-voodoo_render_thread_3(void *param)
+voodoo_render_threads_close(voodoo_t *voodoo)
 {
-    render_thread(param, 2);
+    for (int c = 0; c < voodoo->render_threads; c++) {
+        voodoo->render_thread_run[c] = 0;
+        thread_set_event(voodoo->wake_render_thread[c]);
+        thread_wait(voodoo->render_thread[c]);
+    }
+
+    for (int c = 0; c < VOODOO_RENDER_THREADS_MAX; c++) {
+        thread_destroy_event(voodoo->wake_render_thread[c]);
+        thread_destroy_event(voodoo->render_not_full_event[c]);
+    }
 }
-void
-voodoo_render_thread_4(void *param)
+
+/*Work out which render threads own a band of lines that the triangle covers.
+  Triangles spanning at least one band per thread go to all of them.*/
+static uint32_t
+voodoo_triangle_render_mask(voodoo_t *voodoo, voodoo_params_t *params)
 {
-    render_thread(param, 3);
+    int      ystart = params->vertexAy & 0xffff;
+    int      yend   = params->vertexCy & 0xffff;
+    int      band_start;
+    int      band_end;
+    uint32_t mask = 0;
+
+    if (voodoo->render_threads == 1)
+        return 1;
+
+    if (ystart & 0x8000)
+        ystart |= ~0xffff;
+    if (yend & 0x8000)
+        yend |= ~0xffff;
+    ystart = (ystart + 7) >> 4;
+    yend   = ((yend + 7) >> 4) - 1;
+    if (yend < ystart)
+        return 0;
+
+    if (params->fbzMode & (1 << 17)) {
+        int temp = params->y_origin - yend;
+
+        yend   = params->y_origin - ystart;
+        ystart = temp;
+    }
+    if (SLI_ENABLED) {
+        ystart >>= 1;
+        yend >>= 1;
+    }
+
+    band_start = ystart >> VOODOO_BAND_SHIFT;
+    band_end   = yend >> VOODOO_BAND_SHIFT;
+    if ((band_end - band_start) >= (voodoo->render_threads - 1))
+        return (1 << voodoo->render_threads) - 1;
+
+    for (int band = band_start; band <= band_end; band++)
+        mask |= 1 << voodoo_band_thread(voodoo, band * (1 << VOODOO_BAND_SHIFT));
+
+    return mask;
 }
 
 void
@@ -1605,22 +1663,12 @@ voodoo_queue_triangle(voodoo_t *voodoo, voodoo_params_t *params)
 {
     voodoo_params_t *params_new = &voodoo->params_buffer[voodoo->params_write_idx & PARAM_MASK];
 
-    while (PARAM_FULL(0) || (voodoo->render_threads >= 2 && PARAM_FULL(1)) || (voodoo->render_threads == 4 && (PARAM_FULL(2) || PARAM_FULL(3)))) {
-        thread_reset_event(voodoo->render_not_full_event[0]);
-        if (voodoo->render_threads >= 2)
-            thread_reset_event(voodoo->render_not_full_event[1]);
-        if (voodoo->render_threads == 4) {
-            thread_reset_event(voodoo->render_not_full_event[2]);
-            thread_reset_event(voodoo->render_not_full_event[3]);
+    for (int c = 0; c < voodoo->render_threads; c++) {
+        while (PARAM_FULL(c)) {
+            thread_reset_event(voodoo->render_not_full_event[c]);
+            if (PARAM_FULL(c))
+                thread_wait_event(voodoo->render_not_full_event[c], -1); /*Wait for room in ringbuffer*/
         }
-        if (PARAM_FULL(0))
-            thread_wait_event(voodoo->render_not_full_event[0], -1); /*Wait for room in ringbuffer*/
-        if (voodoo->render_threads >= 2 && PARAM_FULL(1))
-            thread_wait_event(voodoo->render_not_full_event[1], -1); /*Wait for room in ringbuffer*/
-        if (voodoo->render_threads == 4 && PARAM_FULL(2))
-            thread_wait_event(voodoo->render_not_full_event[2], -1); /*Wait for room in ringbuffer*/
-        if (voodoo->render_threads == 4 && PARAM_FULL(3))
-            thread_wait_event(voodoo->render_not_full_event[3], -1); /*Wait for room in ringbuffer*/
     }
 
     voodoo_use_texture(voodoo, params, 0);
@@ -1628,9 +1676,17 @@ voodoo_queue_triangle(voodoo_t *voodoo, voodoo_params_t *params)
         voodoo_use_texture(voodoo, params, 1);
 
     memcpy(params_new, params, sizeof(voodoo_params_t));
+    params_new->y_origin    = (voodoo->type >= VOODOO_BANSHEE) ? voodoo->y_origin_swap : (voodoo->v_disp - 1);
+    params_new->render_mask = voodoo_triangle_render_mask(voodoo, params_new);
 
     voodoo->params_write_idx++;
+    /* Counted here, as a triangle may be rasterized by any number of threads. */
+    voodoo->tri_count++;
 
-    if (PARAM_ENTRIES(0) < 4 || (voodoo->render_threads >= 2 && PARAM_ENTRIES(1) < 4) || (voodoo->render_threads == 4 && (PARAM_ENTRIES(2) < 4 || PARAM_ENTRIES(3) < 4)))
-        voodoo_wake_render_thread(voodoo);
+    for (int c = 0; c < voodoo->render_threads; c++) {
+        if (PARAM_ENTRIES(c) < 4) {
+            voodoo_wake_render_thread(voodoo);
+            break;
+        }
+    }
 }
@@ -17,6 +17,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stddef.h>
@@ -239,14 +240,171 @@ voodoo_recalc_tex3(voodoo_t *voodoo, int tmu)
 
 #define makergba(r, g, b, a) ((b) | ((g) << 8) | ((r) << 16) | ((a) << 24))
 
+/*Texture still referenced by a queued triangle one of the render threads
+  has yet to get to*/
+static int
+voodoo_texture_in_use(voodoo_t *voodoo, texture_t *texture)
+{
+    for (int c = 0; c < voodoo->render_threads; c++) {
+        if (texture->refcount != texture->refcount_r[c])
+            return 1;
+    }
+
+    return 0;
+}
+
+static __inline int
+voodoo_texture_hash(uint32_t base, uint32_t tLOD, uint32_t palette_checksum)
+{
+    uint32_t hash = (base >> 3) ^ (tLOD * 0x9e3779b1) ^ palette_checksum;
+
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+
+    return hash & (TEX_HASH_SIZE - 1);
+}
+
+static void
+voodoo_texture_unlink(voodoo_t *voodoo, int tmu, int entry)
+{
+    texture_t *texture = &voodoo->texture_cache[tmu][entry];
+    int       *prev    = &voodoo->texture_hash[tmu][voodoo_texture_hash(texture->base, texture->tLOD, texture->palette_checksum)];
+
+    while (*prev != -1) {
+        if (*prev == entry) {
+            *prev = texture->hash_next;
+            break;
+        }
+        prev = &voodoo->texture_cache[tmu][*prev].hash_next;
+    }
+}
+
+/*Get the pages of texture memory, first to last exclusive, that LOD range d
+  of the texture was decoded from. A range that wraps past the end of texture
+  memory is taken to run up to the end of it. Return 0 if the texture does not
+  use range d.*/
+static int
+voodoo_texture_pages(voodoo_t *voodoo, texture_t *texture, int d, uint32_t *first, uint32_t *last)
+{
+    uint32_t addr_start;
+    uint32_t addr_end;
+
+    if (texture->addr_end[d] == 0)
+        return 0;
+
+    addr_start = texture->addr_start[d] & voodoo->texture_mask & ~0x3ff;
+    addr_end   = ((texture->addr_end[d] & voodoo->texture_mask) + 0x3ff) & ~0x3ff;
+    if (addr_end < addr_start)
+        addr_end = voodoo->texture_mask + 1;
+
+    *first = addr_start >> TEX_DIRTY_SHIFT;
+    *last  = addr_end >> TEX_DIRTY_SHIFT;
+    return 1;
+}
+
+/*Add delta to the use count of every page of texture memory the texture was
+  decoded from*/
+static void
+voodoo_texture_mark_pages(voodoo_t *voodoo, int tmu, texture_t *texture, int delta)
+{
+    uint32_t first;
+    uint32_t last;
+
+    for (uint8_t d = 0; d < 4; d++) {
+        if (voodoo_texture_pages(voodoo, texture, d, &first, &last)) {
+            for (uint32_t page = first; page < last; page++)
+                voodoo->texture_present[tmu][page] += delta;
+        }
+    }
+}
+
+static int
+voodoo_texture_uses_page(voodoo_t *voodoo, texture_t *texture, uint32_t page)
+{
+    uint32_t first;
+    uint32_t last;
+
+    for (uint8_t d = 0; d < 4; d++) {
+        if (voodoo_texture_pages(voodoo, texture, d, &first, &last) && (page >= first) && (page < last))
+            return 1;
+    }
+
+    return 0;
+}
+
+static void
+voodoo_texture_invalidate(voodoo_t *voodoo, int tmu, int entry)
+{
+    texture_t *texture = &voodoo->texture_cache[tmu][entry];
+
+    voodoo_texture_unlink(voodoo, tmu, entry);
+    voodoo_texture_mark_pages(voodoo, tmu, texture, -1);
+    texture->base = -1;
+}
+
+/*Pick the entry to decode a new texture into: an invalid one if there is
+  one, otherwise the least recently used texture not waiting to be rendered.
+  Return -1 if all entries are in use.*/
+static int
+voodoo_texture_evict(voodoo_t *voodoo, int tmu)
+{
+    texture_t *cache = voodoo->texture_cache[tmu];
+    int        entry = -1;
+
+    for (int c = 0; c < voodoo->texture_cache_entries; c++) {
+        if (voodoo_texture_in_use(voodoo, &cache[c]))
+            continue;
+        if (cache[c].base == -1) {
+            entry = c;
+            break;
+        }
+        if ((entry == -1) || ((voodoo->texture_stamp - cache[c].last_used) > (voodoo->texture_stamp - cache[entry].last_used)))
+            entry = c;
+    }
+
+    if (entry != -1) {
+        if (cache[entry].base != -1)
+            voodoo_texture_invalidate(voodoo, tmu, entry);
+        if (cache[entry].data == NULL) {
+            cache[entry].data = malloc(TEX_CACHE_ENTRY_SIZE);
+            if (cache[entry].data == NULL)
+                fatal("Texture cache: out of memory\n");
+        }
+    }
+
+    return entry;
+}
+
+static void
+voodoo_texture_stats(voodoo_t *voodoo, int decode)
+{
+    if (voodoo->texture_frame != voodoo->frame_count) {
+        if (voodoo->texture_frame_hits || voodoo->texture_frame_decodes)
+            voodoo_texture_log("Texture cache: frame %i, %i hits, %i decodes\n", voodoo->texture_frame,
+                               voodoo->texture_frame_hits, voodoo->texture_frame_decodes);
+        voodoo->texture_frame         = voodoo->frame_count;
+        voodoo->texture_frame_hits    = 0;
+        voodoo->texture_frame_decodes = 0;
+    }
+
+    if (decode) {
+        voodoo->texture_decodes++;
+        voodoo->texture_frame_decodes++;
+    } else {
+        voodoo->texture_hits++;
+        voodoo->texture_frame_hits++;
+    }
+}
+
 void
 voodoo_use_texture(voodoo_t *voodoo, voodoo_params_t *params, int tmu)
 {
     int      c;
+    int      hash;
     int      lod_min;
     int      lod_max;
     uint32_t addr = 0;
-    uint32_t addr_end;
     uint32_t palette_checksum;
 
     lod_min = (params->tLOD[tmu] >> 2) & 15;
@@ -271,30 +429,24 @@ voodoo_use_texture(voodoo_t *voodoo, voodoo_params_t *params, int tmu)
     else
         addr = params->texBaseAddr[tmu];
 
+    voodoo->texture_stamp++;
+
     /*Try to find texture in cache*/
-    for (c = 0; c < TEX_CACHE_MAX; c++) {
+    hash = voodoo_texture_hash(addr, params->tLOD[tmu] & 0xf00fff, palette_checksum);
+    for (c = voodoo->texture_hash[tmu][hash]; c != -1; c = voodoo->texture_cache[tmu][c].hash_next) {
         if (voodoo->texture_cache[tmu][c].base == addr && voodoo->texture_cache[tmu][c].tLOD == (params->tLOD[tmu] & 0xf00fff) && voodoo->texture_cache[tmu][c].palette_checksum == palette_checksum) {
             params->tex_entry[tmu] = c;
             voodoo->texture_cache[tmu][c].refcount++;
+            voodoo->texture_cache[tmu][c].last_used = voodoo->texture_stamp;
+            voodoo_texture_stats(voodoo, 0);
             return;
         }
     }
 
-    /*Texture not found, search for unused texture*/
-    do {
-        for (c = 0; c < TEX_CACHE_MAX; c++) {
-            voodoo->texture_last_removed++;
-            voodoo->texture_last_removed &= (TEX_CACHE_MAX - 1);
-            if (voodoo->texture_cache[tmu][voodoo->texture_last_removed].refcount == voodoo->texture_cache[tmu][voodoo->texture_last_removed].refcount_r[0] && (voodoo->render_threads == 1 || voodoo->texture_cache[tmu][voodoo->texture_last_removed].refcount == voodoo->texture_cache[tmu][voodoo->texture_last_removed].refcount_r[1]))
-                break;
-        }
-        if (c == TEX_CACHE_MAX)
-            voodoo_wait_for_render_thread_idle(voodoo);
-    } while (c == TEX_CACHE_MAX);
-    if (c == TEX_CACHE_MAX)
-        fatal("Texture cache full!\n");
-
-    c = voodoo->texture_last_removed;
+    /*Texture not found, replace an unused texture*/
+    while ((c = voodoo_texture_evict(voodoo, tmu)) == -1)
+        voodoo_wait_for_render_thread_idle(voodoo);
+    voodoo_texture_stats(voodoo, 1);
 
     if ((voodoo->params.tLOD[tmu] & LOD_SPLIT) && (voodoo->params.tLOD[tmu] & LOD_ODD) && (voodoo->params.tLOD[tmu] & LOD_TMULTIBASEADDR))
         voodoo->texture_cache[tmu][c].base = params->texBaseAddr1[tmu];
@@ -536,15 +688,11 @@ voodoo_use_texture(voodoo_t *voodoo, voodoo_params_t *params, int tmu)
     } else
         voodoo->texture_cache[tmu][c].addr_start[3] = voodoo->texture_cache[tmu][c].addr_end[3] = 0;
 
-    for (uint8_t d = 0; d < 4; d++) {
-        addr     = voodoo->texture_cache[tmu][c].addr_start[d];
-        addr_end = voodoo->texture_cache[tmu][c].addr_end[d];
+    voodoo_texture_mark_pages(voodoo, tmu, &voodoo->texture_cache[tmu][c], 1);
 
-        if (addr_end != 0) {
-            for (; addr <= addr_end; addr += (1 << TEX_DIRTY_SHIFT))
-                voodoo->texture_present[tmu][(addr & voodoo->texture_mask) >> TEX_DIRTY_SHIFT] = 1;
-        }
-    }
+    voodoo->texture_cache[tmu][c].last_used = voodoo->texture_stamp;
+    voodoo->texture_cache[tmu][c].hash_next = voodoo->texture_hash[tmu][hash];
+    voodoo->texture_hash[tmu][hash]         = c;
 
     params->tex_entry[tmu] = c;
     voodoo->texture_cache[tmu][c].refcount++;
@@ -553,45 +701,55 @@ voodoo_use_texture(voodoo_t *voodoo, voodoo_params_t *params, int tmu)
 void
 flush_texture_cache(voodoo_t *voodoo, uint32_t dirty_addr, int tmu)
 {
-    int wait_for_idle = 0;
+    uint32_t page          = dirty_addr >> TEX_DIRTY_SHIFT;
+    int      wait_for_idle = 0;
 
-    memset(voodoo->texture_present[tmu], 0, sizeof(voodoo->texture_present[0]));
 #if 0
-    voodoo_texture_log("Evict %08x %i\n", dirty_addr, sizeof(voodoo->texture_present));
+    voodoo_texture_log("Evict %08x\n", dirty_addr);
 #endif
-    for (uint8_t c = 0; c < TEX_CACHE_MAX; c++) {
-        if (voodoo->texture_cache[tmu][c].base != -1) {
-            for (uint8_t d = 0; d < 4; d++) {
-                int addr_start = voodoo->texture_cache[tmu][c].addr_start[d];
-                int addr_end   = voodoo->texture_cache[tmu][c].addr_end[d];
-
-                if (addr_end != 0) {
-                    int addr_start_masked = addr_start & voodoo->texture_mask & ~0x3ff;
-                    int addr_end_masked   = ((addr_end & voodoo->texture_mask) + 0x3ff) & ~0x3ff;
-
-                    if (addr_end_masked < addr_start_masked)
-                        addr_end_masked = voodoo->texture_mask + 1;
-                    if (dirty_addr >= addr_start_masked && dirty_addr < addr_end_masked) {
+    for (int c = 0; c < voodoo->texture_cache_entries; c++) {
+        if (voodoo->texture_cache[tmu][c].base != -1 && voodoo_texture_uses_page(voodoo, &voodoo->texture_cache[tmu][c], page)) {
 #if 0
-                        voodoo_texture_log("  Evict texture %i %08x\n", c, voodoo->texture_cache[tmu][c].base);
+            voodoo_texture_log("  Evict texture %i %08x\n", c, voodoo->texture_cache[tmu][c].base);
 #endif
 
-                        if (voodoo->texture_cache[tmu][c].refcount != voodoo->texture_cache[tmu][c].refcount_r[0] || (voodoo->render_threads == 2 && voodoo->texture_cache[tmu][c].refcount != voodoo->texture_cache[tmu][c].refcount_r[1]))
-                            wait_for_idle = 1;
+            if (voodoo_texture_in_use(voodoo, &voodoo->texture_cache[tmu][c]))
+                wait_for_idle = 1;
 
-                        voodoo->texture_cache[tmu][c].base = -1;
-                    } else {
-                        for (; addr_start <= addr_end; addr_start += (1 << TEX_DIRTY_SHIFT))
-                            voodoo->texture_present[tmu][(addr_start & voodoo->texture_mask) >> TEX_DIRTY_SHIFT] = 1;
-                    }
-                }
-            }
+            voodoo_texture_invalidate(voodoo, tmu, c);
         }
     }
     if (wait_for_idle)
         voodoo_wait_for_render_thread_idle(voodoo);
 }
 
+void
+voodoo_texture_cache_init(voodoo_t *voodoo, int size)
+{
+    voodoo->texture_cache_entries = MAX(1, (int) (((uint64_t) size << 20) / TEX_CACHE_ENTRY_SIZE));
+
+    for (uint8_t tmu = 0; tmu < 2; tmu++) {
+        voodoo->texture_cache[tmu] = calloc(voodoo->texture_cache_entries, sizeof(texture_t));
+        for (int c = 0; c < voodoo->texture_cache_entries; c++)
+            voodoo->texture_cache[tmu][c].base = -1; /*invalid*/
+        for (int c = 0; c < TEX_HASH_SIZE; c++)
+            voodoo->texture_hash[tmu][c] = -1;
+    }
+}
+
+void
+voodoo_texture_cache_close(voodoo_t *voodoo)
+{
+    if (voodoo->texture_hits || voodoo->texture_decodes)
+        voodoo_texture_log("Voodoo texture cache: %" PRIu64 " hits, %" PRIu64 " decodes\n", voodoo->texture_hits, voodoo->texture_decodes);
+
+    for (uint8_t tmu = 0; tmu < 2; tmu++) {
+        for (int c = 0; c < voodoo->texture_cache_entries; c++)
+            free(voodoo->texture_cache[tmu][c].data);
+        free(voodoo->texture_cache[tmu]);
+    }
+}
+
 void
 voodoo_tex_writel(uint32_t addr, uint32_t val, void *priv)
 {
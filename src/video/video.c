@@ -73,6 +73,7 @@
 #include <86box/thread.h>
 #include <86box/video.h>
 #include <86box/vid_svga.h>
+#include <86box/vid_svga_render.h>
 
 #include <minitrace/minitrace.h>
 
@@ -241,6 +242,10 @@ typedef struct blit_data_struct {
     int thread_run;
     int monitor_index;
 
+    /* Changed areas, -1 for the whole blit. */
+    int          damage_num;
+    video_rect_t damage[VIDEO_DAMAGE_MAX];
+
     thread_t *blit_thread;
     event_t  *wake_blit_thread;
     event_t  *blit_complete;
@@ -460,9 +465,14 @@ blit_thread(void *param)
     }
 }
 
+/* Blit an area of the target buffer, of which only the areas in damage have
+   changed since the previous blit. A num of -1 means the whole area changed,
+   and 0 that nothing did. */
 void
-video_blit_memtoscreen_monitor(int x, int y, int w, int h, int monitor_index)
+video_blit_memtoscreen_damage_monitor(int x, int y, int w, int h, const video_rect_t *damage, int num, int monitor_index)
 {
+    blit_data_t *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
+
     MTR_BEGIN("video", "video_blit_memtoscreen");
 
     if ((w <= 0) || (h <= 0))
@@ -470,17 +480,80 @@ video_blit_memtoscreen_monitor(int x, int y, int w, int h, int monitor_index)
 
     video_wait_for_blit_monitor(monitor_index);
 
-    monitors[monitor_index].mon_blit_data_ptr->busy          = 1;
-    monitors[monitor_index].mon_blit_data_ptr->buffer_in_use = 1;
-    monitors[monitor_index].mon_blit_data_ptr->x             = x;
-    monitors[monitor_index].mon_blit_data_ptr->y             = y;
-    monitors[monitor_index].mon_blit_data_ptr->w             = w;
-    monitors[monitor_index].mon_blit_data_ptr->h             = h;
+    blit_data_ptr->busy          = 1;
+    blit_data_ptr->buffer_in_use = 1;
+    blit_data_ptr->x             = x;
+    blit_data_ptr->y             = y;
+    blit_data_ptr->w             = w;
+    blit_data_ptr->h             = h;
+
+    if ((damage == NULL) || (num < 0) || (num > VIDEO_DAMAGE_MAX))
+        blit_data_ptr->damage_num = -1;
+    else {
+        memcpy(blit_data_ptr->damage, damage, num * sizeof(video_rect_t));
+        blit_data_ptr->damage_num = num;
+    }
 
-    thread_set_event(monitors[monitor_index].mon_blit_data_ptr->wake_blit_thread);
+    thread_set_event(blit_data_ptr->wake_blit_thread);
     MTR_END("video", "video_blit_memtoscreen");
 }
 
+void
+video_blit_memtoscreen_monitor(int x, int y, int w, int h, int monitor_index)
+{
+    video_blit_memtoscreen_damage_monitor(x, y, w, h, NULL, -1, monitor_index);
+}
+
+/* Called by the blit function, return the areas of the blit in progress
+   that changed, clipped to it. If there are more than max, a single area
+   covering them all is returned. */
+int
+video_blit_damage_monitor(video_rect_t *rects, int max, int monitor_index)
+{
+    const blit_data_t *blit_data_ptr = monitors[monitor_index].mon_blit_data_ptr;
+    int                num           = 0;
+    int                x1;
+    int                y1;
+    int                x2;
+    int                y2;
+
+    if ((max <= 0) || (blit_data_ptr->damage_num < 0)) {
+        rects[0].x = blit_data_ptr->x;
+        rects[0].y = blit_data_ptr->y;
+        rects[0].w = blit_data_ptr->w;
+        rects[0].h = blit_data_ptr->h;
+        return 1;
+    }
+
+    for (int i = 0; i < blit_data_ptr->damage_num; i++) {
+        const video_rect_t *d = &blit_data_ptr->damage[i];
+
+        x1 = MAX(d->x, blit_data_ptr->x);
+        y1 = MAX(d->y, blit_data_ptr->y);
+        x2 = MIN(d->x + d->w, blit_data_ptr->x + blit_data_ptr->w);
+        y2 = MIN(d->y + d->h, blit_data_ptr->y + blit_data_ptr->h);
+        if ((x1 >= x2) || (y1 >= y2))
+            continue;
+
+        if (num == max) {
+            /* Out of room, merge into the last one. */
+            x1 = MIN(x1, rects[num - 1].x);
+            y1 = MIN(y1, rects[num - 1].y);
+            x2 = MAX(x2, rects[num - 1].x + rects[num - 1].w);
+            y2 = MAX(y2, rects[num - 1].y + rects[num - 1].h);
+            num--;
+        }
+
+        rects[num].x = x1;
+        rects[num].y = y1;
+        rects[num].w = x2 - x1;
+        rects[num].h = y2 - y1;
+        num++;
+    }
+
+    return num;
+}
+
 uint8_t
 pixels8(uint32_t *pixels)
 {
@@ -967,6 +1040,9 @@ video_init(void)
     for (uint32_t c = 0; c < 65536; c++)
         video_16to32[c] = calc_16to32(c);
 
+    svga_render_simd_init();
+    pclog("Video: using %s scanline converters\n", svga_conv_line_name);
+
     memset(monitors, 0, sizeof(monitors));
     video_monitor_init(0);
 }
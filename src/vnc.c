@@ -45,6 +45,8 @@ static int              allowedY;
 static int              ptr_x;
 static int              ptr_y;
 static int              ptr_but;
+static int              damage_full = 1;
+static video_rect_t     last_blit;
 
 #ifdef ENABLE_VNC_LOG
 int vnc_do_log = ENABLE_VNC_LOG;
@@ -176,21 +178,46 @@ vnc_display(rfbClientPtr cl)
 static void
 vnc_blit(int x, int y, int w, int h, int monitor_index)
 {
+    video_rect_t rects[VIDEO_DAMAGE_MAX];
+    int          num;
+
     if (monitor_index || (x < 0) || (y < 0) || (w < VNC_MIN_X) || (h < VNC_MIN_Y) || (w > VNC_MAX_X) || (h > VNC_MAX_Y) || (buffer32 == NULL)) {
+        damage_full = 1;
         video_blit_complete_monitor(monitor_index);
         return;
     }
 
-    for (int row = 0; row < h; ++row)
-        video_copy(&(((uint8_t *) rfb->frameBuffer)[row * 2048 * sizeof(uint32_t)]), &(buffer32->line[y + row][x]), w * sizeof(uint32_t));
+    /* Only copy what changed, unless the frame buffer is out of date. */
+    num = video_blit_damage_monitor(rects, VIDEO_DAMAGE_MAX, monitor_index);
+    if (damage_full || (x != last_blit.x) || (y != last_blit.y) || (w != last_blit.w) || (h != last_blit.h)) {
+        last_blit.x = rects[0].x = x;
+        last_blit.y = rects[0].y = y;
+        last_blit.w = rects[0].w = w;
+        last_blit.h = rects[0].h = h;
+        num         = 1;
+        damage_full = 0;
+    }
+
+    for (int i = 0; i < num; i++) {
+        for (int row = 0; row < rects[i].h; ++row)
+            video_copy(&(((uint8_t *) rfb->frameBuffer)[(((rects[i].y - y + row) * 2048) + (rects[i].x - x)) * sizeof(uint32_t)]),
+                       &(buffer32->line[rects[i].y + row][rects[i].x]), rects[i].w * sizeof(uint32_t));
+    }
 
     if (screenshots)
         video_screenshot((uint32_t *) rfb->frameBuffer, 0, 0, VNC_MAX_X);
 
     video_blit_complete_monitor(monitor_index);
 
-    if (!updatingSize)
-        rfbMarkRectAsModified(rfb, 0, 0, allowedX, allowedY);
+    if (updatingSize) {
+        /* Mark everything once the clients have the new size. */
+        damage_full = 1;
+        return;
+    }
+
+    for (int i = 0; i < num; i++)
+        rfbMarkRectAsModified(rfb, rects[i].x - x, rects[i].y - y,
+                              MIN(rects[i].x - x + rects[i].w, allowedX), MIN(rects[i].y - y + rects[i].h, allowedY));
 }
 
 /* Initialize VNC for operation. */